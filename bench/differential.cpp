@@ -0,0 +1,419 @@
+/**
+ * @file differential.cpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the differential harness, which runs the legacy parser and the current engine over the same corpus and diffs their results.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <errno.h>
+#include <getopt.h>
+#include <string.h>
+#include <time.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "LogReader.hpp"
+#include "RequestAggregator.hpp"
+#include "SyntheticLog.hpp"
+#include "resources/Resources.hpp"
+
+// the legacy generator is a single translation unit with a main() of its own; renamed, its parser can be called from here.
+// It is compiled unchanged, so what is compared is what shipped; only its warnings are silenced.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#pragma GCC diagnostic ignored "-Wreturn-type"
+#define main legacyMain
+#include "../main.cpp"
+#undef main
+#pragma GCC diagnostic pop
+
+using fmt::format;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::map;
+using std::string;
+using std::string_view;
+using std::vector;
+
+/**
+ * @brief A client's aggregates, as far as both implementations keep them.
+ */
+struct ClientAggregates {
+    uint64_t                requests{0};
+    uint64_t                bytes{0};
+    int64_t                 firstSeen{std::numeric_limits<int64_t>::max()};
+    int64_t                 lastSeen{std::numeric_limits<int64_t>::min()};
+    map<uint16_t, uint64_t> statusCounts{};
+};
+
+/**
+ * @brief A line both implementations read differently.
+ */
+struct LineMismatch {
+    size_t      lineNumber{0}; //!< 1-based, within the lines the legacy path reads
+    string      field{};
+    string      legacyValue{};
+    string      currentValue{};
+};
+
+//=======================================
+// Prototypes
+//=======================================
+int parseArgs(const int32_t argc, char* const* argv); //!< Parses incoming command-line arguments
+bool loadCorpus(vector<string>& lines, uint64_t& skippedLines); //!< Reads or generates the corpus, keeping the lines the legacy path reads
+int64_t parseLegacyTimestamp(const string& timestamp); //!< Converts a timestamp the legacy parser kept as text
+void diffLines(const vector<string>& lines, vector<LineMismatch>& mismatches, map<string, vector<size_t>>& offendingLines); //!< Compares both parsers' fields line by line
+uint64_t diffAggregates(const vector<string>& lines, const map<string, vector<size_t>>& offendingLines); //!< Compares both implementations' per-client aggregates
+void measureThroughput(const vector<string>& lines); //!< Times both implementations over the lines in memory
+
+void printHelp(); //!< Prints the help text to the terminal
+
+static httpdreport::SyntheticLogOptions g_corpusOptions{};
+static string g_inputFile{};
+static uint64_t g_repeats{3};
+static uint64_t g_maxReportedMismatches{10};
+static volatile uint64_t g_sink{0}; //!< Keeps the compiler from dropping the work of either implementation
+
+int main(const int32_t argc, char* const* argv) {
+    g_corpusOptions.lineCount = 200000;
+    g_corpusOptions.logFormat = httpdreport::syntheticformats::COMMON; // the format the legacy parser was written for
+
+    if (auto retCode = parseArgs(argc, argv); retCode > 0) {
+        return retCode - 1;
+    }
+
+    vector<string> lines;
+    uint64_t skippedLines = 0;
+    if (!loadCorpus(lines, skippedLines)) { return 1; }
+
+    cout << format("{0:d} lines; {1:d} more skipped, as the legacy path only reads non-empty lines containing HTTP/1.1", lines.size(), skippedLines) << endl;
+
+    vector<LineMismatch> lineMismatches;
+    map<string, vector<size_t>> offendingLines;
+    diffLines(lines, lineMismatches, offendingLines);
+
+    for (size_t i = 0; i < std::min<size_t>(g_maxReportedMismatches, lineMismatches.size()); i++) {
+        const auto& mismatch = lineMismatches[i];
+        cout << format(
+            "line {0:d}: {1:s} differs: legacy \"{2:s}\", current \"{3:s}\"\n    {4:s}", mismatch.lineNumber, mismatch.field, mismatch.legacyValue,
+            mismatch.currentValue, lines[mismatch.lineNumber - 1]
+        ) << endl;
+    }
+    cout << format("{0:d} fields of the lines differ", lineMismatches.size()) << endl;
+
+    const auto aggregateMismatches = diffAggregates(lines, offendingLines);
+    cout << format("{0:d} aggregates differ", aggregateMismatches) << endl;
+
+    measureThroughput(lines);
+
+    return lineMismatches.empty() && aggregateMismatches == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Reads the input file (plain or gzip) or generates the corpus, then drops the lines the legacy readLogFiles() would.
+ * Those never reach the legacy parser, so they'd only count as differences by design.
+ */
+bool loadCorpus(vector<string>& lines, uint64_t& skippedLines) {
+    const auto keep = [&](string_view line) {
+        if (line.empty() || line.find("HTTP/1.1") == string_view::npos) {
+            skippedLines++;
+            return;
+        }
+
+        lines.emplace_back(line);
+    };
+
+    if (!g_inputFile.empty()) {
+        httpdreport::LogReader reader;
+        if (!reader.readFile(g_inputFile, keep)) {
+            cerr << format("Failed to read {0:s}: {1:s}", g_inputFile, strerror(errno)) << endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    httpdreport::SyntheticLogGenerator generator(g_corpusOptions);
+    string text;
+    generator.appendLines(text, g_corpusOptions.lineCount);
+    for (size_t start = 0; start < text.size();) {
+        const auto end = text.find('\n', start);
+        keep(string_view(text).substr(start, end - start));
+        start = end == string::npos ? text.size() : end + 1;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Converts a legacy timestamp with strptime() rather than the current parser, so a bug in the latter can't hide in both columns.
+ *
+ * @return int64_t The epoch, or INT64_MIN if the timestamp is invalid.
+ */
+int64_t parseLegacyTimestamp(const string& timestamp) {
+    tm time{};
+    const auto* end = strptime(timestamp.c_str(), "%d/%b/%Y:%H:%M:%S %z", &time);
+    if (end == nullptr || *end != '\0') { return std::numeric_limits<int64_t>::min(); }
+
+    const auto offset = time.tm_gmtoff; // timegm() resets it
+    return static_cast<int64_t>(timegm(&time)) - offset;
+}
+
+/**
+ * @brief Parses every line with both parsers and records each field they disagree on, in line order.
+ *
+ * @param offendingLines The line numbers of the differing lines, under the client each parser saw, for diffAggregates().
+ */
+void diffLines(const vector<string>& lines, vector<LineMismatch>& mismatches, map<string, vector<size_t>>& offendingLines) {
+    httpdreport::RequestRecord record;
+    for (size_t i = 0; i < lines.size(); i++) {
+        const auto& line = lines[i];
+        const auto connection = parseConnectionFromLine(line);
+        const auto mismatchCount = mismatches.size();
+        const auto compare = [&](const char* field, const string& legacy, string_view current) {
+            if (legacy != current) { mismatches.push_back({ i + 1, field, legacy, string(current) }); }
+        };
+
+        const auto parsed = httpdreport::parseRequestRecord(line, record);
+        if (!parsed) {
+            mismatches.push_back({ i + 1, "record", "parsed", "rejected" });
+        } else {
+            compare("client", connection.clientSource, record.clientSource);
+            compare("user", connection.userId, record.userId);
+            compare("method", connection.httpRequestMethod, record.httpRequestMethod);
+            compare("uri", connection.requestUri, record.requestUri);
+            compare("protocol", connection.httpVersion, record.httpVersion);
+            compare("status", std::to_string(connection.httpStatusCode), std::to_string(record.statusCode));
+            compare("bytes", std::to_string(connection.responseSize), std::to_string(record.responseSize));
+            compare("time", std::to_string(parseLegacyTimestamp(connection.timestamp)), std::to_string(record.epoch));
+        }
+
+        if (mismatches.size() == mismatchCount) { continue; }
+
+        offendingLines[connection.clientSource].push_back(i + 1);
+        if (parsed && record.clientSource != connection.clientSource) { offendingLines[string(record.clientSource)].push_back(i + 1); }
+    }
+}
+
+/**
+ * @brief Aggregates the lines through the legacy getConnectionAttempts() and through RequestAggregator, then compares every client
+ * field by field. Each difference is printed with the client's lines which parsed differently, if any.
+ *
+ * @return uint64_t The number of differing aggregates.
+ */
+uint64_t diffAggregates(const vector<string>& lines, const map<string, vector<size_t>>& offendingLines) {
+    map<string, ClientAggregates> legacy;
+    for (const auto& client : getConnectionAttempts(lines)) {
+        auto& aggregates = legacy[client.first];
+        for (const auto& connection : client.second) {
+            const auto epoch = parseLegacyTimestamp(connection.timestamp);
+            aggregates.requests++;
+            aggregates.bytes += static_cast<uint64_t>(connection.responseSize);
+            aggregates.firstSeen = std::min(aggregates.firstSeen, epoch);
+            aggregates.lastSeen = std::max(aggregates.lastSeen, epoch);
+            aggregates.statusCounts[static_cast<uint16_t>(connection.httpStatusCode)]++;
+        }
+    }
+
+    httpdreport::RequestAggregator aggregator(httpdreport::TABLE_CLIENTS);
+    httpdreport::RequestRecord record;
+    for (const auto& line : lines) {
+        if (httpdreport::parseRequestRecord(line, record)) { aggregator.add(record); }
+    }
+
+    map<string, ClientAggregates> current;
+    for (uint32_t id = 0; id < aggregator.getClientCount(); id++) {
+        const auto& client = aggregator.getClient(id);
+        auto& aggregates = current[string(aggregator.getClientName(id))];
+        aggregates.requests = client.requests;
+        aggregates.bytes = client.bytes;
+        aggregates.firstSeen = client.firstSeen;
+        aggregates.lastSeen = client.lastSeen;
+        for (const auto& status : client.statusCounts) { aggregates.statusCounts[status.first] = status.second; }
+    }
+
+    uint64_t differences = 0;
+    const auto report = [&](const string& client, const string& field, const string& legacyValue, const string& currentValue) {
+        if (differences++ >= g_maxReportedMismatches) { return; }
+
+        cout << format("client {0:s}: {1:s} differs: legacy {2:s}, current {3:s}", client, field, legacyValue, currentValue) << endl;
+        const auto offending = offendingLines.find(client);
+        if (offending == offendingLines.end()) {
+            cout << "    every line of this client parses identically; the difference is in the aggregation" << endl;
+            return;
+        }
+
+        for (size_t i = 0; i < std::min<size_t>(3, offending->second.size()); i++) {
+            cout << format("    line {0:d}: {1:s}", offending->second[i], lines[offending->second[i] - 1]) << endl;
+        }
+    };
+
+    for (const auto& [client, ours] : legacy) {
+        const auto theirs = current.find(client);
+        if (theirs == current.end()) {
+            report(client, "presence", "present", "missing");
+            continue;
+        }
+
+        const auto& other = theirs->second;
+        if (ours.requests != other.requests) { report(client, "requests", std::to_string(ours.requests), std::to_string(other.requests)); }
+        if (ours.bytes != other.bytes) { report(client, "bytes", std::to_string(ours.bytes), std::to_string(other.bytes)); }
+        if (ours.firstSeen != other.firstSeen) { report(client, "first seen", std::to_string(ours.firstSeen), std::to_string(other.firstSeen)); }
+        if (ours.lastSeen != other.lastSeen) { report(client, "last seen", std::to_string(ours.lastSeen), std::to_string(other.lastSeen)); }
+        if (ours.statusCounts != other.statusCounts) {
+            const auto toString = [](const map<uint16_t, uint64_t>& counts) {
+                string text;
+                for (const auto& status : counts) { text += format("{0:s}{1:d}:{2:d}", text.empty() ? "" : ",", status.first, status.second); }
+                return text;
+            };
+            report(client, "status counts", toString(ours.statusCounts), toString(other.statusCounts));
+        }
+    }
+
+    for (const auto& client : current) {
+        if (legacy.find(client.first) == legacy.end()) { report(client.first, "presence", "missing", "present"); }
+    }
+
+    cout << format("{0:d} clients in the legacy aggregates, {1:d} in the current", legacy.size(), current.size()) << endl;
+
+    return differences;
+}
+
+/**
+ * @brief Times each implementation's full path from lines in memory to per-client aggregates; the best of the repeats counts.
+ */
+void measureThroughput(const vector<string>& lines) {
+    using clock = std::chrono::steady_clock;
+
+    auto legacyNanos = std::numeric_limits<double>::max();
+    auto currentNanos = std::numeric_limits<double>::max();
+    for (uint64_t repeat = 0; repeat < g_repeats; repeat++) {
+        auto start = clock::now();
+        const auto connections = getConnectionAttempts(lines);
+        legacyNanos = std::min(legacyNanos, std::chrono::duration<double, std::nano>(clock::now() - start).count());
+
+        start = clock::now();
+        httpdreport::RequestAggregator aggregator(httpdreport::TABLE_CLIENTS);
+        httpdreport::RequestRecord record;
+        for (const auto& line : lines) {
+            if (httpdreport::parseRequestRecord(line, record)) { aggregator.add(record); }
+        }
+        currentNanos = std::min(currentNanos, std::chrono::duration<double, std::nano>(clock::now() - start).count());
+
+        g_sink = g_sink + connections.size() + aggregator.getClientCount();
+    }
+
+    const auto lineCount = static_cast<double>(lines.size());
+    cout << format(
+        "legacy {0:.3f} M lines/s, current {1:.3f} M lines/s: {2:.1f}x", lineCount / legacyNanos * 1e3, lineCount / currentNanos * 1e3,
+        legacyNanos / currentNanos
+    ) << endl;
+}
+
+int parseArgs(const int32_t argc, char* const* argv) {
+    static const string SHORT_OPTS = "hi:n:c:s:r:m:";
+    static const option OPTIONS[] = {
+        { "help",           no_argument,        nullptr, 'h' },
+        { "input",          required_argument,  nullptr, 'i' },
+        { "lines",          required_argument,  nullptr, 'n' },
+        { "clients",        required_argument,  nullptr, 'c' },
+        { "seed",           required_argument,  nullptr, 's' },
+        { "repeat",         required_argument,  nullptr, 'r' },
+        { "max-mismatches", required_argument,  nullptr, 'm' },
+        { "format",         required_argument,  nullptr, 0x100 },
+        { nullptr,          no_argument,        nullptr,  0  }
+    };
+
+    int32_t optChar = 0;
+    while ((optChar = getopt_long(argc, argv, SHORT_OPTS.c_str(), OPTIONS, nullptr)) != -1) {
+        switch (optChar) {
+            case 'h':
+                printHelp();
+                return 1;
+            case 'i':
+                g_inputFile = optarg;
+                break;
+            case 'n':
+                g_corpusOptions.lineCount = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'c':
+                g_corpusOptions.clientCount = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 's':
+                g_corpusOptions.seed = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'r':
+                g_repeats = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'm':
+                g_maxReportedMismatches = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 0x100:
+                if (string_view(optarg) == "common") {
+                    g_corpusOptions.logFormat = httpdreport::syntheticformats::COMMON;
+                } else if (string_view(optarg) == "combined") {
+                    g_corpusOptions.logFormat = httpdreport::syntheticformats::COMBINED;
+                } else {
+                    cerr << format("Unknown format {0:s}; expected common or combined, the formats the legacy parser reads", optarg) << endl;
+                    return 2;
+                }
+                break;
+            default:
+                return 2;
+        }
+    }
+
+    return 0;
+}
+
+void printHelp() {
+    cout << format(
+R"({0:s}-differential {1:s}
+
+Runs the legacy parseConnectionFromLine() / getConnectionAttempts() path and the current parser and aggregator over the same
+corpus. Every line's fields and every client's aggregates (requests, bytes, first and last seen, status counts) are compared;
+differences are printed with the offending lines, followed by the throughput of both. Exits with 1 if anything differs.
+
+The legacy parser doesn't validate lines (a line without a complete request is undefined behaviour), so only the lines its
+readLogFiles() would read are compared: non-empty lines containing HTTP/1.1.
+
+Usage:
+    {0:s}-differential [-options]
+
+Arguments:
+    --input,    -i[file]        Compare over a log file (plain or gzip) instead of a generated corpus
+    --lines,    -n[count]       The number of lines in the generated corpus. Default: 200000
+    --clients,  -c[count]       Distinct clients in the generated corpus. Default: {2:d}
+    --format    [name]          The generated corpus's format: common or combined. Default: common
+    --seed,     -s[seed]        The generated corpus's seed. Default: {3:d}
+    --repeat,   -r[count]       Time each implementation this often and keep the best. Default: 3
+    --max-mismatches, -m[count] Print at most this many differences of each kind. Default: 10
+)", httpdreport::resources::APP_NAME, httpdreport::resources::APP_VERSION, httpdreport::SyntheticLogOptions{}.clientCount, httpdreport::SyntheticLogOptions{}.seed) << endl;
+}
@@ -0,0 +1,714 @@
+/**
+ * @file main.cpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the benchmarks of the hot paths, run against a generated corpus and reported as JSON.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <errno.h>
+#include <getopt.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// zlib
+#include <zlib.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "AllocationCounter.hpp"
+#include "LogReader.hpp"
+#include "ReportOutput.hpp"
+#include "ReportRenderer.hpp"
+#include "RequestAggregator.hpp"
+#include "SyntheticLog.hpp"
+#include "resources/Resources.hpp"
+
+using fmt::format;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::ifstream;
+using std::string;
+using std::string_view;
+using std::unique_ptr;
+using std::vector;
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief The timings of a single benchmark.
+ */
+struct BenchmarkResult {
+    string      name{};
+    uint64_t    iterations{0};
+    double      medianNanos{0};
+    double      minNanos{0};
+    uint64_t    items{0}; //!< Lines (or records, or reports) processed per iteration
+    uint64_t    bytes{0}; //!< Bytes processed per iteration
+    double      allocations{0}; //!< Allocations per iteration, after the warm-up
+    bool        allocationFree{false}; //!< Whether or not the benchmark must not allocate once warmed up
+};
+
+/**
+ * @brief A benchmark's entry in the baseline file: the median it is expected to reach, and by how much it may miss it.
+ */
+struct BaselineEntry {
+    string      name{};
+    double      medianNanos{0};
+    double      tolerancePercent{0};
+};
+
+/**
+ * @brief The corpus every benchmark runs against, generated once per run.
+ */
+struct Corpus {
+    string                              text{};
+    vector<string_view>                 lines{};
+    vector<httpdreport::RequestRecord>  records{}; //!< The lines which parse; views in to text
+    fs::path                            plainFile{};
+    fs::path                            gzipFile{};
+    uint64_t                            gzipBytes{0};
+};
+
+//=======================================
+// Prototypes
+//=======================================
+int parseArgs(const int32_t argc, char* const* argv); //!< Parses incoming command-line arguments
+bool buildCorpus(Corpus& corpus); //!< Generates the corpus and writes its plain and gzip files
+void runBenchmarks(Corpus& corpus, vector<BenchmarkResult>& results); //!< Runs every benchmark matching the filter
+string toJson(const Corpus& corpus, const vector<BenchmarkResult>& results); //!< Renders the results for comparison by scripts
+vector<BenchmarkResult> combineRuns(const vector<vector<BenchmarkResult>>& runs); //!< Reduces the results of several runs to their medians
+bool pinToCpu(int32_t cpu); //!< Pins the process, and the threads it starts from then on, to a single CPU
+bool loadBaseline(const fs::path& path, vector<BaselineEntry>& baseline, string& error); //!< Loads a baseline file
+bool writeBaseline(const fs::path& path, const vector<BenchmarkResult>& results); //!< Writes the results as a baseline, keeping the file's tolerances
+bool compareWithBaseline(const vector<BenchmarkResult>& results, const vector<BaselineEntry>& baseline); //!< Prints the comparison table; false on regressions
+
+template<typename Body>
+void runBenchmark(const string& name, uint64_t items, uint64_t bytes, Body&& body, vector<BenchmarkResult>& results); //!< Times body until the minimum time is reached
+
+void printHelp(); //!< Prints the help text to the terminal
+
+static httpdreport::SyntheticLogOptions g_corpusOptions{};
+static string g_formatName{"combined"};
+static string g_filter{};
+static string g_outputFile{};
+static uint64_t g_minTimeMs{500};
+static uint64_t g_minIterations{3};
+static bool g_checkAllocations{false};
+static uint64_t g_runs{1};
+static uint64_t g_warmUpMs{0};
+static int32_t g_cpu{-1};
+static double g_defaultTolerancePercent{10};
+static string g_baselineFile{};
+static string g_writeBaselineFile{};
+static volatile uint64_t g_sink{0}; //!< Keeps the compiler from dropping the work of a benchmark
+
+//! The steady state of these benchmarks (parsing, and aggregating known keys) must not allocate; see --check-allocations
+static const vector<string> ALLOCATION_FREE_BENCHMARKS = { "parse_record", "parse_record_minimal", "parse_timestamp", "parse_client_address", "aggregate_known_keys" };
+
+int main(const int32_t argc, char* const* argv) {
+    g_corpusOptions.lineCount = 500000;
+
+    if (auto retCode = parseArgs(argc, argv); retCode > 0) {
+        return retCode - 1;
+    }
+
+#ifndef __OPTIMIZE__
+    cerr << "Warning: this benchmark was built without optimisation; its results don't reflect a release build." << endl;
+#endif
+
+    if (g_cpu >= 0 && !pinToCpu(g_cpu)) { return 1; }
+
+    vector<BaselineEntry> baseline;
+    if (string error; !g_baselineFile.empty() && !loadBaseline(g_baselineFile, baseline, error)) {
+        cerr << format("Failed to load the baseline: {0:s}", error) << endl;
+        return 1;
+    }
+
+    Corpus corpus;
+    if (!buildCorpus(corpus)) { return 1; }
+
+    httpdreport::AllocationCounter::enable();
+    vector<vector<BenchmarkResult>> runs(g_runs);
+    for (uint64_t run = 0; run < g_runs; run++) {
+        if (g_runs > 1) { cerr << format("Run {0:d} of {1:d}", run + 1, g_runs) << endl; }
+        runBenchmarks(corpus, runs[run]);
+    }
+    const auto results = combineRuns(runs);
+
+    auto exitCode = 0;
+    for (const auto& result : results) {
+        if (!g_checkAllocations || !result.allocationFree || result.allocations == 0) { continue; }
+
+        cerr << format("{0:s} allocated {1:.2f} times per iteration after warming up; it must not allocate at all", result.name, result.allocations) << endl;
+        exitCode = 1;
+    }
+
+    if (!g_baselineFile.empty() && !compareWithBaseline(results, baseline)) { exitCode = 1; }
+    if (!g_writeBaselineFile.empty() && !writeBaseline(g_writeBaselineFile, results)) { exitCode = 1; }
+
+    std::error_code ignored;
+    fs::remove(corpus.plainFile, ignored);
+    fs::remove(corpus.gzipFile, ignored);
+
+    const auto json = toJson(corpus, results);
+    if (g_outputFile.empty()) {
+        cout << json << std::flush;
+        return exitCode;
+    }
+
+    auto* output = fopen(g_outputFile.c_str(), "w");
+    if (output == nullptr || fwrite(json.data(), 1, json.size(), output) != json.size() || fclose(output) != 0) {
+        cerr << format("Failed to write {0:s}: {1:s}", g_outputFile, strerror(errno)) << endl;
+        return 1;
+    }
+
+    return exitCode;
+}
+
+bool buildCorpus(Corpus& corpus) {
+    httpdreport::SyntheticLogGenerator generator(g_corpusOptions);
+    corpus.text.reserve(g_corpusOptions.lineCount * 256);
+    generator.appendLines(corpus.text, g_corpusOptions.lineCount);
+
+    string_view remaining(corpus.text);
+    for (auto newLine = remaining.find('\n'); newLine != string_view::npos; newLine = remaining.find('\n')) {
+        corpus.lines.push_back(remaining.substr(0, newLine));
+        remaining.remove_prefix(newLine + 1);
+    }
+
+    httpdreport::RequestRecord record;
+    for (const auto line : corpus.lines) {
+        if (httpdreport::parseRequestRecord(line, record)) { corpus.records.push_back(record); }
+    }
+
+    const auto directory = fs::temp_directory_path();
+    corpus.plainFile = directory / format("httpd-hit-report-bench-{0:d}.access.log", getpid());
+    corpus.gzipFile = directory / format("httpd-hit-report-bench-{0:d}.access.log.gz", getpid());
+
+    auto* plain = fopen(corpus.plainFile.c_str(), "w");
+    if (plain == nullptr || fwrite(corpus.text.data(), 1, corpus.text.size(), plain) != corpus.text.size() || fclose(plain) != 0) {
+        cerr << format("Failed to write {0:s}: {1:s}", corpus.plainFile.string(), strerror(errno)) << endl;
+        return false;
+    }
+
+    auto gzip = gzopen(corpus.gzipFile.c_str(), "wb6");
+    if (gzip == nullptr || gzwrite(gzip, corpus.text.data(), static_cast<unsigned>(corpus.text.size())) != static_cast<int>(corpus.text.size()) || gzclose(gzip) != Z_OK) {
+        cerr << format("Failed to write {0:s}", corpus.gzipFile.string()) << endl;
+        return false;
+    }
+    corpus.gzipBytes = fs::file_size(corpus.gzipFile);
+
+    cerr << format(
+        "Corpus: {0:d} lines ({1:d} parse), {2:d} bytes ({3:d} bytes gzipped), {4:d} clients, {5:d} URIs, seed {6:d}",
+        corpus.lines.size(), corpus.records.size(), corpus.text.size(), corpus.gzipBytes, g_corpusOptions.clientCount, g_corpusOptions.uriCount, g_corpusOptions.seed
+    ) << endl;
+
+    return true;
+}
+
+void runBenchmarks(Corpus& corpus, vector<BenchmarkResult>& results) {
+    using httpdreport::RequestAggregator;
+
+    const auto lineCount = corpus.lines.size();
+    const auto textBytes = corpus.text.size();
+    const auto recordCount = corpus.records.size();
+
+    runBenchmark("line_split", lineCount, textBytes, [&]() {
+        httpdreport::LogReader reader;
+        uint64_t sum = 0;
+        reader.readFile(corpus.plainFile, [&](string_view line) { sum += line.size(); });
+        return sum;
+    }, results);
+
+    runBenchmark("parse_record", lineCount, textBytes, [&]() {
+        httpdreport::RequestRecord record;
+        uint64_t sum = 0;
+        for (const auto line : corpus.lines) { sum += httpdreport::parseRequestRecord(line, record); }
+        return sum;
+    }, results);
+
+    runBenchmark("parse_record_minimal", lineCount, textBytes, [&]() {
+        httpdreport::RequestRecord record;
+        uint64_t sum = 0;
+        for (const auto line : corpus.lines) { sum += httpdreport::parseRequestRecord(line, record, 0); }
+        return sum;
+    }, results);
+
+    // both decoders get the same fields parseRequestRecord hands them: the text between the brackets and the client source
+    vector<string_view> timestamps;
+    vector<string_view> sources;
+    for (const auto line : corpus.lines) {
+        const auto open = line.find('[');
+        const auto close = line.find(']', open);
+        if (open != string_view::npos && close != string_view::npos) { timestamps.push_back(line.substr(open + 1, close - open - 1)); }
+    }
+    for (const auto& record : corpus.records) { sources.push_back(record.clientSource); }
+
+    runBenchmark("parse_timestamp", timestamps.size(), 0, [&]() {
+        int64_t epoch = 0;
+        uint64_t sum = 0;
+        for (const auto timestamp : timestamps) {
+            httpdreport::parseTimestamp(timestamp, epoch);
+            sum += static_cast<uint64_t>(epoch);
+        }
+        return sum;
+    }, results);
+
+    runBenchmark("parse_client_address", sources.size(), 0, [&]() {
+        httpdreport::ClientAddress address{};
+        uint64_t sum = 0;
+        for (const auto source : sources) { sum += httpdreport::parseClientAddress(source, address) + address[15]; }
+        return sum;
+    }, results);
+
+    runBenchmark("aggregate_insert", recordCount, 0, [&]() {
+        RequestAggregator aggregator;
+        for (const auto& record : corpus.records) { aggregator.add(record); }
+        return aggregator.getTotalRequests();
+    }, results);
+
+    // merging four partial tables, as after reading four files
+    vector<unique_ptr<RequestAggregator>> parts;
+    for (size_t i = 0; i < 4; i++) { parts.push_back(std::make_unique<RequestAggregator>()); }
+    for (size_t i = 0; i < recordCount; i++) { parts[i * parts.size() / std::max<size_t>(1, recordCount)]->add(corpus.records[i]); }
+
+    runBenchmark("aggregate_merge", recordCount, 0, [&]() {
+        RequestAggregator merged;
+        for (const auto& part : parts) { merged.merge(*part); }
+        return merged.getTotalRequests();
+    }, results);
+
+    RequestAggregator full;
+    for (const auto& record : corpus.records) { full.add(record); }
+
+    runBenchmark("render", 1, 0, [&]() {
+        httpdreport::ReportOutput output;
+        if (!output.open("/dev/null", httpdreport::ReportOutput::Compression::NONE)) { return uint64_t{0}; }
+
+        httpdreport::ReportRenderer(full, output).render();
+        output.close();
+        return full.getTotalRequests();
+    }, results);
+
+    // the tables already hold every key, so this only updates counters in place
+    runBenchmark("aggregate_known_keys", recordCount, 0, [&]() {
+        for (const auto& record : corpus.records) { full.add(record); }
+        return full.getTotalRequests();
+    }, results);
+
+    runBenchmark("gzip_ingest", lineCount, corpus.gzipBytes, [&]() {
+        httpdreport::LogReader reader;
+        uint64_t sum = 0;
+        reader.readFile(corpus.gzipFile, [&](string_view line) { sum += line.size(); });
+        return sum;
+    }, results);
+
+    runBenchmark("end_to_end", lineCount, textBytes, [&]() {
+        httpdreport::LogReader reader;
+        httpdreport::RequestRecord record;
+        RequestAggregator aggregator;
+        reader.readFile(corpus.plainFile, [&](string_view line) {
+            if (httpdreport::parseRequestRecord(line, record)) { aggregator.add(record); }
+        });
+        return aggregator.getTotalRequests();
+    }, results);
+}
+
+/**
+ * @brief Runs a benchmark to warm up (once, or for --warm-up), then until both the minimum time and the minimum number of iterations are reached.
+ *
+ * @param items The lines, records or reports one iteration processes.
+ * @param bytes The bytes one iteration processes; 0 if throughput in bytes doesn't apply.
+ * @param body Runs one iteration and returns a value derived from its work.
+ */
+template<typename Body>
+void runBenchmark(const string& name, uint64_t items, uint64_t bytes, Body&& body, vector<BenchmarkResult>& results) {
+    if (!g_filter.empty() && name.find(g_filter) == string::npos) { return; }
+
+    using clock = std::chrono::steady_clock;
+
+    const auto warmUpStart = clock::now();
+    do {
+        g_sink = g_sink + body();
+    } while (clock::now() - warmUpStart < std::chrono::milliseconds(g_warmUpMs));
+
+    // reserved up front, so the timings don't count as the benchmark's allocations
+    vector<double> timings;
+    timings.reserve(1 << 16);
+    uint64_t allocations = 0;
+
+    const auto start = clock::now();
+    while (timings.size() < g_minIterations || clock::now() - start < std::chrono::milliseconds(g_minTimeMs)) {
+        const auto allocationsBefore = httpdreport::AllocationCounter::getAllocations();
+        const auto iterationStart = clock::now();
+        g_sink = g_sink + body();
+        const auto iterationEnd = clock::now();
+        allocations += httpdreport::AllocationCounter::getAllocations() - allocationsBefore;
+
+        if (timings.size() == timings.capacity()) { break; }
+        timings.push_back(std::chrono::duration<double, std::nano>(iterationEnd - iterationStart).count());
+    }
+
+    std::sort(timings.begin(), timings.end());
+    BenchmarkResult result;
+    result.name = name;
+    result.iterations = timings.size();
+    result.medianNanos = timings.size() % 2 == 1 ? timings[timings.size() / 2] : (timings[timings.size() / 2 - 1] + timings[timings.size() / 2]) / 2;
+    result.minNanos = timings.front();
+    result.items = items;
+    result.bytes = bytes;
+    result.allocations = static_cast<double>(allocations) / static_cast<double>(timings.size());
+    result.allocationFree = std::find(ALLOCATION_FREE_BENCHMARKS.begin(), ALLOCATION_FREE_BENCHMARKS.end(), name) != ALLOCATION_FREE_BENCHMARKS.end();
+
+    const auto seconds = result.medianNanos / 1e9;
+    cerr << format(
+        "{0:<22s} {1:>8d} iterations  median {2:>12.3f} ms  {3:>10.2f} M items/s  {4:>10.1f} MiB/s  {5:>12.1f} allocations", name, result.iterations,
+        result.medianNanos / 1e6, static_cast<double>(items) / seconds / 1e6, static_cast<double>(bytes) / seconds / 1048576.0, result.allocations
+    ) << endl;
+
+    results.push_back(result);
+}
+
+/**
+ * @brief Reduces the runs to one result per benchmark: the median of the runs' medians, so a single disturbed run can't move it.
+ * Allocations are the highest of any run, so --check-allocations stays strict.
+ */
+vector<BenchmarkResult> combineRuns(const vector<vector<BenchmarkResult>>& runs) {
+    auto results = runs.front();
+    for (size_t i = 0; i < results.size(); i++) {
+        auto& result = results[i];
+        vector<double> medians;
+        for (const auto& run : runs) {
+            const auto& other = run[i];
+            medians.push_back(other.medianNanos);
+            if (&run == &runs.front()) { continue; }
+
+            result.iterations += other.iterations;
+            result.minNanos = std::min(result.minNanos, other.minNanos);
+            result.allocations = std::max(result.allocations, other.allocations);
+        }
+
+        std::sort(medians.begin(), medians.end());
+        result.medianNanos = medians.size() % 2 == 1 ? medians[medians.size() / 2] : (medians[medians.size() / 2 - 1] + medians[medians.size() / 2]) / 2;
+    }
+
+    return results;
+}
+
+bool pinToCpu(int32_t cpu) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        cerr << format("Failed to pin to CPU {0:d}: {1:s}", cpu, strerror(errno)) << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Loads a baseline file. Every line holds a benchmark's name, its median in nanoseconds and, optionally, the percentage
+ * it may be slower by before it counts as a regression (--tolerance if omitted). # starts a comment.
+ *
+ *     parse_record    41230000    5
+ */
+bool loadBaseline(const fs::path& path, vector<BaselineEntry>& baseline, string& error) {
+    ifstream input(path);
+    if (!input.good()) {
+        error = format("cannot open {0:s}", path.string());
+        return false;
+    }
+
+    string line;
+    size_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+
+        BaselineEntry entry;
+        entry.tolerancePercent = g_defaultTolerancePercent;
+        char name[128] = {0};
+        const auto fields = sscanf(line.c_str(), "%127s %lf %lf", name, &entry.medianNanos, &entry.tolerancePercent);
+        if (fields <= 0) { continue; }
+        if (fields < 2 || entry.medianNanos <= 0 || entry.tolerancePercent < 0) {
+            error = format("{0:s}:{1:d}: expected a benchmark name, its median in nanoseconds and optionally a tolerance in percent", path.string(), lineNumber);
+            return false;
+        }
+
+        entry.name = name;
+        baseline.push_back(entry);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Writes the results as a baseline. Tolerances someone tuned in an existing file are kept.
+ */
+bool writeBaseline(const fs::path& path, const vector<BenchmarkResult>& results) {
+    vector<BaselineEntry> previous;
+    string ignored;
+    if (fs::exists(path)) { loadBaseline(path, previous, ignored); }
+
+    string text = format(
+        "# The medians {0:s}-bench is held to by perf-check: benchmark, median in ns, tolerated slowdown in percent.\n"
+        "# Medians depend on the machine and the corpus; regenerate them with the perf-baseline target on the machine which runs perf-check.\n"
+        "# Corpus: {1:d} lines, seed {2:d}, {3:s}\n",
+        httpdreport::resources::APP_NAME, g_corpusOptions.lineCount, g_corpusOptions.seed, g_formatName
+    );
+    for (const auto& result : results) {
+        auto tolerance = g_defaultTolerancePercent;
+        for (const auto& entry : previous) {
+            if (entry.name == result.name) { tolerance = entry.tolerancePercent; }
+        }
+
+        text += format("{0:<24s} {1:>14.0f} {2:>6g}\n", result.name, result.medianNanos, tolerance);
+    }
+
+    auto* output = fopen(path.c_str(), "w");
+    if (output == nullptr || fwrite(text.data(), 1, text.size(), output) != text.size() || fclose(output) != 0) {
+        cerr << format("Failed to write {0:s}: {1:s}", path.string(), strerror(errno)) << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Prints a table comparing the medians with the baseline's.
+ *
+ * @return false If any benchmark is slower than its baseline by more than its tolerance.
+ */
+bool compareWithBaseline(const vector<BenchmarkResult>& results, const vector<BaselineEntry>& baseline) {
+    auto regressions = 0;
+
+    cerr << format("\n{0:<24s} {1:>14s} {2:>14s} {3:>9s} {4:>10s}  {5:s}", "benchmark", "baseline ms", "median ms", "change", "tolerance", "verdict") << endl;
+    for (const auto& result : results) {
+        const auto entry = std::find_if(baseline.begin(), baseline.end(), [&](const BaselineEntry& e) { return e.name == result.name; });
+        if (entry == baseline.end()) {
+            cerr << format("{0:<24s} {1:>14s} {2:>14.3f} {3:>9s} {4:>10s}  {5:s}", result.name, "-", result.medianNanos / 1e6, "-", "-", "no baseline") << endl;
+            continue;
+        }
+
+        const auto change = (result.medianNanos / entry->medianNanos - 1) * 100;
+        const char* verdict = "ok";
+        if (change > entry->tolerancePercent) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (change < -entry->tolerancePercent) {
+            verdict = "faster; consider updating the baseline";
+        }
+
+        cerr << format(
+            "{0:<24s} {1:>14.3f} {2:>14.3f} {3:>+8.1f}% {4:>9g}%  {5:s}", result.name, entry->medianNanos / 1e6, result.medianNanos / 1e6, change,
+            entry->tolerancePercent, verdict
+        ) << endl;
+    }
+
+    if (regressions > 0) {
+        cerr << format("\n{0:d} benchmark(s) regressed beyond their tolerance", regressions) << endl;
+        return false;
+    }
+
+    return true;
+}
+
+string toJson(const Corpus& corpus, const vector<BenchmarkResult>& results) {
+#ifdef __OPTIMIZE__
+    const bool optimized = true;
+#else
+    const bool optimized = false;
+#endif
+
+    auto json = format(
+        R"({{"version":"{0:s}","optimized":{1:s},"corpus":{{"lines":{2:d},"bytes":{3:d},"gzip_bytes":{4:d},"clients":{5:d},"uris":{6:d},"user_agents":{7:d},"zipf_exponent":{8:g},"uri_padding":{9:d},"format":"{10:s}","seed":{11:d}}},"results":[)",
+        httpdreport::resources::APP_VERSION, optimized ? "true" : "false", corpus.lines.size(), corpus.text.size(), corpus.gzipBytes, g_corpusOptions.clientCount,
+        g_corpusOptions.uriCount, g_corpusOptions.userAgentCount, g_corpusOptions.zipfExponent, g_corpusOptions.uriPadding, g_formatName, g_corpusOptions.seed
+    );
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        const auto seconds = result.medianNanos / 1e9;
+        json += format(
+            R"({0:s}{{"name":"{1:s}","iterations":{2:d},"median_ns":{3:.0f},"min_ns":{4:.0f},"items":{5:d},"bytes":{6:d},"items_per_second":{7:.0f},"bytes_per_second":{8:.0f},"allocations":{9:.2f}}})",
+            i == 0 ? "" : ",", result.name, result.iterations, result.medianNanos, result.minNanos, result.items, result.bytes,
+            static_cast<double>(result.items) / seconds, static_cast<double>(result.bytes) / seconds, result.allocations
+        );
+    }
+
+    return json + "]}\n";
+}
+
+int parseArgs(const int32_t argc, char* const* argv) {
+    static const string SHORT_OPTS = "hn:c:u:s:f:o:t:";
+    static const option OPTIONS[] = {
+        { "help",           no_argument,        nullptr, 'h' },
+        { "lines",          required_argument,  nullptr, 'n' },
+        { "clients",        required_argument,  nullptr, 'c' },
+        { "uris",           required_argument,  nullptr, 'u' },
+        { "seed",           required_argument,  nullptr, 's' },
+        { "filter",         required_argument,  nullptr, 'f' },
+        { "output",         required_argument,  nullptr, 'o' },
+        { "min-time",       required_argument,  nullptr, 't' },
+        { "user-agents",    required_argument,  nullptr, 0x100 },
+        { "zipf",           required_argument,  nullptr, 0x101 },
+        { "uri-padding",    required_argument,  nullptr, 0x102 },
+        { "format",         required_argument,  nullptr, 0x103 },
+        { "min-iterations", required_argument,  nullptr, 0x104 },
+        { "check-allocations", no_argument,     nullptr, 0x105 },
+        { "runs",           required_argument,  nullptr, 0x106 },
+        { "warm-up",        required_argument,  nullptr, 0x107 },
+        { "cpu",            required_argument,  nullptr, 0x108 },
+        { "baseline",       required_argument,  nullptr, 0x109 },
+        { "tolerance",      required_argument,  nullptr, 0x10a },
+        { "write-baseline", required_argument,  nullptr, 0x10b },
+        { nullptr,          no_argument,        nullptr,  0  }
+    };
+
+    int32_t optChar = 0;
+    while ((optChar = getopt_long(argc, argv, SHORT_OPTS.c_str(), OPTIONS, nullptr)) != -1) {
+        switch (optChar) {
+            case 'h':
+                printHelp();
+                return 1;
+            case 'n':
+                g_corpusOptions.lineCount = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'c':
+                g_corpusOptions.clientCount = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'u':
+                g_corpusOptions.uriCount = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 's':
+                g_corpusOptions.seed = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'f':
+                g_filter = optarg;
+                break;
+            case 'o':
+                g_outputFile = optarg;
+                break;
+            case 't':
+                g_minTimeMs = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 0x100:
+                g_corpusOptions.userAgentCount = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 0x101:
+                g_corpusOptions.zipfExponent = std::max(0.01, std::strtod(optarg, nullptr));
+                break;
+            case 0x102:
+                g_corpusOptions.uriPadding = std::strtoul(optarg, nullptr, 10);
+                break;
+            case 0x103:
+                g_formatName = optarg;
+                if (g_formatName == "common") {
+                    g_corpusOptions.logFormat = httpdreport::syntheticformats::COMMON;
+                } else if (g_formatName == "combined") {
+                    g_corpusOptions.logFormat = httpdreport::syntheticformats::COMBINED;
+                } else if (g_formatName == "vhost_combined") {
+                    g_corpusOptions.logFormat = httpdreport::syntheticformats::VHOST_COMBINED;
+                } else {
+                    cerr << format("Unknown format {0:s}; expected common, combined or vhost_combined", optarg) << endl;
+                    return 2;
+                }
+                break;
+            case 0x104:
+                g_minIterations = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 0x105:
+                g_checkAllocations = true;
+                break;
+            case 0x106:
+                g_runs = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 0x107:
+                g_warmUpMs = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 0x108:
+                g_cpu = static_cast<int32_t>(std::strtol(optarg, nullptr, 10));
+                break;
+            case 0x109:
+                g_baselineFile = optarg;
+                break;
+            case 0x10a:
+                g_defaultTolerancePercent = std::max(0.0, std::strtod(optarg, nullptr));
+                break;
+            case 0x10b:
+                g_writeBaselineFile = optarg;
+                break;
+            default:
+                return 2;
+        }
+    }
+
+    return 0;
+}
+
+void printHelp() {
+    const auto defaults = httpdreport::SyntheticLogOptions{};
+
+    cout << format(
+R"({0:s}-bench {1:s}
+
+Benchmarks the hot paths (line splitting, parsing, timestamp and address decoding, aggregation, merging, rendering and gzip
+ingest) against a generated corpus. Results, allocations per iteration included, are written as JSON; progress goes to stderr.
+
+Usage:
+    {0:s}-bench [-options]
+
+Arguments:
+    --lines,    -n[count]       The number of lines in the corpus. Default: 500000
+    --clients,  -c[count]       Distinct clients. Default: {2:d}
+    --uris,     -u[count]       Distinct URIs. Default: {3:d}
+    --user-agents [count]       Distinct user agents. Default: {4:d}
+    --zipf      [exponent]      The skew of clients, URIs and user agents. Default: {5:g}
+    --uri-padding [chars]       URIs get 0 to 2x this many extra characters, to vary the line length. Default: {6:d}
+    --format    [name]          common, combined or vhost_combined. Default: combined
+    --seed,     -s[seed]        The corpus's seed; equal options produce equal corpora. Default: {7:d}
+    --filter,   -f[text]        Only run the benchmarks whose name contains [text]
+    --min-time, -t[ms]          Repeat each benchmark for at least this long. Default: 500
+    --min-iterations [count]    Repeat each benchmark at least this often. Default: 3
+    --output,   -o[file]        Write the JSON to [file] instead of stdout
+    --check-allocations         Exit with 1 if parsing, or aggregating keys already in the tables, allocates once warmed up
+    --runs      [count]         Run the whole set this often and report the median of the runs' medians. Default: 1
+    --warm-up   [ms]            Run each benchmark for this long before timing it. Default: a single iteration
+    --cpu       [cpu]           Pin the benchmarks to a CPU, for reproducible timings
+    --baseline  [file]          Compare the medians with a baseline file; exit with 1 if any regressed beyond its tolerance
+    --tolerance [percent]       The tolerance of baseline entries which don't set their own. Default: 10
+    --write-baseline [file]     Write the medians as a baseline file, keeping the tolerances it already has
+)", httpdreport::resources::APP_NAME, httpdreport::resources::APP_VERSION, defaults.clientCount, defaults.uriCount, defaults.userAgentCount,
+    defaults.zipfExponent, defaults.uriPadding, defaults.seed) << endl;
+}
@@ -0,0 +1,501 @@
+/**
+ * @file scaling.cpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the scaling harness, which runs the whole pipeline at growing thread counts and client cardinalities.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "LogReader.hpp"
+#include "ReportOutput.hpp"
+#include "ReportRenderer.hpp"
+#include "RequestAggregator.hpp"
+#include "SyntheticLog.hpp"
+#include "resources/Resources.hpp"
+
+using fmt::format;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::string_view;
+using std::unique_ptr;
+using std::vector;
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief What a single run of the pipeline reports back to the harness; a plain struct, so it can be sent through a pipe.
+ */
+struct RunResult {
+    uint64_t    lines{0};
+    uint64_t    rejectedLines{0};
+    uint64_t    clients{0}; //!< Distinct clients in the merged tables
+    double      readNanos{0}; //!< Reading, parsing and aggregating, all threads in parallel
+    double      mergeNanos{0}; //!< Merging the threads' tables
+    double      renderNanos{0};
+    double      totalNanos{0};
+};
+
+/**
+ * @brief A configuration of the sweep with the median of its runs.
+ */
+struct SweepPoint {
+    size_t      threads{1};
+    uint64_t    clientCount{0}; //!< The cardinality of the corpus's client distribution
+    uint64_t    bytes{0};
+    RunResult   median{};
+    uint64_t    peakRssBytes{0}; //!< The highest peak RSS of the runs
+    double      speedup{1};
+    double      efficiency{1}; //!< Speedup per thread
+};
+
+//=======================================
+// Prototypes
+//=======================================
+int parseArgs(const int32_t argc, char* const* argv); //!< Parses incoming command-line arguments
+bool parseList(const char* value, vector<uint64_t>& list); //!< Parses 1,2,4 or 1e3,1e4
+uint64_t getCorpusLines(uint64_t clientCount); //!< Gets the lines a corpus needs to reach a cardinality
+bool writeCorpus(const fs::path& path, uint64_t clientCount); //!< Generates a corpus with the given cardinality
+RunResult runPipeline(const fs::path& path, size_t threads); //!< Reads, merges and renders the corpus with the given threads
+bool measure(const fs::path& path, size_t threads, SweepPoint& point); //!< Runs the pipeline in child processes and keeps the median
+void printPoint(const char* sweep, const SweepPoint& point); //!< Prints a row of the table to stderr
+string toJson(const vector<SweepPoint>& threadSweep, const vector<SweepPoint>& cardinalitySweep); //!< Renders the sweeps for scripts
+
+void printHelp(); //!< Prints the help text to the terminal
+
+static httpdreport::SyntheticLogOptions g_corpusOptions{};
+static vector<uint64_t> g_threadCounts{};
+static vector<uint64_t> g_clientCounts{ 1000, 10000, 100000, 1000000, 10000000 };
+static uint64_t g_threadSweepClients{100000};
+static uint64_t g_maxCorpusLines{20000000}; //!< Cardinalities needing larger corpora are skipped
+static uint64_t g_repeats{3};
+static bool g_runThreadSweep{true};
+static bool g_runCardinalitySweep{true};
+static string g_outputFile{};
+
+int main(const int32_t argc, char* const* argv) {
+    g_corpusOptions.lineCount = 1000000;
+    g_corpusOptions.zipfExponent = 0.6; // flatter than real traffic, so the distinct clients keep growing with the cardinality
+    for (uint64_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) { g_threadCounts.push_back(threads); }
+
+    if (auto retCode = parseArgs(argc, argv); retCode > 0) {
+        return retCode - 1;
+    }
+
+#ifndef __OPTIMIZE__
+    cerr << "Warning: this harness was built without optimisation; its results don't reflect a release build." << endl;
+#endif
+
+    const auto corpusFile = fs::temp_directory_path() / format("httpd-hit-report-scaling-{0:d}.access.log", getpid());
+    const auto maxThreads = static_cast<size_t>(*std::max_element(g_threadCounts.begin(), g_threadCounts.end()));
+    vector<SweepPoint> threadSweep;
+    vector<SweepPoint> cardinalitySweep;
+    auto success = true;
+
+    cerr << format("{0:<12s} {1:>7s} {2:>10s} {3:>10s} {4:>9s} {5:>9s} {6:>9s} {7:>10s} {8:>9s} {9:>8s} {10:>7s} {11:>9s}",
+        "sweep", "threads", "clients", "distinct", "wall s", "read s", "merge s", "M lines/s", "MiB/s", "speedup", "effic.", "RSS MiB") << endl;
+
+    if (g_runThreadSweep && getCorpusLines(g_threadSweepClients) > g_maxCorpusLines) {
+        cerr << format("Skipping the thread sweep: {0:d} clients need {1:d} lines, more than --max-lines {2:d}",
+            g_threadSweepClients, getCorpusLines(g_threadSweepClients), g_maxCorpusLines) << endl;
+    } else if (g_runThreadSweep && (success = writeCorpus(corpusFile, g_threadSweepClients))) {
+        for (const auto threads : g_threadCounts) {
+            SweepPoint point;
+            point.clientCount = g_threadSweepClients;
+            if (!(success = measure(corpusFile, threads, point))) { break; }
+
+            const auto baseNanos = threadSweep.empty() ? point.median.totalNanos * static_cast<double>(threads) : threadSweep.front().median.totalNanos * static_cast<double>(threadSweep.front().threads);
+            point.speedup = baseNanos / point.median.totalNanos;
+            point.efficiency = point.speedup / static_cast<double>(threads);
+            threadSweep.push_back(point);
+            printPoint("threads", point);
+        }
+    }
+
+    for (const auto clients : g_clientCounts) {
+        if (!success || !g_runCardinalitySweep) { break; }
+        if (getCorpusLines(clients) > g_maxCorpusLines) {
+            cerr << format("Skipping {0:d} clients: they need {1:d} lines, more than --max-lines {2:d}", clients, getCorpusLines(clients), g_maxCorpusLines) << endl;
+            continue;
+        }
+
+        if (!(success = writeCorpus(corpusFile, clients))) { break; }
+
+        // the single-threaded run of the same corpus is the base of the speedup
+        SweepPoint single;
+        SweepPoint point;
+        single.clientCount = point.clientCount = clients;
+        if (!(success = measure(corpusFile, 1, single) && (maxThreads == 1 || measure(corpusFile, maxThreads, point)))) { break; }
+        if (maxThreads == 1) { point = single; }
+
+        point.speedup = single.median.totalNanos / point.median.totalNanos;
+        point.efficiency = point.speedup / static_cast<double>(point.threads);
+        cardinalitySweep.push_back(point);
+        printPoint("cardinality", point);
+    }
+
+    std::error_code ignored;
+    fs::remove(corpusFile, ignored);
+    if (!success) { return 1; }
+
+    const auto json = toJson(threadSweep, cardinalitySweep);
+    if (g_outputFile.empty()) {
+        cout << json << std::flush;
+        return 0;
+    }
+
+    auto* output = fopen(g_outputFile.c_str(), "w");
+    if (output == nullptr || fwrite(json.data(), 1, json.size(), output) != json.size() || fclose(output) != 0) {
+        cerr << format("Failed to write {0:s}: {1:s}", g_outputFile, strerror(errno)) << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Gets the lines a corpus needs for its distinct clients to approach clientCount: at least --lines, and two per client.
+ *
+ * With fewer lines than clients, most of the distribution is never drawn and the sweep measures the line count, not the cardinality.
+ */
+uint64_t getCorpusLines(uint64_t clientCount) {
+    static constexpr uint64_t LINES_PER_CLIENT = 2;
+
+    return std::max(g_corpusOptions.lineCount, clientCount * LINES_PER_CLIENT);
+}
+
+/**
+ * @brief Writes a corpus of getCorpusLines() lines to path and reads it once, so every run finds it in the page cache.
+ */
+bool writeCorpus(const fs::path& path, uint64_t clientCount) {
+    static constexpr uint64_t BLOCK_LINES = 65536;
+
+    auto options = g_corpusOptions;
+    options.clientCount = clientCount;
+    options.lineCount = getCorpusLines(clientCount);
+    httpdreport::SyntheticLogGenerator generator(options);
+
+    auto* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        cerr << format("Failed to create {0:s}: {1:s}", path.string(), strerror(errno)) << endl;
+        return false;
+    }
+
+    string block;
+    for (uint64_t line = 0; line < options.lineCount; line += BLOCK_LINES) {
+        block.clear();
+        generator.startBlock(line / BLOCK_LINES, line);
+        generator.appendLines(block, std::min(BLOCK_LINES, options.lineCount - line));
+        fwrite(block.data(), 1, block.size(), file);
+    }
+
+    if (ferror(file) != 0 || fclose(file) != 0) {
+        cerr << format("Failed to write {0:s}: {1:s}", path.string(), strerror(errno)) << endl;
+        return false;
+    }
+
+    httpdreport::LogReader reader;
+    uint64_t lines = 0;
+    return reader.readFile(path, [&](string_view) { lines++; });
+}
+
+/**
+ * @brief Runs the pipeline like a distributed run within one process: every thread reads a byte range of the file in to
+ * tables of its own, then the tables are merged and the report is rendered to /dev/null.
+ */
+RunResult runPipeline(const fs::path& path, size_t threads) {
+    using clock = std::chrono::steady_clock;
+
+    std::error_code error;
+    const auto size = fs::file_size(path, error);
+
+    vector<unique_ptr<httpdreport::RequestAggregator>> aggregators;
+    vector<RunResult> partials(threads);
+    for (size_t i = 0; i < threads; i++) { aggregators.push_back(std::make_unique<httpdreport::RequestAggregator>()); }
+
+    const auto start = clock::now();
+    vector<std::thread> workers;
+    for (size_t i = 0; i < threads; i++) {
+        workers.emplace_back([&, i]() {
+            const auto rangeStart = size * i / threads;
+            const auto rangeEnd = size * (i + 1) / threads;
+
+            httpdreport::LogReader reader;
+            httpdreport::RequestRecord record;
+            auto& aggregator = *aggregators[i];
+            auto& partial = partials[i];
+            reader.readRange(path, rangeStart, [&](string_view line) {
+                partial.lines++;
+                if (httpdreport::parseRequestRecord(line, record)) {
+                    aggregator.add(record);
+                } else {
+                    partial.rejectedLines++;
+                }
+            }, [rangeEnd](uint64_t) { return rangeEnd; });
+        });
+    }
+    for (auto& worker : workers) { worker.join(); }
+    const auto read = clock::now();
+
+    for (size_t i = 1; i < threads; i++) { aggregators.front()->merge(*aggregators[i]); }
+    const auto merged = clock::now();
+
+    httpdreport::ReportOutput output;
+    if (output.open("/dev/null", httpdreport::ReportOutput::Compression::NONE)) {
+        httpdreport::ReportRenderer(*aggregators.front(), output).render();
+        output.close();
+    }
+    const auto rendered = clock::now();
+
+    RunResult result;
+    for (const auto& partial : partials) {
+        result.lines += partial.lines;
+        result.rejectedLines += partial.rejectedLines;
+    }
+    result.clients = aggregators.front()->getClientCount();
+    result.readNanos = std::chrono::duration<double, std::nano>(read - start).count();
+    result.mergeNanos = std::chrono::duration<double, std::nano>(merged - read).count();
+    result.renderNanos = std::chrono::duration<double, std::nano>(rendered - merged).count();
+    result.totalNanos = std::chrono::duration<double, std::nano>(rendered - start).count();
+
+    return result;
+}
+
+/**
+ * @brief Runs the pipeline g_repeats times, each in a child process of its own, so every run starts with a fresh heap and
+ * reports its own peak RSS.
+ */
+bool measure(const fs::path& path, size_t threads, SweepPoint& point) {
+    vector<RunResult> runs;
+    point.threads = threads;
+    point.bytes = fs::file_size(path);
+
+    for (uint64_t repeat = 0; repeat < g_repeats; repeat++) {
+        int fds[2] = {-1, -1};
+        if (pipe(fds) != 0) {
+            cerr << format("Failed to create a pipe: {0:s}", strerror(errno)) << endl;
+            return false;
+        }
+
+        const auto child = fork();
+        if (child == 0) {
+            close(fds[0]);
+            const auto result = runPipeline(path, threads);
+            _exit(write(fds[1], &result, sizeof(result)) == sizeof(result) ? 0 : 1);
+        }
+        close(fds[1]);
+        if (child < 0) {
+            close(fds[0]);
+            cerr << format("Failed to fork: {0:s}", strerror(errno)) << endl;
+            return false;
+        }
+
+        RunResult result;
+        const auto received = read(fds[0], &result, sizeof(result));
+        close(fds[0]);
+
+        int status = 0;
+        rusage usage{};
+        if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || received != sizeof(result)) {
+            cerr << format("The run with {0:d} threads failed", threads) << endl;
+            return false;
+        }
+
+        runs.push_back(result);
+        point.peakRssBytes = std::max(point.peakRssBytes, static_cast<uint64_t>(usage.ru_maxrss) * 1024);
+    }
+
+    std::sort(runs.begin(), runs.end(), [](const RunResult& a, const RunResult& b) { return a.totalNanos < b.totalNanos; });
+    point.median = runs[runs.size() / 2];
+
+    return true;
+}
+
+void printPoint(const char* sweep, const SweepPoint& point) {
+    const auto seconds = point.median.totalNanos / 1e9;
+    cerr << format(
+        "{0:<12s} {1:>7d} {2:>10d} {3:>10d} {4:>9.3f} {5:>9.3f} {6:>9.3f} {7:>10.2f} {8:>9.1f} {9:>8.2f} {10:>7.2f} {11:>9.1f}",
+        sweep, point.threads, point.clientCount, point.median.clients, seconds, point.median.readNanos / 1e9, point.median.mergeNanos / 1e9,
+        static_cast<double>(point.median.lines) / seconds / 1e6, static_cast<double>(point.bytes) / seconds / 1048576.0, point.speedup,
+        point.efficiency, static_cast<double>(point.peakRssBytes) / 1048576.0
+    ) << endl;
+}
+
+string toJson(const vector<SweepPoint>& threadSweep, const vector<SweepPoint>& cardinalitySweep) {
+#ifdef __OPTIMIZE__
+    const bool optimized = true;
+#else
+    const bool optimized = false;
+#endif
+
+    const auto pointsToJson = [](const vector<SweepPoint>& points) {
+        string json = "[";
+        for (size_t i = 0; i < points.size(); i++) {
+            const auto& point = points[i];
+            const auto seconds = point.median.totalNanos / 1e9;
+            json += format(
+                R"({0:s}{{"threads":{1:d},"clients":{2:d},"distinct_clients":{3:d},"lines":{4:d},"rejected_lines":{5:d},"bytes":{6:d},"wall_seconds":{7:.6f},"read_seconds":{8:.6f},"merge_seconds":{9:.6f},"render_seconds":{10:.6f},"lines_per_second":{11:.0f},"bytes_per_second":{12:.0f},"speedup":{13:.4f},"efficiency":{14:.4f},"peak_rss_bytes":{15:d}}})",
+                i == 0 ? "" : ",", point.threads, point.clientCount, point.median.clients, point.median.lines, point.median.rejectedLines, point.bytes, seconds,
+                point.median.readNanos / 1e9, point.median.mergeNanos / 1e9, point.median.renderNanos / 1e9, static_cast<double>(point.median.lines) / seconds,
+                static_cast<double>(point.bytes) / seconds, point.speedup, point.efficiency, point.peakRssBytes
+            );
+        }
+
+        return json + "]";
+    };
+
+    return format(
+        R"({{"version":"{0:s}","optimized":{1:s},"hardware_threads":{2:d},"corpus":{{"min_lines":{3:d},"max_lines":{4:d},"zipf_exponent":{5:g},"seed":{6:d}}},"repeats":{7:d},"thread_sweep":{8:s},"cardinality_sweep":{9:s}}})",
+        httpdreport::resources::APP_VERSION, optimized ? "true" : "false", std::thread::hardware_concurrency(), g_corpusOptions.lineCount, g_maxCorpusLines,
+        g_corpusOptions.zipfExponent, g_corpusOptions.seed, g_repeats, pointsToJson(threadSweep), pointsToJson(cardinalitySweep)
+    ) + "\n";
+}
+
+bool parseList(const char* value, vector<uint64_t>& list) {
+    list.clear();
+    for (char* cursor = const_cast<char*>(value); *cursor != '\0';) {
+        // strtod accepts 1e6 as well as 1000000
+        const auto number = std::strtod(cursor, &cursor);
+        if (number < 1) { return false; }
+
+        list.push_back(static_cast<uint64_t>(number));
+        if (*cursor == ',') { cursor++; } else if (*cursor != '\0') { return false; }
+    }
+
+    return !list.empty();
+}
+
+int parseArgs(const int32_t argc, char* const* argv) {
+    static const string SHORT_OPTS = "hn:j:c:r:s:o:";
+    static const option OPTIONS[] = {
+        { "help",           no_argument,        nullptr, 'h' },
+        { "lines",          required_argument,  nullptr, 'n' },
+        { "threads",        required_argument,  nullptr, 'j' },
+        { "clients",        required_argument,  nullptr, 'c' },
+        { "repeat",         required_argument,  nullptr, 'r' },
+        { "seed",           required_argument,  nullptr, 's' },
+        { "output",         required_argument,  nullptr, 'o' },
+        { "zipf",           required_argument,  nullptr, 0x100 },
+        { "thread-clients", required_argument,  nullptr, 0x101 },
+        { "only",           required_argument,  nullptr, 0x102 },
+        { "max-lines",      required_argument,  nullptr, 0x103 },
+        { nullptr,          no_argument,        nullptr,  0  }
+    };
+
+    int32_t optChar = 0;
+    while ((optChar = getopt_long(argc, argv, SHORT_OPTS.c_str(), OPTIONS, nullptr)) != -1) {
+        switch (optChar) {
+            case 'h':
+                printHelp();
+                return 1;
+            case 'n':
+                g_corpusOptions.lineCount = std::max<uint64_t>(1, static_cast<uint64_t>(std::strtod(optarg, nullptr)));
+                break;
+            case 'j':
+                if (!parseList(optarg, g_threadCounts)) {
+                    cerr << format("Invalid thread counts {0:s}; expected e.g. 1,2,4,8", optarg) << endl;
+                    return 2;
+                }
+                break;
+            case 'c':
+                if (!parseList(optarg, g_clientCounts)) {
+                    cerr << format("Invalid client counts {0:s}; expected e.g. 1e3,1e5,1e7", optarg) << endl;
+                    return 2;
+                }
+                break;
+            case 'r':
+                g_repeats = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 's':
+                g_corpusOptions.seed = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'o':
+                g_outputFile = optarg;
+                break;
+            case 0x100:
+                g_corpusOptions.zipfExponent = std::max(0.01, std::strtod(optarg, nullptr));
+                break;
+            case 0x101:
+                g_threadSweepClients = std::max<uint64_t>(1, static_cast<uint64_t>(std::strtod(optarg, nullptr)));
+                break;
+            case 0x102:
+                g_runThreadSweep = string_view(optarg) == "threads";
+                g_runCardinalitySweep = string_view(optarg) == "cardinality";
+                if (!g_runThreadSweep && !g_runCardinalitySweep) {
+                    cerr << format("Unknown sweep {0:s}; expected threads or cardinality", optarg) << endl;
+                    return 2;
+                }
+                break;
+            case 0x103:
+                g_maxCorpusLines = std::max<uint64_t>(1, static_cast<uint64_t>(std::strtod(optarg, nullptr)));
+                break;
+            default:
+                return 2;
+        }
+    }
+
+    return 0;
+}
+
+void printHelp() {
+    cout << format(
+R"({0:s}-scaling {1:s}
+
+Runs the whole pipeline (reading, parsing and aggregating in parallel byte ranges, merging the threads' tables and rendering
+the report) over a generated corpus: once per thread count, then once per client cardinality at 1 and the highest thread
+count. Every run is a child process of its own, so peak RSS is per run. A table goes to stderr, JSON to stdout.
+
+Usage:
+    {0:s}-scaling [-options]
+
+Arguments:
+    --lines,    -n[count]       The minimum number of lines in each corpus; a corpus has at least two lines per client,
+                                so its distinct clients approach the cardinality. Default: 1000000
+    --max-lines [count]         Skip cardinalities whose corpus would need more lines. Default: 2e7
+    --threads,  -j[list]        The thread counts of the thread sweep. Default: powers of two up to the hardware threads
+    --clients,  -c[list]        The client cardinalities of the cardinality sweep. Default: 1e3,1e4,1e5,1e6,1e7
+    --thread-clients [count]    The client cardinality of the thread sweep. Default: 1e5
+    --zipf      [exponent]      The skew of clients, URIs and user agents. Default: 0.6
+    --repeat,   -r[count]       Runs per configuration; the median is reported. Default: 3
+    --seed,     -s[seed]        Default: 1
+    --only      [sweep]         Only run the threads or the cardinality sweep
+    --output,   -o[file]        Write the JSON to [file] instead of stdout
+)", httpdreport::resources::APP_NAME, httpdreport::resources::APP_VERSION) << endl;
+}
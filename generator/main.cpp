@@ -0,0 +1,543 @@
+/**
+ * @file main.cpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the synthetic access log generator, which writes reproducible corpora of any size.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <string.h>
+#include <unistd.h>
+
+// zlib
+#include <zlib.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "SyntheticLog.hpp"
+#include "resources/Resources.hpp"
+
+using fmt::format;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::string_view;
+using std::vector;
+
+/**
+ * @brief A run of consecutive lines, generated (and compressed) by one thread and written by the main thread.
+ */
+struct Block {
+    uint64_t    number{0}; //!< Seeds the block's lines, together with the seed
+    uint64_t    firstLine{0};
+    uint64_t    lineCount{0};
+    size_t      fileIndex{0}; //!< The file the block belongs to; 0 is the oldest
+};
+
+/**
+ * @brief A buffer handed from a generating thread to the writer.
+ */
+struct Slot {
+    uint64_t    blockIndex{UINT64_MAX}; //!< The block the slot holds, once ready
+    bool        ready{false};
+    string      text{};
+    string      compressed{};
+};
+
+/**
+ * @brief One of the files written; rotated files are numbered like logrotate's, so the highest number holds the oldest lines.
+ */
+struct OutputFile {
+    string      path{};
+    bool        compressed{false};
+};
+
+//=======================================
+// Prototypes
+//=======================================
+int parseArgs(const int32_t argc, char* const* argv); //!< Parses incoming command-line arguments
+bool parseStatusWeights(string_view value, vector<std::pair<uint16_t, double>>& weights); //!< Parses 200:82,404:7,...
+bool parseCount(const char* value, uint64_t& count); //!< Parses a number with an optional decimal k/M/G suffix (1k = 1000)
+bool parseByteSize(const char* value, uint64_t& bytes); //!< Parses a number with an optional binary k/M/G/T suffix (1k = 1024)
+bool parseDuration(const char* value, uint64_t& seconds); //!< Parses a number with an optional s/m/h/d suffix
+uint64_t estimateLineCount(uint64_t targetBytes); //!< Estimates how many lines make up targetBytes
+vector<OutputFile> planFiles(uint64_t lineCount); //!< Names the output files and decides which are compressed
+vector<Block> planBlocks(uint64_t lineCount); //!< Splits the lines in to blocks, none of which spans two files
+bool compressBlock(const string& text, string& compressed); //!< Compresses text in to a self-contained gzip member
+int generate(); //!< Generates the corpus
+
+void printHelp(); //!< Prints the help text to the terminal
+
+static httpdreport::SyntheticLogOptions g_logOptions{};
+static uint64_t g_targetLines{0};
+static uint64_t g_targetBytes{0};
+static uint64_t g_linesPerFile{0};
+static string g_outputPath{};
+static bool g_compressRotated{false};
+static bool g_delayCompress{false};
+static int32_t g_compressionLevel{1};
+static size_t g_threadCount{std::max(1u, std::thread::hardware_concurrency())};
+
+static constexpr uint64_t BLOCK_LINES = 65536; //!< Part of the corpus's definition: changing it changes the lines a seed produces
+static constexpr uint64_t SAMPLE_LINES = 4096; //!< The lines generated to estimate the line length for --size
+
+int main(const int32_t argc, char* const* argv) {
+    if (auto retCode = parseArgs(argc, argv); retCode > 0) {
+        return retCode - 1;
+    }
+
+    return generate();
+}
+
+int generate() {
+    if (const auto error = httpdreport::SyntheticLogGenerator(g_logOptions).getLastError(); !error.empty()) {
+        cerr << format("Invalid log format: {0:s}", error) << endl;
+        return 1;
+    }
+    if (g_linesPerFile > 0 && g_outputPath.empty()) {
+        cerr << "--rotate requires --output" << endl;
+        return 1;
+    }
+
+    const auto lineCount = g_targetBytes > 0 ? estimateLineCount(g_targetBytes) : (g_targetLines > 0 ? g_targetLines : 1000000);
+    g_logOptions.lineCount = lineCount;
+
+    const auto files = planFiles(lineCount);
+    const auto blocks = planBlocks(lineCount);
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // blocks are generated in any order by any thread, but the writer takes them strictly in order
+    const auto slotCount = 2 * g_threadCount;
+    vector<Slot> slots(slotCount);
+    std::mutex lock;
+    std::condition_variable slotFreed;
+    std::condition_variable slotFilled;
+    std::atomic<uint64_t> nextBlock{0};
+    uint64_t nextToWrite = 0;
+    std::atomic<bool> failed{false};
+
+    vector<std::thread> threads;
+    for (size_t i = 0; i < g_threadCount; i++) {
+        threads.emplace_back([&]() {
+            httpdreport::SyntheticLogGenerator generator(g_logOptions);
+            while (!failed) {
+                const auto index = nextBlock.fetch_add(1);
+                if (index >= blocks.size()) { return; }
+
+                const auto& block = blocks[index];
+                auto& slot = slots[index % slotCount];
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    slotFreed.wait(guard, [&]() { return failed || index < nextToWrite + slotCount; });
+                    if (failed) { return; }
+                }
+
+                slot.text.clear();
+                generator.startBlock(block.number, block.firstLine);
+                generator.appendLines(slot.text, block.lineCount);
+                if (files[block.fileIndex].compressed && !compressBlock(slot.text, slot.compressed)) { failed = true; }
+
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    slot.blockIndex = index;
+                    slot.ready = true;
+                }
+                slotFilled.notify_all();
+            }
+        });
+    }
+
+    int fd = g_outputPath.empty() ? STDOUT_FILENO : -1;
+    size_t openFile = SIZE_MAX;
+    uint64_t bytesWritten = 0;
+    uint64_t uncompressedBytes = 0;
+    string error;
+
+    for (uint64_t index = 0; index < blocks.size() && error.empty(); index++) {
+        auto& slot = slots[index % slotCount];
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            slotFilled.wait(guard, [&]() { return failed || (slot.ready && slot.blockIndex == index); });
+            if (failed) {
+                error = "failed to compress a block";
+                break;
+            }
+        }
+
+        const auto& block = blocks[index];
+        if (!g_outputPath.empty() && block.fileIndex != openFile) {
+            if (fd >= 0 && close(fd) != 0) { error = format("failed to write {0:s}: {1:s}", files[openFile].path, strerror(errno)); break; }
+
+            openFile = block.fileIndex;
+            if ((fd = open(files[openFile].path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0) {
+                error = format("failed to create {0:s}: {1:s}", files[openFile].path, strerror(errno));
+                break;
+            }
+        }
+
+        const auto& data = files[block.fileIndex].compressed ? slot.compressed : slot.text;
+        for (size_t offset = 0; offset < data.size();) {
+            const auto written = write(fd, data.data() + offset, data.size() - offset);
+            if (written < 0 && errno == EINTR) { continue; }
+            if (written <= 0) {
+                error = format("failed to write {0:s}: {1:s}", g_outputPath.empty() ? string("stdout") : files[block.fileIndex].path, strerror(errno));
+                break;
+            }
+            offset += static_cast<size_t>(written);
+        }
+        bytesWritten += data.size();
+        uncompressedBytes += slot.text.size();
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            slot.ready = false;
+            nextToWrite = index + 1;
+        }
+        slotFreed.notify_all();
+    }
+
+    if (!error.empty()) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            failed = true;
+        }
+        slotFreed.notify_all();
+    }
+    for (auto& thread : threads) { thread.join(); }
+
+    if (!g_outputPath.empty() && fd >= 0 && close(fd) != 0 && error.empty()) { error = format("failed to write {0:s}: {1:s}", files[openFile].path, strerror(errno)); }
+    if (!error.empty()) {
+        cerr << format("Failed to generate the logs: {0:s}", error) << endl;
+        return 1;
+    }
+
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    cerr << format(
+        "Wrote {0:d} lines in {1:d} files: {2:d} bytes ({3:d} uncompressed) in {4:.2f} s, {5:.0f} MiB/s uncompressed with {6:d} threads",
+        lineCount, files.size(), bytesWritten, uncompressedBytes, seconds, seconds > 0 ? static_cast<double>(uncompressedBytes) / seconds / 1048576.0 : 0.0, g_threadCount
+    ) << endl;
+
+    return 0;
+}
+
+/**
+ * @brief Estimates the number of lines needed for targetBytes from a sample, which is drawn from a stream of its own; the
+ * estimate (and with it the corpus) is still a function of the options alone.
+ */
+uint64_t estimateLineCount(uint64_t targetBytes) {
+    auto sampleOptions = g_logOptions;
+    sampleOptions.lineCount = SAMPLE_LINES;
+
+    httpdreport::SyntheticLogGenerator generator(sampleOptions);
+    generator.startBlock(UINT64_MAX, 0);
+
+    string sample;
+    generator.appendLines(sample, SAMPLE_LINES);
+
+    return std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(targetBytes) * SAMPLE_LINES / static_cast<double>(sample.size())));
+}
+
+vector<OutputFile> planFiles(uint64_t lineCount) {
+    const auto endsWithGz = g_outputPath.size() > 3 && g_outputPath.compare(g_outputPath.size() - 3, 3, ".gz") == 0;
+    const auto fileCount = g_linesPerFile > 0 ? static_cast<size_t>((lineCount + g_linesPerFile - 1) / g_linesPerFile) : 1;
+
+    vector<OutputFile> files(fileCount);
+    for (size_t i = 0; i < fileCount; i++) {
+        // the newest file has no number; like logrotate's delaycompress, .1 may be left uncompressed
+        const auto generation = fileCount - 1 - i;
+        auto& file = files[i];
+        file.compressed = endsWithGz || (g_compressRotated && generation >= (g_delayCompress ? 2u : 1u));
+        file.path = generation == 0 ? g_outputPath : format("{0:s}.{1:d}{2:s}", g_outputPath, generation, file.compressed && !endsWithGz ? ".gz" : "");
+    }
+
+    return files;
+}
+
+vector<Block> planBlocks(uint64_t lineCount) {
+    const auto linesPerFile = g_linesPerFile > 0 ? g_linesPerFile : lineCount;
+
+    vector<Block> blocks;
+    for (uint64_t line = 0; line < lineCount;) {
+        const auto fileIndex = static_cast<size_t>(line / linesPerFile);
+        const auto fileEnd = std::min(lineCount, (fileIndex + 1) * linesPerFile);
+
+        Block block;
+        block.number = blocks.size();
+        block.firstLine = line;
+        block.lineCount = std::min(BLOCK_LINES, fileEnd - line);
+        block.fileIndex = fileIndex;
+        blocks.push_back(block);
+
+        line += block.lineCount;
+    }
+
+    return blocks;
+}
+
+/**
+ * @brief Compresses a block in to a gzip member of its own. Concatenated members form a valid gzip file, so blocks can be
+ * compressed in parallel.
+ */
+bool compressBlock(const string& text, string& compressed) {
+    z_stream stream{};
+    if (deflateInit2(&stream, g_compressionLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) { return false; }
+
+    compressed.resize(deflateBound(&stream, static_cast<uLong>(text.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    stream.avail_in = static_cast<uInt>(text.size());
+    stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+
+    const auto result = deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return result == Z_STREAM_END;
+}
+
+/**
+ * @brief Parses a non-negative number followed by at most one of the given unit suffixes.
+ *
+ * @return false If the number is missing or negative, or the suffix isn't one of units.
+ */
+bool parseQuantity(const char* value, std::initializer_list<std::pair<char, double>> units, uint64_t& quantity) {
+    char* suffix = nullptr;
+    const auto number = std::strtod(value, &suffix);
+    if (suffix == value || number < 0) { return false; }
+
+    double multiplier = 1;
+    if (*suffix != '\0') {
+        const auto unit = std::find_if(units.begin(), units.end(), [&](const auto& entry) { return entry.first == *suffix; });
+        if (unit == units.end() || suffix[1] != '\0') { return false; }
+        multiplier = unit->second;
+    }
+
+    quantity = static_cast<uint64_t>(number * multiplier);
+    return true;
+}
+
+// counts and bytes have separate parsers, so 200k lines are 200000 lines and M can't be mistaken for m(inutes)
+bool parseCount(const char* value, uint64_t& count) { return parseQuantity(value, { {'k', 1e3}, {'K', 1e3}, {'M', 1e6}, {'G', 1e9} }, count); }
+
+bool parseByteSize(const char* value, uint64_t& bytes) {
+    return parseQuantity(value, { {'k', 0x1p10}, {'K', 0x1p10}, {'M', 0x1p20}, {'G', 0x1p30}, {'T', 0x1p40} }, bytes);
+}
+
+bool parseDuration(const char* value, uint64_t& seconds) { return parseQuantity(value, { {'s', 1}, {'m', 60}, {'h', 3600}, {'d', 86400} }, seconds); }
+
+bool parseStatusWeights(string_view value, vector<std::pair<uint16_t, double>>& weights) {
+    weights.clear();
+    while (!value.empty()) {
+        const auto comma = value.find(',');
+        const auto entry = string(value.substr(0, comma));
+        value = comma == string_view::npos ? string_view() : value.substr(comma + 1);
+
+        const auto colon = entry.find(':');
+        if (colon == string::npos) { return false; }
+
+        const auto status = std::strtoul(entry.c_str(), nullptr, 10);
+        const auto weight = std::strtod(entry.c_str() + colon + 1, nullptr);
+        if (status < 100 || status > 999 || weight < 0) { return false; }
+
+        weights.emplace_back(static_cast<uint16_t>(status), weight);
+    }
+
+    return !weights.empty();
+}
+
+int parseArgs(const int32_t argc, char* const* argv) {
+    static const string SHORT_OPTS = "hn:S:s:c:u:f:o:j:";
+    static const option OPTIONS[] = {
+        { "help",           no_argument,        nullptr, 'h' },
+        { "lines",          required_argument,  nullptr, 'n' },
+        { "size",           required_argument,  nullptr, 'S' },
+        { "seed",           required_argument,  nullptr, 's' },
+        { "clients",        required_argument,  nullptr, 'c' },
+        { "uris",           required_argument,  nullptr, 'u' },
+        { "format",         required_argument,  nullptr, 'f' },
+        { "output",         required_argument,  nullptr, 'o' },
+        { "threads",        required_argument,  nullptr, 'j' },
+        { "user-agents",    required_argument,  nullptr, 0x100 },
+        { "zipf",           required_argument,  nullptr, 0x101 },
+        { "uri-padding",    required_argument,  nullptr, 0x102 },
+        { "status",         required_argument,  nullptr, 0x103 },
+        { "ipv6",           required_argument,  nullptr, 0x104 },
+        { "malformed",      required_argument,  nullptr, 0x105 },
+        { "start",          required_argument,  nullptr, 0x106 },
+        { "span",           required_argument,  nullptr, 0x107 },
+        { "rotate",         required_argument,  nullptr, 0x108 },
+        { "compress",       no_argument,        nullptr, 0x109 },
+        { "delay-compress", no_argument,        nullptr, 0x10a },
+        { "level",          required_argument,  nullptr, 0x10b },
+        { nullptr,          no_argument,        nullptr,  0  }
+    };
+
+    const auto invalidValue = [](string_view option, const char* value, string_view example) {
+        cerr << format("Invalid {0:s} {1:s}; expected e.g. {2:s}", option, value, example) << endl;
+        return 2;
+    };
+
+    uint64_t quantity = 0;
+    int32_t optChar = 0;
+    while ((optChar = getopt_long(argc, argv, SHORT_OPTS.c_str(), OPTIONS, nullptr)) != -1) {
+        switch (optChar) {
+            case 'h':
+                printHelp();
+                return 1;
+            case 'n':
+                if (!parseCount(optarg, quantity)) { return invalidValue("--lines", optarg, "200k or 1M"); }
+                g_targetLines = std::max<uint64_t>(1, quantity);
+                break;
+            case 'S':
+                if (!parseByteSize(optarg, quantity)) { return invalidValue("--size", optarg, "512M or 100G"); }
+                g_targetBytes = std::max<uint64_t>(1, quantity);
+                break;
+            case 's':
+                g_logOptions.seed = std::strtoull(optarg, nullptr, 10);
+                break;
+            case 'c':
+                if (!parseCount(optarg, quantity)) { return invalidValue("--clients", optarg, "10k"); }
+                g_logOptions.clientCount = std::max<uint64_t>(1, quantity);
+                break;
+            case 'u':
+                if (!parseCount(optarg, quantity)) { return invalidValue("--uris", optarg, "1k"); }
+                g_logOptions.uriCount = std::max<uint64_t>(1, quantity);
+                break;
+            case 'f':
+                if (string_view(optarg) == "common") {
+                    g_logOptions.logFormat = httpdreport::syntheticformats::COMMON;
+                } else if (string_view(optarg) == "combined") {
+                    g_logOptions.logFormat = httpdreport::syntheticformats::COMBINED;
+                } else if (string_view(optarg) == "vhost_combined") {
+                    g_logOptions.logFormat = httpdreport::syntheticformats::VHOST_COMBINED;
+                } else if (string_view(optarg).find('%') != string_view::npos) {
+                    g_logOptions.logFormat = optarg;
+                } else {
+                    cerr << format("Unknown format {0:s}; expected common, combined, vhost_combined or a LogFormat string", optarg) << endl;
+                    return 2;
+                }
+                break;
+            case 'o':
+                g_outputPath = string_view(optarg) == "-" ? "" : optarg;
+                break;
+            case 'j':
+                g_threadCount = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 0x100:
+                if (!parseCount(optarg, quantity)) { return invalidValue("--user-agents", optarg, "200"); }
+                g_logOptions.userAgentCount = std::max<uint64_t>(1, quantity);
+                break;
+            case 0x101:
+                g_logOptions.zipfExponent = std::max(0.01, std::strtod(optarg, nullptr));
+                break;
+            case 0x102:
+                g_logOptions.uriPadding = std::strtoul(optarg, nullptr, 10);
+                break;
+            case 0x103:
+                if (!parseStatusWeights(optarg, g_logOptions.statusWeights)) {
+                    cerr << format("Invalid status mix {0:s}; expected e.g. 200:90,404:8,500:2", optarg) << endl;
+                    return 2;
+                }
+                break;
+            case 0x104:
+                g_logOptions.ipv6Share = std::clamp(std::strtod(optarg, nullptr), 0.0, 1.0);
+                break;
+            case 0x105:
+                g_logOptions.malformedRate = std::clamp(std::strtod(optarg, nullptr), 0.0, 1.0);
+                break;
+            case 0x106:
+                g_logOptions.startEpoch = std::strtoll(optarg, nullptr, 10);
+                break;
+            case 0x107:
+                if (!parseDuration(optarg, quantity)) { return invalidValue("--span", optarg, "90m or 7d"); }
+                g_logOptions.spanSeconds = static_cast<int64_t>(quantity);
+                break;
+            case 0x108:
+                if (!parseCount(optarg, g_linesPerFile)) { return invalidValue("--rotate", optarg, "50M"); }
+                break;
+            case 0x109:
+                g_compressRotated = true;
+                break;
+            case 0x10a:
+                g_delayCompress = true;
+                break;
+            case 0x10b:
+                g_compressionLevel = std::clamp(std::atoi(optarg), 1, 9);
+                break;
+            default:
+                return 2;
+        }
+    }
+
+    return 0;
+}
+
+void printHelp() {
+    const auto defaults = httpdreport::SyntheticLogOptions{};
+
+    cout << format(
+R"({0:s}-generator {1:s}
+
+Generates synthetic access logs. Equal options produce byte-identical logs on any machine and with any number of threads,
+so a corpus can be shared as its command line.
+
+Usage:
+    {0:s}-generator [-options] > access.log
+    {0:s}-generator -S 100G -o /data/site.access.log --rotate 50M --compress --delay-compress
+
+Arguments:
+    --lines,    -n[count]       The number of lines (suffixes k, M, G: 1k = 1000). Default: 1M
+    --size,     -S[bytes]       Generate about this many uncompressed bytes instead (suffixes k, M, G, T: 1k = 1024)
+    --seed,     -s[seed]        Default: {2:d}
+    --format,   -f[format]      common, combined, vhost_combined or an httpd LogFormat string. Default: combined
+    --clients,  -c[count]       Distinct clients, Zipf-distributed. Default: {3:d}
+    --uris,     -u[count]       Distinct URIs, Zipf-distributed. Default: {4:d}
+    --user-agents [count]       Distinct user agents, Zipf-distributed. Default: {5:d}
+    --zipf      [exponent]      The skew of clients, URIs and user agents. Default: {6:g}
+    --uri-padding [chars]       URIs get 0 to 2x this many extra characters, to vary the line length. Default: {7:d}
+    --status    [mix]           Status codes and their weights. Default: 200:82,304:6,301:2,404:7,403:1,500:1,503:1
+                                408 lines have the request "-", like timed out connections
+    --ipv6      [share]         The share of clients with IPv6 addresses, 0 to 1. Default: 0
+    --malformed [rate]          The share of lines cut off within their timestamp, 0 to 1. Default: 0
+    --start     [epoch]         The time of the first line in seconds since the epoch. Default: {8:d}
+    --span      [duration]      The time between the first and the last line (suffixes s, m, h, d). Default: 1d
+    --output,   -o[file]        The file to write; stdout if omitted. Files ending in .gz are compressed
+    --rotate    [lines]         Start a new file every [lines] lines, named like logrotate's: [file] holds the newest lines,
+                                [file].1 the ones before and so on
+    --compress                  gzip rotated files ([file].N.gz)
+    --delay-compress            With --compress, leave [file].1 uncompressed
+    --level     [1-9]           The gzip compression level. Default: 1
+    --threads,  -j[count]       Threads generating and compressing blocks. Default: all cores
+)", httpdreport::resources::APP_NAME, httpdreport::resources::APP_VERSION, defaults.seed, defaults.clientCount, defaults.uriCount,
+    defaults.userAgentCount, defaults.zipfExponent, defaults.uriPadding, defaults.startEpoch) << endl;
+}
@@ -0,0 +1,315 @@
+/**
+ * @file AccessLogParser.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the allocation-free parser for httpd access log lines.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_ACCESSLOGPARSER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_ACCESSLOGPARSER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <array>
+#include <cstring>
+#include <string_view>
+
+// libc
+#include <arpa/inet.h>
+#include <stdint.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AllocationCounter.hpp"
+
+namespace httpdreport {
+
+    using std::array;
+    using std::string_view;
+
+    using ClientAddress = array<uint8_t, 16>; //!< An IPv6 address; IPv4 addresses are stored IPv4-mapped (::ffff:a.b.c.d)
+
+    /**
+     * @brief Optional fields of a RequestRecord; anything not requested is neither decoded nor validated.
+     *
+     * The client source, vhost, request line, status code and response size are always decoded. Without FIELD_TIMESTAMP,
+     * a line with a garbled timestamp is accepted, so callers which count lines should always request it.
+     */
+    enum RecordFields : uint32_t {
+        FIELD_TIMESTAMP                 = 1 << 0, //!< Decode the timestamp in to epoch
+        FIELD_CLIENT_ADDRESS            = 1 << 1, //!< Decode the client source in to clientAddress
+        FIELD_REFERER_AND_USER_AGENT    = 1 << 2, //!< Extract the referer and user agent (combined formats)
+
+        FIELD_ALL                       = FIELD_TIMESTAMP | FIELD_CLIENT_ADDRESS | FIELD_REFERER_AND_USER_AGENT
+    };
+
+    /**
+     * @brief A single request as parsed from an access log line.
+     *
+     * All string members are views into the line the record was parsed from
+     * and are only valid for as long as the underlying buffer is.
+     */
+    struct RequestRecord final {
+        ClientAddress   clientAddress{}; //!< The client's address in binary form (all zeroes if %h was a host name)
+        int64_t         epoch{0}; //!< The request time in seconds since the UNIX epoch (UTC)
+        int64_t         responseSize{0}; //!< The size (in B) of the response sent back to the client w/o headers
+        uint16_t        statusCode{0}; //!< The status code returned to the client
+
+        string_view     virtualHost{}; //!< The virtual host (vhost_combined only, otherwise empty)
+        string_view     clientSource{}; //!< IP address or host name as logged
+        string_view     userId{}; //!< For password-protected files. Should not be trusted otherwise
+        string_view     httpRequestMethod{}; //!< e.g. GET
+        string_view     requestUri{}; //!< e.g.: /myawesomepage.php
+        string_view     httpVersion{}; //!< e.g. HTTP/1.1
+        string_view     referer{}; //!< The referer (combined formats only, otherwise empty)
+        string_view     userAgent{}; //!< The user agent (combined formats only, otherwise empty)
+    };
+
+    /**
+     * @brief Parses the textual form of an IPv4 or IPv6 address in to its binary form.
+     *
+     * @param source The address as logged by httpd.
+     * @param address The output address. IPv4 addresses are IPv4-mapped.
+     *
+     * @return true If source was a valid address.
+     * @return false Otherwise (address is zeroed)
+     */
+    inline bool parseClientAddress(string_view source, ClientAddress& address) {
+        address.fill(0);
+
+        // fast path for IPv4, which is the vast majority of all traffic
+        uint32_t octet = 0;
+        uint32_t octetIndex = 0;
+        uint32_t digits = 0;
+        bool isIpv4 = !source.empty();
+        for (const char c : source) {
+            if (c >= '0' && c <= '9') {
+                octet = octet * 10 + static_cast<uint32_t>(c - '0');
+                if (++digits > 3 || octet > 255) { isIpv4 = false; break; }
+            } else if (c == '.' && digits > 0 && octetIndex < 3) {
+                address[12 + octetIndex++] = static_cast<uint8_t>(octet);
+                octet = 0;
+                digits = 0;
+            } else {
+                isIpv4 = false;
+                break;
+            }
+        }
+
+        if (isIpv4 && octetIndex == 3 && digits > 0) {
+            address[10] = 0xff;
+            address[11] = 0xff;
+            address[15] = static_cast<uint8_t>(octet);
+            return true;
+        }
+
+        address.fill(0);
+        char buffer[INET6_ADDRSTRLEN] = {0};
+        if (source.empty() || source.size() >= sizeof(buffer) || source.find(':') == string_view::npos) {
+            return false;
+        }
+
+        std::memcpy(buffer, source.data(), source.size());
+        if (inet_pton(AF_INET6, buffer, address.data()) != 1) {
+            address.fill(0);
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Parses an httpd timestamp (%t) in to seconds since the UNIX epoch.
+     *
+     * @param timestamp The timestamp without brackets, e.g. 10/Oct/2000:13:55:36 -0700
+     * @param epoch The output value.
+     *
+     * @return true If the timestamp could be parsed.
+     * @return false Otherwise.
+     */
+    inline bool parseTimestamp(string_view timestamp, int64_t& epoch) {
+        // dd/Mon/yyyy:HH:MM:SS +zzzz
+        if (timestamp.size() < 26) { return false; }
+
+        const char* ts = timestamp.data();
+        const auto digit = [](char c) -> int32_t { return (c >= '0' && c <= '9') ? c - '0' : -1000; };
+        const auto twoDigits = [&](size_t offset) -> int32_t { return digit(ts[offset]) * 10 + digit(ts[offset + 1]); };
+
+        const int32_t day = twoDigits(0);
+        const int32_t year = twoDigits(7) * 100 + twoDigits(9);
+        const int32_t hour = twoDigits(12);
+        const int32_t minute = twoDigits(15);
+        const int32_t second = twoDigits(18);
+        const int32_t zoneHours = twoDigits(22);
+        const int32_t zoneMinutes = twoDigits(24);
+
+        int32_t month = 0;
+        switch (ts[3]) {
+            case 'J': month = ts[4] == 'a' ? 1 : (ts[5] == 'n' ? 6 : 7); break;
+            case 'F': month = 2; break;
+            case 'M': month = ts[5] == 'r' ? 3 : 5; break;
+            case 'A': month = ts[4] == 'p' ? 4 : 8; break;
+            case 'S': month = 9; break;
+            case 'O': month = 10; break;
+            case 'N': month = 11; break;
+            case 'D': month = 12; break;
+            default: return false;
+        }
+
+        if (
+            day < 1 || day > 31 || year < 0 || hour < 0 || hour > 23 || minute < 0 || minute > 59 ||
+            second < 0 || second > 60 || zoneHours < 0 || zoneMinutes < 0 || (ts[21] != '+' && ts[21] != '-')
+        ) {
+            return false;
+        }
+
+        // days from civil, see http://howardhinnant.github.io/date_algorithms.html
+        const int32_t y = year - (month <= 2);
+        const int32_t era = y / 400;
+        const int32_t yearOfEra = y - era * 400;
+        const int32_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        const int64_t days = static_cast<int64_t>(era) * 146097 + dayOfEra - 719468;
+
+        const int64_t zoneOffset = (zoneHours * 3600 + zoneMinutes * 60) * (ts[21] == '-' ? -1 : 1);
+        epoch = days * 86400 + hour * 3600 + minute * 60 + second - zoneOffset;
+
+        return true;
+    }
+
+    /**
+     * @brief Parses a single access log line in to a RequestRecord without allocating.
+     *
+     * @param line The log line (without the trailing newline).
+     * @param record The output record. Its views point in to line.
+     * @param fields The optional fields (RecordFields) to decode.
+     *
+     * @return true If the line was parsed successfully.
+     * @return false If the line is malformed.
+     *
+     * @remarks Supports the common, combined and vhost_combined formats:
+     *  "%h %l %u %t \"%r\" %>s %b"
+     *  "%h %l %u %t \"%r\" %>s %b \"%{Referer}i\" \"%{User-agent}i\""
+     *  "%v:%p %h %l %u %t \"%r\" %>s %O \"%{Referer}i\" \"%{User-Agent}i\""
+     */
+    inline bool parseRequestRecord(string_view line, RequestRecord& record, uint32_t fields = FIELD_ALL) {
+        const AllocationCounter::Scope allocationScope(AllocationTag::PARSER);
+        record = RequestRecord{};
+
+        while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) { line.remove_suffix(1); }
+
+        const auto bracketPos = line.find(" [");
+        if (bracketPos == string_view::npos) { return false; }
+
+        // up to four space-separated fields precede the timestamp
+        string_view prefixFields[5];
+        size_t fieldCount = 0;
+        {
+            size_t offset = 0;
+            while (offset < bracketPos && fieldCount < 5) {
+                auto next = line.find(' ', offset);
+                if (next == string_view::npos || next > bracketPos) { next = bracketPos; }
+                if (next > offset) { prefixFields[fieldCount++] = line.substr(offset, next - offset); }
+                offset = next + 1;
+            }
+        }
+
+        if (fieldCount == 4) {
+            record.virtualHost = prefixFields[0];
+            record.clientSource = prefixFields[1];
+            record.userId = prefixFields[3];
+        } else if (fieldCount == 3) {
+            record.clientSource = prefixFields[0];
+            record.userId = prefixFields[2];
+        } else {
+            return false;
+        }
+
+        size_t offset = bracketPos + 2;
+        const auto bracketEnd = line.find(']', offset);
+        if (bracketEnd == string_view::npos) { return false; }
+        if ((fields & FIELD_TIMESTAMP) && !parseTimestamp(line.substr(offset, bracketEnd - offset), record.epoch)) {
+            return false;
+        }
+
+        // finds the end of a quoted string, honouring httpd's backslash escapes
+        const auto findClosingQuote = [&](size_t from) -> size_t {
+            for (size_t i = from; i < line.size(); i++) {
+                if (line[i] == '\\') { i++; continue; }
+                if (line[i] == '"') { return i; }
+            }
+
+            return string_view::npos;
+        };
+
+        offset = line.find('"', bracketEnd + 1);
+        if (offset == string_view::npos) { return false; }
+        const auto requestEnd = findClosingQuote(++offset);
+        if (requestEnd == string_view::npos) { return false; }
+
+        {
+            // the request line (%r); method, URI and version, any of which might be missing in garbage requests
+            string_view* requestFields[] = { &record.httpRequestMethod, &record.requestUri, &record.httpVersion };
+            const auto request = line.substr(offset, requestEnd - offset);
+            size_t pos = 0;
+            for (auto* field : requestFields) {
+                while (pos < request.size() && request[pos] == ' ') { pos++; }
+                if (pos >= request.size()) { break; }
+                auto next = request.find(' ', pos);
+                if (field == requestFields[2] || next == string_view::npos) { next = request.size(); }
+                *field = request.substr(pos, next - pos);
+                pos = next;
+            }
+        }
+
+        // status code and response size
+        offset = requestEnd + 1;
+        while (offset < line.size() && line[offset] == ' ') { offset++; }
+        uint32_t statusCode = 0;
+        size_t statusDigits = 0;
+        while (offset < line.size() && line[offset] >= '0' && line[offset] <= '9') {
+            statusCode = statusCode * 10 + static_cast<uint32_t>(line[offset++] - '0');
+            statusDigits++;
+        }
+        if (statusDigits != 3) { return false; }
+        record.statusCode = static_cast<uint16_t>(statusCode);
+
+        while (offset < line.size() && line[offset] == ' ') { offset++; }
+        if (offset < line.size() && line[offset] == '-') {
+            offset++;
+        } else {
+            size_t sizeDigits = 0;
+            while (offset < line.size() && line[offset] >= '0' && line[offset] <= '9') {
+                record.responseSize = record.responseSize * 10 + (line[offset++] - '0');
+                sizeDigits++;
+            }
+            if (sizeDigits == 0) { return false; }
+        }
+
+        // combined formats carry the referer and user agent
+        for (auto* field : { &record.referer, &record.userAgent }) {
+            if (!(fields & FIELD_REFERER_AND_USER_AGENT)) { break; }
+
+            offset = line.find('"', offset);
+            if (offset == string_view::npos) { break; }
+            const auto end = findClosingQuote(++offset);
+            if (end == string_view::npos) { break; }
+            *field = line.substr(offset, end - offset);
+            offset = end + 1;
+        }
+
+        if (fields & FIELD_CLIENT_ADDRESS) { parseClientAddress(record.clientSource, record.clientAddress); }
+
+        return true;
+    }
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_ACCESSLOGPARSER_HPP
@@ -0,0 +1,358 @@
+/**
+ * @file AggregateSnapshot.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the writer and streaming reader for binary, key-ordered aggregate snapshots.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_AGGREGATESNAPSHOT_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_AGGREGATESNAPSHOT_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// libc
+#include <stdint.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AllocationCounter.hpp"
+#include "Probes.hpp"
+#include "RequestAggregator.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using std::ifstream;
+    using std::map;
+    using std::ofstream;
+    using std::string;
+    using std::string_view;
+    using std::vector;
+
+    /**
+     * @brief The sections of a snapshot, in the order they appear in the file.
+     *
+     * Every section is sorted by its key, so two snapshots can be compared (or merged) with a
+     * single sequential pass over both files.
+     */
+    enum class SnapshotSection : uint8_t {
+        CLIENTS     = 1, //!< Per-client statistics, sorted by client source
+        URIS        = 2, //!< Per-URI statistics, sorted by URI
+        STATUSES    = 3, //!< Total requests per status code, sorted by status code
+        TIME_SERIES = 4, //!< Per-minute statistics, sorted by time
+    };
+
+    struct SnapshotClient final {
+        string      source{};
+        ClientStats stats{};
+    };
+
+    struct SnapshotUri final {
+        string      uri{};
+        UriStats    stats{};
+    };
+
+    struct SnapshotStatus final {
+        uint16_t    statusCode{0};
+        uint64_t    requests{0};
+    };
+
+    struct SnapshotMinute final {
+        int64_t     minute{0};
+        TimeBucket  stats{};
+    };
+
+    /**
+     * @brief Header-only implementation of the snapshot writer.
+     */
+    class SnapshotWriter final {
+        public: // +++ Static +++
+            static constexpr char MAGIC[8] = { 'H', 'T', 'R', 'S', 'N', 'A', 'P', '1' }; //!< Identifies snapshot files (and their version)
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Writes all tables of an aggregator to a snapshot file.
+             *
+             * @return true If the snapshot was written successfully.
+             */
+            static bool write(const RequestAggregator& aggregator, const fs::path& path) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::EXPORT);
+                ofstream output;
+                vector<char> streamBuffer(1 << 20);
+                output.rdbuf()->pubsetbuf(streamBuffer.data(), static_cast<std::streamsize>(streamBuffer.size()));
+                output.open(path, std::ios::binary | std::ios::trunc);
+                if (!output.good()) { return false; }
+
+                output.write(MAGIC, sizeof(MAGIC));
+
+                map<uint16_t, uint64_t> statusTotals;
+
+                const auto clients = getSortedIds(aggregator.getClientCount(), [&](uint32_t id) { return aggregator.getClientName(id); });
+                writeSectionHeader(output, SnapshotSection::CLIENTS, clients.size());
+                for (const auto id : clients) {
+                    const auto& client = aggregator.getClient(id);
+                    writeString(output, aggregator.getClientName(id));
+                    output.write(reinterpret_cast<const char*>(client.address.data()), static_cast<std::streamsize>(client.address.size()));
+                    writeValue(output, client.requests);
+                    writeValue(output, client.bytes);
+                    writeValue(output, client.firstSeen);
+                    writeValue(output, client.lastSeen);
+                    writeValue(output, static_cast<uint16_t>(client.statusCounts.size()));
+                    for (const auto& status : client.statusCounts) {
+                        writeValue(output, status.first);
+                        writeValue(output, status.second);
+                        statusTotals[status.first] += status.second;
+                    }
+                }
+
+                const auto uris = getSortedIds(aggregator.getUriCount(), [&](uint32_t id) { return aggregator.getUri(id); });
+                writeSectionHeader(output, SnapshotSection::URIS, uris.size());
+                for (const auto id : uris) {
+                    writeString(output, aggregator.getUri(id));
+                    writeCounters(output, aggregator.getUriStats(id));
+                }
+
+                writeSectionHeader(output, SnapshotSection::STATUSES, statusTotals.size());
+                for (const auto& status : statusTotals) {
+                    writeValue(output, status.first);
+                    writeValue(output, status.second);
+                }
+
+                writeSectionHeader(output, SnapshotSection::TIME_SERIES, aggregator.getTimeSeries().size());
+                for (const auto& bucket : aggregator.getTimeSeries()) {
+                    writeValue(output, bucket.first);
+                    writeCounters(output, bucket.second);
+                }
+
+                output.close();
+                return !output.fail();
+            }
+
+        private: // +++ Private Business +++
+            template<typename GetKey>
+            static vector<uint32_t> getSortedIds(size_t count, GetKey&& getKey) {
+                vector<uint32_t> ids(count);
+                std::iota(ids.begin(), ids.end(), 0);
+                std::sort(ids.begin(), ids.end(), [&](uint32_t a, uint32_t b) { return getKey(a) < getKey(b); });
+
+                return ids;
+            }
+
+            template<typename T>
+            static void writeValue(ofstream& output, const T& value) { output.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+            static void writeString(ofstream& output, string_view str) {
+                writeValue(output, static_cast<uint32_t>(str.size()));
+                output.write(str.data(), static_cast<std::streamsize>(str.size()));
+            }
+
+            static void writeSectionHeader(ofstream& output, SnapshotSection section, uint64_t entries) {
+                writeValue(output, static_cast<uint8_t>(section));
+                writeValue(output, entries);
+            }
+
+            template<typename Counters>
+            static void writeCounters(ofstream& output, const Counters& counters) {
+                writeValue(output, counters.requests);
+                writeValue(output, counters.bytes);
+                for (const auto count : counters.statusClasses) { writeValue(output, count); }
+            }
+    };
+
+    /**
+     * @brief Header-only implementation of a streaming snapshot reader.
+     *
+     * Entries are read one at a time, so memory use doesn't depend on the snapshot's size.
+     * Sections must be read in the order they are declared in SnapshotSection.
+     */
+    class SnapshotReader final {
+        public: // +++ Constructor / Destructor +++
+            SnapshotReader() { m_input.rdbuf()->pubsetbuf(m_streamBuffer.data(), static_cast<std::streamsize>(m_streamBuffer.size())); }
+            SnapshotReader(const SnapshotReader&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Opens a snapshot and validates its header.
+             *
+             * @return true If the file is a snapshot this version can read.
+             */
+            bool open(const fs::path& path) {
+                m_input.open(path, std::ios::binary);
+                if (!m_input.good()) { return false; }
+
+                char magic[sizeof(SnapshotWriter::MAGIC)] = {0};
+                m_input.read(magic, sizeof(magic));
+
+                return m_input.good() && std::memcmp(magic, SnapshotWriter::MAGIC, sizeof(magic)) == 0;
+            }
+
+            /**
+             * @brief Starts reading the next section.
+             *
+             * @param expected The section which is expected next.
+             *
+             * @return true If the next section is the expected one.
+             */
+            bool beginSection(SnapshotSection expected) {
+                // skip whatever the caller didn't consume of the current section
+                while (m_remaining > 0) {
+                    switch (m_section) {
+                        case SnapshotSection::CLIENTS: { SnapshotClient entry; if (!next(entry)) { return false; } break; }
+                        case SnapshotSection::URIS: { SnapshotUri entry; if (!next(entry)) { return false; } break; }
+                        case SnapshotSection::STATUSES: { SnapshotStatus entry; if (!next(entry)) { return false; } break; }
+                        case SnapshotSection::TIME_SERIES: { SnapshotMinute entry; if (!next(entry)) { return false; } break; }
+                    }
+                }
+
+                uint8_t section = 0;
+                readValue(section);
+                readValue(m_remaining);
+                m_section = static_cast<SnapshotSection>(section);
+
+                return m_input.good() && m_section == expected;
+            }
+
+            uint64_t getRemaining() const { return m_remaining; } //!< Gets the number of unread entries in the current section
+
+            /**
+             * @brief Reads the next client of the CLIENTS section.
+             *
+             * @return true If an entry was read; false at the end of the section or on error.
+             */
+            bool next(SnapshotClient& entry) {
+                if (!take(SnapshotSection::CLIENTS)) { return false; }
+
+                readString(entry.source);
+                m_input.read(reinterpret_cast<char*>(entry.stats.address.data()), static_cast<std::streamsize>(entry.stats.address.size()));
+                readValue(entry.stats.requests);
+                readValue(entry.stats.bytes);
+                readValue(entry.stats.firstSeen);
+                readValue(entry.stats.lastSeen);
+
+                uint16_t statusCount = 0;
+                readValue(statusCount);
+                entry.stats.statusCounts.resize(statusCount);
+                for (auto& status : entry.stats.statusCounts) {
+                    readValue(status.first);
+                    readValue(status.second);
+                }
+
+                return m_input.good();
+            }
+
+            bool next(SnapshotUri& entry) { //!< Reads the next URI of the URIS section
+                if (!take(SnapshotSection::URIS)) { return false; }
+
+                readString(entry.uri);
+                readCounters(entry.stats);
+
+                return m_input.good();
+            }
+
+            bool next(SnapshotStatus& entry) { //!< Reads the next status code of the STATUSES section
+                if (!take(SnapshotSection::STATUSES)) { return false; }
+
+                readValue(entry.statusCode);
+                readValue(entry.requests);
+
+                return m_input.good();
+            }
+
+            bool next(SnapshotMinute& entry) { //!< Reads the next minute of the TIME_SERIES section
+                if (!take(SnapshotSection::TIME_SERIES)) { return false; }
+
+                readValue(entry.minute);
+                readCounters(entry.stats);
+
+                return m_input.good();
+            }
+
+            bool good() const { return m_input.good(); } //!< Gets a value indicating whether or not all reads succeeded so far
+
+        private: // +++ Private Business +++
+            bool take(SnapshotSection section) {
+                if (m_section != section || m_remaining == 0 || !m_input.good()) { return false; }
+
+                m_remaining--;
+                return true;
+            }
+
+            template<typename T>
+            void readValue(T& value) { m_input.read(reinterpret_cast<char*>(&value), sizeof(T)); }
+
+            void readString(string& str) {
+                uint32_t length = 0;
+                readValue(length);
+                str.resize(length);
+                m_input.read(str.data(), length);
+            }
+
+            template<typename Counters>
+            void readCounters(Counters& counters) {
+                readValue(counters.requests);
+                readValue(counters.bytes);
+                for (auto& count : counters.statusClasses) { readValue(count); }
+            }
+
+        private:
+            uint64_t        m_remaining{0};
+
+            SnapshotSection m_section{SnapshotSection::CLIENTS};
+
+            vector<char>    m_streamBuffer = vector<char>(1 << 20);
+            ifstream        m_input{};
+    };
+
+    /**
+     * @brief Merges all tables of a snapshot in to an aggregator, e.g. to combine the snapshots of several machines.
+     *
+     * @return true If the whole snapshot was read; otherwise the aggregator may hold part of it.
+     */
+    inline bool mergeSnapshot(const fs::path& path, RequestAggregator& aggregator) {
+        SnapshotReader reader;
+        if (!reader.open(path) || !reader.beginSection(SnapshotSection::CLIENTS)) { return false; }
+        HTTPDREPORT_PROBE2(merge_start, aggregator.getTotalRequests(), aggregator.getClientCount());
+
+        // every request is counted by exactly one client
+        uint64_t requests = 0;
+        SnapshotClient client;
+        while (reader.next(client)) {
+            aggregator.mergeClient(client.source, client.stats);
+            requests += client.stats.requests;
+        }
+        aggregator.mergeRequestCount(requests);
+
+        if (!reader.beginSection(SnapshotSection::URIS)) { return false; }
+        SnapshotUri uri;
+        while (reader.next(uri)) { aggregator.mergeUri(uri.uri, uri.stats); }
+
+        // the status totals are derived from the clients
+        if (!reader.beginSection(SnapshotSection::STATUSES) || !reader.beginSection(SnapshotSection::TIME_SERIES)) { return false; }
+        SnapshotMinute minute;
+        while (reader.next(minute)) { aggregator.mergeTimeBucket(minute.minute, minute.stats); }
+        HTTPDREPORT_PROBE2(merge_end, aggregator.getTotalRequests(), aggregator.getClientCount());
+
+        return reader.good() && reader.getRemaining() == 0;
+    }
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_AGGREGATESNAPSHOT_HPP
@@ -0,0 +1,126 @@
+/**
+ * @file AllocationCounter.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the process-wide counters fed by the replaced operator new and delete, broken down by subsystem.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_ALLOCATIONCOUNTER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_ALLOCATIONCOUNTER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// libc
+#include <stdint.h>
+
+namespace httpdreport {
+
+    using std::array;
+    using std::atomic;
+
+    /**
+     * @brief The subsystems allocations are booked to; see AllocationCounter::Scope.
+     */
+    enum class AllocationTag: uint8_t {
+        OTHER, //!< Anything outside of a tagged scope
+        READER, //!< Read buffers and decompression
+        PARSER, //!< Decoding lines in to records
+        INTERNER, //!< The arenas and indexes of interned strings
+        TABLES, //!< The aggregate tables and their time series
+        RENDER, //!< Rendering reports and compressing their output
+        EXPORT, //!< Arrow, SQLite and snapshot files
+        TAG_COUNT
+    };
+
+    static constexpr size_t ALLOCATION_TAG_COUNT = static_cast<size_t>(AllocationTag::TAG_COUNT);
+
+    /**
+     * @brief Counts the allocations made through operator new, once enabled.
+     *
+     * The operators are replaced in AllocationHooks.cpp. Until enable() is called they only test a flag, so a run without
+     * statistics pays a predictable branch per allocation and nothing else.
+     *
+     * Every allocation is also booked to the subsystem tag of the allocating thread, which the subsystems set on entry with a
+     * Scope; nested scopes win, so interning strings while aggregating books the strings to INTERNER.
+     */
+    class AllocationCounter final {
+        public: // +++ Static +++
+            /**
+             * @brief Books the calling thread's allocations to a tag until destroyed. Costs two thread-local stores.
+             */
+            class Scope final {
+                public:
+                    explicit Scope(AllocationTag tag): m_previous(s_currentTag) { s_currentTag = tag; }
+                    Scope(const Scope&) = delete;
+                    ~Scope() { s_currentTag = m_previous; }
+
+                private:
+                    AllocationTag   m_previous{AllocationTag::OTHER};
+            };
+
+            /**
+             * @brief Gets the names of the tags, as used in both the text and the JSON statistics.
+             */
+            static const char* getTagName(AllocationTag tag) {
+                static constexpr const char* NAMES[] = { "other", "reader", "parser", "interner", "tables", "render", "export" };
+                return NAMES[static_cast<size_t>(tag)];
+            }
+
+            static void enable() { s_enabled.store(true, std::memory_order_relaxed); } //!< Starts counting
+            static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); } //!< Gets a value indicating whether or not allocations are counted
+
+            static uint64_t getAllocations() { return s_allocations.load(std::memory_order_relaxed); } //!< Gets the number of allocations counted
+            static uint64_t getAllocatedBytes() { return s_allocatedBytes.load(std::memory_order_relaxed); } //!< Gets the bytes requested by them
+            static uint64_t getDeallocations() { return s_deallocations.load(std::memory_order_relaxed); } //!< Gets the number of deallocations counted
+
+            static uint64_t getAllocations(AllocationTag tag) { return s_tagAllocations[static_cast<size_t>(tag)].load(std::memory_order_relaxed); } //!< Gets the number of allocations booked to a tag
+            static uint64_t getAllocatedBytes(AllocationTag tag) { return s_tagBytes[static_cast<size_t>(tag)].load(std::memory_order_relaxed); } //!< Gets the bytes requested by them
+
+            /**
+             * @brief Called by operator new for every allocation.
+             */
+            static void recordAllocation(size_t size) {
+                if (!isEnabled()) { return; }
+
+                s_allocations.fetch_add(1, std::memory_order_relaxed);
+                s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+                const auto tag = static_cast<size_t>(s_currentTag);
+                s_tagAllocations[tag].fetch_add(1, std::memory_order_relaxed);
+                s_tagBytes[tag].fetch_add(size, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Called by operator delete for every non-null pointer.
+             */
+            static void recordDeallocation() {
+                if (!isEnabled()) { return; }
+
+                s_deallocations.fetch_add(1, std::memory_order_relaxed);
+            }
+
+        private:
+            static inline atomic<bool>      s_enabled{false};
+            static inline atomic<uint64_t>  s_allocations{0};
+            static inline atomic<uint64_t>  s_allocatedBytes{0};
+            static inline atomic<uint64_t>  s_deallocations{0};
+
+            static inline array<atomic<uint64_t>, ALLOCATION_TAG_COUNT> s_tagAllocations{};
+            static inline array<atomic<uint64_t>, ALLOCATION_TAG_COUNT> s_tagBytes{};
+
+            static inline thread_local AllocationTag    s_currentTag{AllocationTag::OTHER};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_ALLOCATIONCOUNTER_HPP
@@ -16,6 +16,7 @@
 /////////////////////
 
 // stl
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -37,8 +38,17 @@ namespace httpdreport {
 
         bool            FollowSymlinks{false}; //!< Whether or not to follow symlinks
         bool            ReadFromStdin{false}; //!< Whether or not to read from stdin.
+        bool            ReadFromPipe{false}; //!< Whether or not to run as httpd's piped logger
         bool            ReadGzippedFiles{false}; //!< Whether or not to read files compressed with gzip
         bool            RecurseDirectories{false}; //!< Whether or not to recurse through subdirectors in LogDirectory
+        bool            SqliteIncludeRequests{false}; //!< Whether or not raw requests are written to the SQLite database
+        bool            HardwareCounters{false}; //!< Whether or not --stats includes hardware performance counters
+
+        size_t          TopCount{20}; //!< The number of rows shown in rankings
+        size_t          DumpIntervalSeconds{60}; //!< How often the piped logger rewrites its output files
+        size_t          SyslogThreads{4}; //!< The number of sockets/threads receiving syslog datagrams
+
+        uint16_t        MetricsPort{0}; //!< If not 0, live metrics are served on this port (loopback only)
 
         string          AccessFileGlob{"*.access.log*"}; //!< The glob used to search access logs
         string          ErrorFileGlob{"*.error.log*"}; //!< The glob used to search error logs
@@ -46,8 +56,23 @@ namespace httpdreport {
         string          LogDirectory{resources::DEFAULT_LOG_PATH}; //!< The directory in which to search for logs
 
         string          OutputFile{}; //!< The output file destination (or empty or output is stdout)
+        string          ArrowOutputFile{}; //!< If set, parsed requests are exported to this Arrow IPC file
+        string          SqliteOutputFile{}; //!< If set, the aggregate tables are written to this SQLite database
+        string          ReportConfigFile{}; //!< If set, the reports defined in this file are rendered instead of the default report
+        string          SnapshotFile{}; //!< If set, a binary snapshot of the aggregate tables is written to this file
+        string          DaemonSocketFile{}; //!< If set, the logs are followed and queries are answered on this Unix domain socket
+        string          MetricsFile{}; //!< If set, live metrics are periodically written to this file (node_exporter textfile format)
+        string          SharedSnapshotName{}; //!< If set, headline figures are published in this POSIX shared memory segment
+        string          SharedSnapshotDumpName{}; //!< If set, the figures published in this segment are printed
+        string          StateFile{}; //!< If set, the daemon checkpoints its tables and log positions to this file and restores them on start
+        string          SyslogListenAddress{}; //!< If set ([address:]port), access log lines are received via syslog over UDP
+        string          CoordinatorListenAddress{}; //!< If set ([address:]port), the files are distributed to workers connecting here
+        string          WorkerCoordinatorAddress{}; //!< If set (host:port), this instance reads the files a coordinator assigns
+        string          StatsFormat{}; //!< If set (text or json), per-stage timings are printed to stderr after a run
+        string          TraceFile{}; //!< If set, a timeline of the run is written to this file (Chrome trace event format)
 
         vector<string>  InputFiles{}; //!< Arbitray input files passed via command line
+        vector<string>  DiffSnapshotFiles{}; //!< The old and new snapshot to compare (--diff)
 
     };
 
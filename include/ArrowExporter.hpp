@@ -0,0 +1,538 @@
+/**
+ * @file ArrowExporter.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains a dependency-free writer for parsed requests in the Apache Arrow IPC file format.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_ARROWEXPORTER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_ARROWEXPORTER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// libc
+#include <stdint.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "AllocationCounter.hpp"
+#include "StringInterner.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using std::ofstream;
+    using std::pair;
+    using std::string;
+    using std::string_view;
+    using std::vector;
+
+    /**
+     * @brief Minimal back-to-front FlatBuffers builder; just enough to encode Arrow's IPC metadata.
+     *
+     * Offsets are counted from the end of the buffer, exactly like the reference implementation.
+     * Metadata messages are tiny, so prepending in to a vector is cheap enough.
+     */
+    class FlatBufferBuilder final {
+        public: // +++ Typedefs +++
+            using Offset = uint32_t;
+
+        public: // +++ Business Logic +++
+            Offset size() const { return static_cast<Offset>(m_buffer.size()); }
+
+            template<typename T>
+            void prepend(T value) {
+                align(sizeof(T), 0);
+                prependBytes(&value, sizeof(T));
+            }
+
+            void prependOffset(Offset offset) {
+                align(sizeof(Offset), 0);
+                const Offset relative = size() + sizeof(Offset) - offset;
+                prependBytes(&relative, sizeof(relative));
+            }
+
+            Offset createString(string_view str) {
+                align(sizeof(Offset), str.size() + 1);
+                m_buffer.insert(m_buffer.begin(), 1, 0);
+                prependBytes(str.data(), str.size());
+                prepend(static_cast<uint32_t>(str.size()));
+
+                return size();
+            }
+
+            Offset createOffsetVector(const vector<Offset>& offsets) {
+                align(sizeof(Offset), offsets.size() * sizeof(Offset));
+                for (auto it = offsets.rbegin(); it != offsets.rend(); it++) { prependOffset(*it); }
+                prepend(static_cast<uint32_t>(offsets.size()));
+
+                return size();
+            }
+
+            Offset createStructVector(const void* data, size_t structSize, size_t count, size_t alignment) {
+                align(sizeof(Offset), structSize * count);
+                align(alignment, structSize * count);
+                prependBytes(data, structSize * count);
+                prepend(static_cast<uint32_t>(count));
+
+                return size();
+            }
+
+            void startTable() {
+                m_fields.clear();
+                m_tableStart = size();
+            }
+
+            template<typename T>
+            void addScalar(uint16_t slot, T value) {
+                prepend(value);
+                m_fields.emplace_back(slot, size());
+            }
+
+            void addOffset(uint16_t slot, Offset offset) {
+                prependOffset(offset);
+                m_fields.emplace_back(slot, size());
+            }
+
+            Offset endTable() {
+                prepend<int32_t>(0); // vtable offset, patched below
+                const auto tableOffset = size();
+
+                uint16_t slotCount = 0;
+                for (const auto& field : m_fields) { slotCount = std::max<uint16_t>(slotCount, field.first + 1); }
+
+                vector<uint16_t> vtable(slotCount + 2, 0);
+                vtable[0] = static_cast<uint16_t>(vtable.size() * sizeof(uint16_t));
+                vtable[1] = static_cast<uint16_t>(tableOffset - m_tableStart);
+                for (const auto& field : m_fields) { vtable[2 + field.first] = static_cast<uint16_t>(tableOffset - field.second); }
+
+                prependBytes(vtable.data(), vtable.size() * sizeof(uint16_t));
+                const int32_t vtableDistance = static_cast<int32_t>(size()) - static_cast<int32_t>(tableOffset);
+                std::memcpy(m_buffer.data() + size() - tableOffset, &vtableDistance, sizeof(vtableDistance));
+
+                m_fields.clear();
+                return tableOffset;
+            }
+
+            const vector<uint8_t>& finish(Offset root) {
+                align(m_minAlign, sizeof(Offset));
+                prependOffset(root);
+
+                return m_buffer;
+            }
+
+        private: // +++ Private Business +++
+            void align(size_t alignment, size_t additionalBytes) {
+                m_minAlign = std::max(m_minAlign, alignment);
+                const auto padding = (~(m_buffer.size() + additionalBytes) + 1) & (alignment - 1);
+                m_buffer.insert(m_buffer.begin(), padding, 0);
+            }
+
+            void prependBytes(const void* data, size_t length) {
+                const auto* bytes = static_cast<const uint8_t*>(data);
+                m_buffer.insert(m_buffer.begin(), bytes, bytes + length);
+            }
+
+        private:
+            size_t                          m_minAlign{1};
+            Offset                          m_tableStart{0};
+
+            vector<pair<uint16_t, Offset>>  m_fields{};
+            vector<uint8_t>                 m_buffer{};
+    };
+
+    /**
+     * @brief Header-only implementation of an exporter writing parsed requests as Arrow IPC record batches.
+     *
+     * Columns are appended to directly from each parsed record, so no per-row objects are created.
+     * Low-cardinality and repetitive strings (vhost, method, URI, version, referer, user agent) are
+     * dictionary-encoded; new dictionary entries are written as delta dictionary batches ahead of
+     * every record batch. The output is an Arrow IPC file (a.k.a. Feather v2), which can be read by
+     * pyarrow, pandas (read_feather) and DuckDB.
+     */
+    class ArrowExporter final {
+        public: // +++ Static +++
+            static constexpr size_t DEFAULT_BATCH_SIZE = 1 << 16; //!< The default number of rows per record batch
+
+        public: // +++ Constructor / Destructor +++
+            explicit ArrowExporter(size_t batchSize = DEFAULT_BATCH_SIZE): m_batchSize(batchSize) { reserveColumns(); }
+            ArrowExporter(const ArrowExporter&) = delete;
+            ~ArrowExporter() { close(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Opens the output file and writes the schema.
+             *
+             * @return true If the file could be opened.
+             */
+            bool open(const fs::path& path) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::EXPORT);
+                m_output.open(path, std::ios::binary | std::ios::trunc);
+                if (!m_output.good()) { return false; }
+
+                static const char FILE_MAGIC[8] = { 'A', 'R', 'R', 'O', 'W', '1', 0, 0 };
+                m_output.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+                m_position = sizeof(FILE_MAGIC);
+                writeMessage(MESSAGE_HEADER_SCHEMA, [this](FlatBufferBuilder& builder) { return buildSchema(builder); }, {});
+
+                return m_output.good();
+            }
+
+            /**
+             * @brief Appends a parsed request to the current record batch, flushing it when full.
+             */
+            void append(const RequestRecord& record) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::EXPORT);
+                m_dictionaryIndices[DICT_VHOST].push_back(m_dictionaries[DICT_VHOST].intern(record.virtualHost));
+                m_clientAddresses.insert(m_clientAddresses.end(), record.clientAddress.begin(), record.clientAddress.end());
+                m_timestamps.push_back(record.epoch);
+                m_dictionaryIndices[DICT_METHOD].push_back(m_dictionaries[DICT_METHOD].intern(record.httpRequestMethod));
+                m_dictionaryIndices[DICT_URI].push_back(m_dictionaries[DICT_URI].intern(record.requestUri));
+                m_dictionaryIndices[DICT_VERSION].push_back(m_dictionaries[DICT_VERSION].intern(record.httpVersion));
+                m_statusCodes.push_back(record.statusCode);
+                m_responseSizes.push_back(record.responseSize);
+                m_dictionaryIndices[DICT_REFERER].push_back(m_dictionaries[DICT_REFERER].intern(record.referer));
+                m_dictionaryIndices[DICT_USER_AGENT].push_back(m_dictionaries[DICT_USER_AGENT].intern(record.userAgent));
+
+                if (++m_rowCount >= m_batchSize) { flush(); }
+            }
+
+            /**
+             * @brief Writes any pending rows, the file footer and closes the file.
+             *
+             * @return true If everything was written successfully.
+             */
+            bool close() {
+                const AllocationCounter::Scope allocationScope(AllocationTag::EXPORT);
+                if (!m_output.is_open()) { return true; }
+
+                flush();
+
+                // end-of-stream marker, followed by the footer
+                const uint32_t endOfStream[2] = { CONTINUATION_MARKER, 0 };
+                write(endOfStream, sizeof(endOfStream));
+
+                FlatBufferBuilder builder;
+                const auto schema = buildSchema(builder);
+                const auto dictionaryBlocks = builder.createStructVector(m_dictionaryBlocks.data(), sizeof(Block), m_dictionaryBlocks.size(), 8);
+                const auto batchBlocks = builder.createStructVector(m_recordBatchBlocks.data(), sizeof(Block), m_recordBatchBlocks.size(), 8);
+                builder.startTable();
+                builder.addOffset(3, batchBlocks);
+                builder.addOffset(2, dictionaryBlocks);
+                builder.addOffset(1, schema);
+                builder.addScalar<int16_t>(0, METADATA_VERSION_V5);
+                const auto& footer = builder.finish(builder.endTable());
+
+                write(footer.data(), footer.size());
+                const auto footerSize = static_cast<int32_t>(footer.size());
+                write(&footerSize, sizeof(footerSize));
+                write("ARROW1", 6);
+
+                m_output.close();
+                return !m_output.fail();
+            }
+
+            size_t rowsWritten() const { return m_totalRows; } //!< Gets the number of rows flushed to disk so far
+
+        private: // +++ Arrow Metadata +++
+            static constexpr uint32_t CONTINUATION_MARKER = 0xffffffff;
+            static constexpr int16_t METADATA_VERSION_V5 = 4;
+
+            static constexpr uint8_t MESSAGE_HEADER_SCHEMA = 1;
+            static constexpr uint8_t MESSAGE_HEADER_DICTIONARY_BATCH = 2;
+            static constexpr uint8_t MESSAGE_HEADER_RECORD_BATCH = 3;
+
+            static constexpr uint8_t TYPE_INT = 2;
+            static constexpr uint8_t TYPE_UTF8 = 5;
+            static constexpr uint8_t TYPE_TIMESTAMP = 10;
+            static constexpr uint8_t TYPE_FIXED_SIZE_BINARY = 15;
+
+            enum DictionaryColumn { DICT_VHOST = 0, DICT_METHOD, DICT_URI, DICT_VERSION, DICT_REFERER, DICT_USER_AGENT, DICT_COUNT };
+
+            enum ColumnKind { KIND_DICTIONARY, KIND_FIXED_BINARY, KIND_TIMESTAMP, KIND_UINT16, KIND_INT64 };
+
+            struct ColumnSpec {
+                const char* name;
+                ColumnKind  kind;
+                int32_t     dictionary; //!< The DictionaryColumn, or -1
+            };
+
+            static constexpr ColumnSpec COLUMNS[] = {
+                { "vhost",          KIND_DICTIONARY,    DICT_VHOST },
+                { "client",         KIND_FIXED_BINARY,  -1 },
+                { "timestamp",      KIND_TIMESTAMP,     -1 },
+                { "method",         KIND_DICTIONARY,    DICT_METHOD },
+                { "uri",            KIND_DICTIONARY,    DICT_URI },
+                { "http_version",   KIND_DICTIONARY,    DICT_VERSION },
+                { "status",         KIND_UINT16,        -1 },
+                { "response_size",  KIND_INT64,         -1 },
+                { "referer",        KIND_DICTIONARY,    DICT_REFERER },
+                { "user_agent",     KIND_DICTIONARY,    DICT_USER_AGENT },
+            };
+
+            struct FieldNode { int64_t length; int64_t nullCount; };
+            struct Buffer { int64_t offset; int64_t length; };
+            struct Block { int64_t offset; int32_t metaDataLength; int32_t padding; int64_t bodyLength; };
+
+            static FlatBufferBuilder::Offset buildIntType(FlatBufferBuilder& builder, int32_t bitWidth, bool isSigned) {
+                builder.startTable();
+                builder.addScalar<int32_t>(0, bitWidth);
+                builder.addScalar<uint8_t>(1, isSigned);
+                return builder.endTable();
+            }
+
+            static FlatBufferBuilder::Offset buildSchema(FlatBufferBuilder& builder) {
+                vector<FlatBufferBuilder::Offset> fields;
+
+                for (const auto& column : COLUMNS) {
+                    const auto name = builder.createString(column.name);
+                    const auto children = builder.createOffsetVector({});
+
+                    uint8_t typeType = 0;
+                    FlatBufferBuilder::Offset type = 0;
+                    FlatBufferBuilder::Offset dictionary = 0;
+                    switch (column.kind) {
+                        case KIND_DICTIONARY: {
+                            typeType = TYPE_UTF8;
+                            builder.startTable();
+                            type = builder.endTable();
+                            const auto indexType = buildIntType(builder, 32, true);
+                            builder.startTable();
+                            builder.addScalar<int64_t>(0, column.dictionary);
+                            builder.addOffset(1, indexType);
+                            dictionary = builder.endTable();
+                            break;
+                        }
+                        case KIND_FIXED_BINARY:
+                            typeType = TYPE_FIXED_SIZE_BINARY;
+                            builder.startTable();
+                            builder.addScalar<int32_t>(0, static_cast<int32_t>(sizeof(ClientAddress)));
+                            type = builder.endTable();
+                            break;
+                        case KIND_TIMESTAMP: {
+                            typeType = TYPE_TIMESTAMP;
+                            const auto timeZone = builder.createString("UTC");
+                            builder.startTable();
+                            builder.addOffset(1, timeZone);
+                            builder.addScalar<int16_t>(0, 0); // TimeUnit::SECOND
+                            type = builder.endTable();
+                            break;
+                        }
+                        case KIND_UINT16:
+                            typeType = TYPE_INT;
+                            type = buildIntType(builder, 16, false);
+                            break;
+                        case KIND_INT64:
+                            typeType = TYPE_INT;
+                            type = buildIntType(builder, 64, true);
+                            break;
+                    }
+
+                    builder.startTable();
+                    builder.addOffset(0, name);
+                    builder.addOffset(3, type);
+                    if (dictionary != 0) { builder.addOffset(4, dictionary); }
+                    builder.addOffset(5, children);
+                    builder.addScalar<uint8_t>(2, typeType);
+                    builder.addScalar<uint8_t>(1, false); // nullable
+                    fields.push_back(builder.endTable());
+                }
+
+                const auto fieldVector = builder.createOffsetVector(fields);
+                builder.startTable();
+                builder.addOffset(1, fieldVector);
+                builder.addScalar<int16_t>(0, 0); // little endian
+                return builder.endTable();
+            }
+
+            static FlatBufferBuilder::Offset buildRecordBatch(FlatBufferBuilder& builder, int64_t length, const vector<FieldNode>& nodes, const vector<Buffer>& buffers) {
+                const auto bufferVector = builder.createStructVector(buffers.data(), sizeof(Buffer), buffers.size(), 8);
+                const auto nodeVector = builder.createStructVector(nodes.data(), sizeof(FieldNode), nodes.size(), 8);
+                builder.startTable();
+                builder.addScalar<int64_t>(0, length);
+                builder.addOffset(2, bufferVector);
+                builder.addOffset(1, nodeVector);
+                return builder.endTable();
+            }
+
+        private: // +++ Private Business +++
+            /**
+             * @brief Collects the body of a message, keeping every buffer 8-byte aligned.
+             */
+            struct MessageBody {
+                vector<pair<const void*, size_t>>   chunks{};
+                vector<Buffer>                      buffers{};
+                vector<FieldNode>                   nodes{};
+                int64_t                             length{0};
+
+                void addBuffer(const void* data, size_t size) {
+                    buffers.push_back({ length, static_cast<int64_t>(size) });
+                    chunks.emplace_back(data, size);
+                    length += static_cast<int64_t>((size + 7) & ~size_t(7));
+                }
+            };
+
+            void reserveColumns() {
+                m_clientAddresses.reserve(m_batchSize * sizeof(ClientAddress));
+                m_timestamps.reserve(m_batchSize);
+                m_statusCodes.reserve(m_batchSize);
+                m_responseSizes.reserve(m_batchSize);
+                for (auto& indices : m_dictionaryIndices) { indices.reserve(m_batchSize); }
+            }
+
+            void write(const void* data, size_t size) {
+                m_output.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                m_position += size;
+            }
+
+            template<typename BuildHeader>
+            Block writeMessage(uint8_t headerType, BuildHeader&& buildHeader, const MessageBody& body) {
+                FlatBufferBuilder builder;
+                const auto header = buildHeader(builder);
+                builder.startTable();
+                builder.addScalar<int64_t>(3, body.length);
+                builder.addOffset(2, header);
+                builder.addScalar<int16_t>(0, METADATA_VERSION_V5);
+                builder.addScalar<uint8_t>(1, headerType);
+                const auto& metadata = builder.finish(builder.endTable());
+
+                static const char PADDING[8] = {0};
+                const auto paddedSize = static_cast<int32_t>((metadata.size() + 8 + 7) & ~size_t(7)) - 8;
+                const Block block{ static_cast<int64_t>(m_position), paddedSize + 8, 0, body.length };
+
+                const uint32_t prefix[2] = { CONTINUATION_MARKER, static_cast<uint32_t>(paddedSize) };
+                write(prefix, sizeof(prefix));
+                write(metadata.data(), metadata.size());
+                write(PADDING, paddedSize - metadata.size());
+
+                for (const auto& chunk : body.chunks) {
+                    write(chunk.first, chunk.second);
+                    write(PADDING, ((chunk.second + 7) & ~size_t(7)) - chunk.second);
+                }
+
+                return block;
+            }
+
+            void writeDictionaryDeltas() {
+                for (int32_t dictionary = 0; dictionary < DICT_COUNT; dictionary++) {
+                    const auto& strings = m_dictionaries[dictionary].strings();
+                    const auto firstNew = m_dictionaryFlushed[dictionary];
+                    if (firstNew == strings.size()) { continue; }
+
+                    // offsets in to a contiguous value buffer, as required by the Utf8 layout
+                    m_dictionaryOffsets.clear();
+                    m_dictionaryValues.clear();
+                    m_dictionaryOffsets.push_back(0);
+                    for (size_t i = firstNew; i < strings.size(); i++) {
+                        m_dictionaryValues.append(strings[i]);
+                        m_dictionaryOffsets.push_back(static_cast<int32_t>(m_dictionaryValues.size()));
+                    }
+
+                    const auto newEntries = static_cast<int64_t>(strings.size() - firstNew);
+                    MessageBody body;
+                    body.nodes.push_back({ newEntries, 0 });
+                    body.addBuffer(nullptr, 0); // validity; no nulls
+                    body.addBuffer(m_dictionaryOffsets.data(), m_dictionaryOffsets.size() * sizeof(int32_t));
+                    body.addBuffer(m_dictionaryValues.data(), m_dictionaryValues.size());
+
+                    const bool isDelta = firstNew > 0;
+                    m_dictionaryBlocks.push_back(writeMessage(MESSAGE_HEADER_DICTIONARY_BATCH, [&](FlatBufferBuilder& builder) {
+                        const auto recordBatch = buildRecordBatch(builder, newEntries, body.nodes, body.buffers);
+                        builder.startTable();
+                        builder.addScalar<int64_t>(0, dictionary);
+                        builder.addOffset(1, recordBatch);
+                        builder.addScalar<uint8_t>(2, isDelta);
+                        return builder.endTable();
+                    }, body));
+
+                    m_dictionaryFlushed[dictionary] = strings.size();
+                }
+            }
+
+            void flush() {
+                if (m_rowCount == 0 || !m_output.is_open()) { return; }
+
+                writeDictionaryDeltas();
+
+                const auto rows = static_cast<int64_t>(m_rowCount);
+                MessageBody body;
+                for (const auto& column : COLUMNS) {
+                    body.nodes.push_back({ rows, 0 });
+                    body.addBuffer(nullptr, 0); // validity; no nulls
+
+                    switch (column.kind) {
+                        case KIND_DICTIONARY:
+                            body.addBuffer(m_dictionaryIndices[column.dictionary].data(), m_rowCount * sizeof(int32_t));
+                            break;
+                        case KIND_FIXED_BINARY:
+                            body.addBuffer(m_clientAddresses.data(), m_clientAddresses.size());
+                            break;
+                        case KIND_TIMESTAMP:
+                            body.addBuffer(m_timestamps.data(), m_rowCount * sizeof(int64_t));
+                            break;
+                        case KIND_UINT16:
+                            body.addBuffer(m_statusCodes.data(), m_rowCount * sizeof(uint16_t));
+                            break;
+                        case KIND_INT64:
+                            body.addBuffer(m_responseSizes.data(), m_rowCount * sizeof(int64_t));
+                            break;
+                    }
+                }
+
+                m_recordBatchBlocks.push_back(writeMessage(MESSAGE_HEADER_RECORD_BATCH, [&](FlatBufferBuilder& builder) {
+                    return buildRecordBatch(builder, rows, body.nodes, body.buffers);
+                }, body));
+
+                m_totalRows += m_rowCount;
+                m_rowCount = 0;
+                m_clientAddresses.clear();
+                m_timestamps.clear();
+                m_statusCodes.clear();
+                m_responseSizes.clear();
+                for (auto& indices : m_dictionaryIndices) { indices.clear(); }
+            }
+
+        private:
+            size_t              m_batchSize{DEFAULT_BATCH_SIZE};
+            size_t              m_position{0};
+            size_t              m_rowCount{0};
+            size_t              m_totalRows{0};
+
+            ofstream            m_output{};
+
+            StringInterner      m_dictionaries[DICT_COUNT]{};
+            size_t              m_dictionaryFlushed[DICT_COUNT]{};
+            vector<int32_t>     m_dictionaryIndices[DICT_COUNT]{};
+            vector<int32_t>     m_dictionaryOffsets{};
+            string              m_dictionaryValues{};
+
+            vector<uint8_t>     m_clientAddresses{};
+            vector<int64_t>     m_timestamps{};
+            vector<uint16_t>    m_statusCodes{};
+            vector<int64_t>     m_responseSizes{};
+
+            vector<Block>       m_dictionaryBlocks{};
+            vector<Block>       m_recordBatchBlocks{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_ARROWEXPORTER_HPP
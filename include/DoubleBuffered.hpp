@@ -0,0 +1,97 @@
+/**
+ * @file DoubleBuffered.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains a two-instance (left/right) container letting readers see consistent state while a single writer keeps updating.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_DOUBLEBUFFERED_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_DOUBLEBUFFERED_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <atomic>
+#include <utility>
+
+// libc
+#include <stdint.h>
+
+namespace httpdreport {
+
+    using std::atomic;
+
+    /**
+     * @brief Keeps two instances of T: readers use the published one, the (single) writer updates the standby one.
+     *
+     * Neither side ever waits for the other. Readers retry if the instances were swapped while they were entering;
+     * the writer only touches the standby instance once the last reader has left it (see tryBeginUpdate()).
+     * The writer is responsible for bringing the standby instance up to date before publishing it.
+     *
+     * @tparam T The state type.
+     */
+    template<typename T>
+    class DoubleBuffered final {
+        public: // +++ Constructor / Destructor +++
+            DoubleBuffered() = default;
+            DoubleBuffered(const DoubleBuffered&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Calls reader with the currently published instance, which won't change during the call.
+             *
+             * @return Whatever reader returns.
+             */
+            template<typename Reader>
+            decltype(auto) read(Reader&& reader) const {
+                uint32_t index = 0;
+                while (true) {
+                    index = m_published.load();
+                    m_slots[index].readers.fetch_add(1);
+                    // the writer might have swapped (and started updating our instance) in the meantime
+                    if (m_published.load() == index) { break; }
+                    m_slots[index].readers.fetch_sub(1);
+                }
+
+                struct Release {
+                    atomic<uint32_t>& readers;
+                    ~Release() { readers.fetch_sub(1); }
+                } release{ m_slots[index].readers };
+
+                return reader(static_cast<const T&>(m_slots[index].instance));
+            }
+
+            /**
+             * @brief Gets a value indicating whether or not the standby instance may be modified; i.e. no reader is left on it.
+             *
+             * Writer only. If this returns false, the writer keeps its changes and tries again later.
+             */
+            bool tryBeginUpdate() const { return m_slots[1 - m_published.load()].readers.load() == 0; }
+
+            T& getStandby() { return m_slots[1 - m_published.load()].instance; } //!< Writer only; valid after tryBeginUpdate() returned true
+
+            const T& getPublished() const { return m_slots[m_published.load()].instance; } //!< Writer only; the writer is the only one changing the published index
+
+            /**
+             * @brief Publishes the standby instance. The previously published instance becomes the standby instance.
+             */
+            void swap() { m_published.store(1 - m_published.load()); }
+
+        private:
+            struct alignas(64) Slot {
+                T                           instance{};
+                mutable atomic<uint32_t>    readers{0};
+            };
+
+            Slot                m_slots[2]{};
+            atomic<uint32_t>    m_published{0};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_DOUBLEBUFFERED_HPP
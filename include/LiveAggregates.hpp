@@ -0,0 +1,239 @@
+/**
+ * @file LiveAggregates.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the aggregate tables maintained by the daemon, which are queried while ingestion continues.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_LIVEAGGREGATES_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_LIVEAGGREGATES_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// libc
+#include <stdint.h>
+#include <time.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "DoubleBuffered.hpp"
+#include "ReportDefinition.hpp"
+#include "RequestAggregator.hpp"
+#include "SlidingWindow.hpp"
+
+namespace httpdreport {
+
+    using std::pair;
+    using std::shared_ptr;
+    using std::string_view;
+    using std::unique_ptr;
+    using std::vector;
+
+    /**
+     * @brief The daemon's tables: all-time totals, a sliding window of client counters for windowed queries and the
+     * tables of each configured report.
+     */
+    class LiveTables final {
+        public: // +++ Constructor / Destructor +++
+            explicit LiveTables(shared_ptr<const ReportSet> reportSet = nullptr) { adoptReportSet(std::move(reportSet)); }
+            LiveTables(const LiveTables&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Adds a single parsed request, which stands for weight requests (e.g. when sampled).
+             */
+            void add(const RequestRecord& record, uint64_t weight = 1) {
+                m_totals.add(record, weight);
+                m_clientWindow.add(record.clientSource, record, weight);
+
+                for (size_t i = 0; i < m_reportTables.size(); i++) {
+                    if (m_reportSet->reports[i].filter.matches(record)) { m_reportTables[i].add(record, weight); }
+                }
+            }
+
+            /**
+             * @brief Merges another set of tables in to this one. If the other tables were built for a newer report set, it is adopted first.
+             */
+            void merge(const LiveTables& other) {
+                m_totals.merge(other.m_totals);
+                m_clientWindow.merge(other.m_clientWindow);
+
+                if (other.m_reportSet != m_reportSet) { adoptReportSet(other.m_reportSet); }
+                for (size_t i = 0; i < m_reportTables.size(); i++) { m_reportTables[i].merge(other.m_reportTables[i]); }
+            }
+
+            /**
+             * @brief Gets the number of requests per status code of one client since the daemon started.
+             *
+             * @return false If the client wasn't seen.
+             */
+            bool getClientStatuses(string_view source, vector<pair<uint16_t, uint64_t>>& statuses) const {
+                statuses.clear();
+
+                uint32_t id = 0;
+                if (!m_totals.findClient(source, id)) { return false; }
+
+                statuses = m_totals.getClient(id).statusCounts;
+                std::sort(statuses.begin(), statuses.end());
+
+                return true;
+            }
+
+            const RequestAggregator& getTotals() const { return m_totals; } //!< Gets the all-time tables
+            RequestAggregator& getTotals() { return m_totals; } //!< Gets the all-time tables, e.g. to restore them
+
+            const SlidingWindow& getClientWindow() const { return m_clientWindow; } //!< Gets the per-client counters of the last hour
+            SlidingWindow& getClientWindow() { return m_clientWindow; } //!< Gets the per-client counters of the last hour, e.g. to restore them
+
+            int64_t getNewestEpoch() const { return m_clientWindow.getNewestEpoch(); } //!< Gets the epoch of the newest request seen
+
+            void advanceTo(int64_t epoch) { m_clientWindow.advanceTo(epoch); } //!< Moves the end of the windows forward, e.g. to the current time
+
+            const shared_ptr<const ReportSet>& getReportSet() const { return m_reportSet; } //!< Gets the reports these tables are kept for; may be nullptr
+            const RequestAggregator& getReportTables(size_t index) const { return m_reportTables[index]; } //!< Gets the tables of a report by its index in the report set
+
+        private: // +++ Private Business +++
+            /**
+             * @brief Switches to another report set. Reports which are defined the same way in both keep their tables.
+             */
+            void adoptReportSet(shared_ptr<const ReportSet> reportSet) {
+                vector<RequestAggregator> reportTables;
+                if (reportSet) {
+                    reportTables.reserve(reportSet->reports.size());
+                    for (const auto& report : reportSet->reports) {
+                        size_t previous = 0;
+                        while (previous < m_reportTables.size() && !m_reportSet->reports[previous].isSameReport(report)) { previous++; }
+
+                        if (previous < m_reportTables.size()) {
+                            reportTables.emplace_back(std::move(m_reportTables[previous]));
+                        } else {
+                            reportTables.emplace_back(getRequiredTables(report.sections));
+                        }
+                    }
+                }
+
+                m_reportSet = std::move(reportSet);
+                m_reportTables = std::move(reportTables);
+            }
+
+        private:
+            RequestAggregator           m_totals{};
+            SlidingWindow               m_clientWindow{}; //!< Keyed by client source
+
+            shared_ptr<const ReportSet> m_reportSet{};
+            vector<RequestAggregator>   m_reportTables{}; //!< In the order of m_reportSet's reports
+    };
+
+    /**
+     * @brief Header-only implementation of the daemon's double-buffered tables.
+     *
+     * The ingesting thread adds requests to a small delta. publish() merges the delta in to the standby tables and swaps them in;
+     * the now-standby tables receive the same delta on the next successful publish. Queries therefore always see a consistent
+     * state, at most one publish interval old, and neither side ever blocks the other.
+     */
+    class LiveAggregates final {
+        public: // +++ Constructor / Destructor +++
+            LiveAggregates(): m_delta(std::make_unique<LiveTables>()) {}
+            LiveAggregates(const LiveAggregates&) = delete;
+
+        public: // +++ Business Logic +++
+            void add(const RequestRecord& record, uint64_t weight = 1) { //!< Adds a request; it becomes visible to queries with the next publish. Ingesting thread only.
+                m_delta->add(record, weight);
+                m_unpublished++;
+            }
+
+            /**
+             * @brief Makes all requests added so far visible to queries, unless a query is still reading the standby tables.
+             *
+             * The windows of the published tables end at the current time (or the newest request, if later), so they keep moving
+             * while no requests arrive. Ingesting thread only.
+             *
+             * @return true If the requests were published, false if publishing has to be retried later.
+             */
+            bool publish() {
+                const auto now = static_cast<int64_t>(time(nullptr));
+                if (m_unpublished == 0 && now / SlidingWindow::SLOT_SECONDS == m_publishedEpoch / SlidingWindow::SLOT_SECONDS) { return true; }
+                if (!m_tables.tryBeginUpdate()) { return false; }
+
+                auto& standby = m_tables.getStandby();
+                if (m_pending) { standby.merge(*m_pending); }
+                standby.merge(*m_delta);
+                standby.advanceTo(now);
+                m_tables.swap();
+                m_publishedEpoch = now;
+
+                // the previously published tables still lack the delta
+                m_pending = std::move(m_delta);
+                m_delta = std::make_unique<LiveTables>(m_reportSet);
+                // a new report set only reaches the published tables with a delta built for it
+                m_unpublished = m_delta->getReportSet() != m_pending->getReportSet() ? 1 : 0;
+
+                return true;
+            }
+
+            /**
+             * @brief Lets loader fill the tables of the next publish directly (LiveTables&), e.g. to restore saved tables before any request is added.
+             *
+             * Ingesting thread only.
+             *
+             * @return false If loader returned false; nothing is published in that case.
+             */
+            template<typename Loader>
+            bool load(Loader&& loader) {
+                if (!loader(*m_delta)) {
+                    m_delta = std::make_unique<LiveTables>(m_reportSet);
+                    m_unpublished = 0;
+                    return false;
+                }
+
+                m_unpublished += std::max<uint64_t>(1, m_delta->getTotals().getTotalRequests());
+                return true;
+            }
+
+            /**
+             * @brief Calls reader with a consistent view of the tables (const LiveTables&). Any thread.
+             */
+            template<typename Reader>
+            decltype(auto) read(Reader&& reader) const { return m_tables.read(std::forward<Reader>(reader)); }
+
+            /**
+             * @brief Switches to another set of reports. Requests added so far are still filtered by the previous set; reports
+             * defined the same way in both sets keep their tables. Ingesting thread only.
+             */
+            void setReportSet(shared_ptr<const ReportSet> reportSet) {
+                m_reportSet = std::move(reportSet);
+                if (m_unpublished == 0) {
+                    m_delta = std::make_unique<LiveTables>(m_reportSet);
+                    m_unpublished = 1;
+                }
+            }
+
+            uint64_t getUnpublished() const { return m_unpublished; } //!< Gets the number of requests not yet visible to queries
+
+        private:
+            DoubleBuffered<LiveTables>  m_tables{};
+
+            unique_ptr<LiveTables>      m_delta{}; //!< Requests added since the last publish
+            unique_ptr<LiveTables>      m_pending{}; //!< The delta published last, which the standby tables still lack
+            shared_ptr<const ReportSet> m_reportSet{}; //!< The reports new deltas are built for
+            uint64_t                    m_unpublished{0};
+            int64_t                     m_publishedEpoch{0}; //!< The time of the last publish, which the published windows end at
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_LIVEAGGREGATES_HPP
@@ -0,0 +1,267 @@
+/**
+ * @file LogFollower.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the reader which follows growing log files (tail -F) across rotation and truncation.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_LOGFOLLOWER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_LOGFOLLOWER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using std::string;
+    using std::string_view;
+    using std::vector;
+
+    /**
+     * @brief Header-only implementation of a reader which keeps following files as they grow.
+     *
+     * Every poll() reads whatever was appended since the previous one. Rotated files (the path now refers to a new inode)
+     * are read until their end before the new file is opened; truncated files (copytruncate) are read again from the start.
+     *
+     * Files are identified by device and inode, not path: when a rotation moves a file which was read under one path to
+     * another followed path (log to log.1), reading continues where it left off instead of starting over.
+     */
+    class LogFollower final {
+        public: // +++ Static +++
+            static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20; //!< The number of bytes read per call
+            static constexpr size_t MAX_CHUNKS_PER_POLL = 16; //!< Bounds the time spent in a single poll(), so callers can do other work between polls
+            static constexpr size_t MAX_RETIRED_FILES = 64; //!< How many rotated-away files are remembered, in case another path picks them up
+
+            /**
+             * @brief How far a file has been read; everything before offset was passed to the handler as complete lines.
+             */
+            struct FilePosition {
+                string      path{};
+                uint64_t    device{0}; //!< 0 if the file didn't exist
+                uint64_t    inode{0};
+                uint64_t    offset{0};
+            };
+
+        public: // +++ Constructor / Destructor +++
+            explicit LogFollower(size_t chunkSize = DEFAULT_CHUNK_SIZE): m_chunkSize(chunkSize) {}
+            LogFollower(const LogFollower&) = delete;
+            ~LogFollower() { for (auto& file : m_files) { closeFile(file); } }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Adds a file to follow. It doesn't need to exist yet.
+             *
+             * @param path The file to follow.
+             * @param fromStart Whether the existing contents are read (true) or only what is appended from now on (false).
+             */
+            void addFile(const fs::path& path, bool fromStart = true) {
+                m_files.emplace_back();
+                m_files.back().path = path;
+                if (openFile(m_files.back()) && !fromStart) { m_files.back().offset = lseek(m_files.back().fd, 0, SEEK_END); }
+            }
+
+            /**
+             * @brief Adds a file to follow, continuing at a position saved with getPositions() if path refers to the file saved.
+             *
+             * @param path The file to follow; after a rotation, the saved file lives on under a path other than the saved one.
+             * @param position The saved position, matched by device and inode.
+             *
+             * @return true If reading continues at the saved position; false if the file is read from the start.
+             */
+            bool resumeFile(const fs::path& path, const FilePosition& position) {
+                addFile(path);
+
+                auto& file = m_files.back();
+                struct stat info{};
+                if (
+                    file.fd < 0 || fstat(file.fd, &info) != 0 || static_cast<uint64_t>(file.device) != position.device ||
+                    static_cast<uint64_t>(file.inode) != position.inode || static_cast<uint64_t>(info.st_size) < position.offset
+                ) { return false; }
+
+                file.offset = static_cast<off_t>(position.offset);
+                return true;
+            }
+
+            /**
+             * @brief Gets the positions of all files, up to the last complete line handled.
+             */
+            vector<FilePosition> getPositions() const {
+                vector<FilePosition> positions;
+                for (const auto& file : m_files) {
+                    positions.push_back({
+                        file.path.string(), file.fd < 0 ? 0 : static_cast<uint64_t>(file.device), file.fd < 0 ? 0 : static_cast<uint64_t>(file.inode),
+                        file.fd < 0 ? 0 : static_cast<uint64_t>(file.offset) - file.carry
+                    });
+                }
+
+                return positions;
+            }
+
+            /**
+             * @brief Reads the data appended to all files since the last poll and passes each complete line to the handler.
+             *
+             * @param handler A callable accepting a string_view per line.
+             *
+             * @return size_t The number of bytes read. 0 if there was nothing new.
+             */
+            template<typename LineHandler>
+            size_t poll(LineHandler&& handler) {
+                size_t total = 0;
+                for (auto& file : m_files) {
+                    if (file.fd < 0 && !openFile(file)) { continue; }
+
+                    const auto bytesRead = readAvailable(file, handler);
+                    total += bytesRead;
+                    if (bytesRead == 0) { checkRotation(file, handler); }
+                }
+
+                return total;
+            }
+
+            size_t getFileCount() const { return m_files.size(); } //!< Gets the number of files followed
+
+        private: // +++ Private Business +++
+            struct FollowedFile {
+                fs::path        path{};
+                int             fd{-1};
+                dev_t           device{0};
+                ino_t           inode{0};
+                off_t           offset{0};
+                vector<char>    buffer{}; //!< The unfinished last line followed by new data
+                size_t          carry{0};
+            };
+
+            /**
+             * @brief How far a file was read before its path was rotated away from it.
+             */
+            struct RetiredFile {
+                dev_t   device{0};
+                ino_t   inode{0};
+                off_t   offset{0};
+            };
+
+            /**
+             * @brief Opens a file's path, continuing where the file was left if it was already read under another path.
+             *
+             * @return false If the path doesn't exist, or its file is still followed under another path; poll() retries later.
+             */
+            bool openFile(FollowedFile& file) {
+                struct stat info{};
+                if ((file.fd = open(file.path.c_str(), O_RDONLY | O_CLOEXEC)) < 0 || fstat(file.fd, &info) != 0) {
+                    closeFile(file);
+                    return false;
+                }
+
+                // e.g. log.1 after a rotation, before the follower of log has read log's last lines and let go of it
+                for (const auto& other : m_files) {
+                    if (&other != &file && other.fd >= 0 && other.device == info.st_dev && other.inode == info.st_ino) {
+                        closeFile(file);
+                        return false;
+                    }
+                }
+
+                file.device = info.st_dev;
+                file.inode = info.st_ino;
+                file.offset = 0;
+                file.carry = 0;
+
+                const auto retired = std::find_if(m_retiredFiles.begin(), m_retiredFiles.end(), [&](const RetiredFile& entry) {
+                    return entry.device == info.st_dev && entry.inode == info.st_ino;
+                });
+                if (retired != m_retiredFiles.end()) {
+                    // a smaller file is a new one which got a recycled inode
+                    if (info.st_size >= retired->offset) { file.offset = retired->offset; }
+                    m_retiredFiles.erase(retired);
+                }
+
+                return true;
+            }
+
+            static void closeFile(FollowedFile& file) {
+                if (file.fd >= 0) { close(file.fd); }
+                file.fd = -1;
+            }
+
+            template<typename LineHandler>
+            size_t readAvailable(FollowedFile& file, LineHandler& handler) {
+                size_t total = 0;
+                for (size_t chunk = 0; chunk < MAX_CHUNKS_PER_POLL; chunk++) {
+                    if (file.buffer.size() < file.carry + m_chunkSize) { file.buffer.resize(file.carry + m_chunkSize); }
+
+                    const auto bytesRead = pread(file.fd, file.buffer.data() + file.carry, m_chunkSize, file.offset);
+                    if (bytesRead < 0 && errno == EINTR) { continue; }
+                    if (bytesRead <= 0) { break; }
+
+                    file.offset += bytesRead;
+                    total += static_cast<size_t>(bytesRead);
+
+                    const char* begin = file.buffer.data();
+                    const char* end = begin + file.carry + bytesRead;
+                    const char* lineStart = begin;
+                    const char* newLine = nullptr;
+                    while ((newLine = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart))) != nullptr) {
+                        if (newLine != lineStart) { handler(string_view(lineStart, newLine - lineStart)); }
+                        lineStart = newLine + 1;
+                    }
+
+                    // unlike LogReader, an unfinished line is kept until its writer finishes it
+                    file.carry = end - lineStart;
+                    if (file.carry > 0 && lineStart != begin) { std::memmove(file.buffer.data(), lineStart, file.carry); }
+                }
+
+                return total;
+            }
+
+            template<typename LineHandler>
+            void checkRotation(FollowedFile& file, LineHandler& handler) {
+                struct stat info{};
+                if (stat(file.path.c_str(), &info) != 0 || info.st_dev != file.device || info.st_ino != file.inode) {
+                    // rotated or removed; the old file has been read completely, so its last line is final
+                    if (file.carry > 0) { handler(string_view(file.buffer.data(), file.carry)); }
+
+                    if (m_retiredFiles.size() >= MAX_RETIRED_FILES) { m_retiredFiles.erase(m_retiredFiles.begin()); }
+                    m_retiredFiles.push_back({ file.device, file.inode, file.offset });
+
+                    closeFile(file);
+                    openFile(file);
+                    return;
+                }
+
+                if (info.st_size < file.offset) {
+                    // truncated in place
+                    file.offset = 0;
+                    file.carry = 0;
+                }
+            }
+
+        private:
+            size_t                  m_chunkSize{DEFAULT_CHUNK_SIZE};
+
+            vector<FollowedFile>    m_files{};
+            vector<RetiredFile>     m_retiredFiles{}; //!< Oldest first
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_LOGFOLLOWER_HPP
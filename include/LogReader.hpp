@@ -0,0 +1,349 @@
+/**
+ * @file LogReader.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the chunked line reader used to feed log files (plain or gzip-compressed) to the parser.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_LOGREADER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_LOGREADER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// zlib
+#include <zlib.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AllocationCounter.hpp"
+#include "PipelineStats.hpp"
+#include "Probes.hpp"
+#include "RelaxedCounter.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using std::string;
+    using std::string_view;
+    using std::vector;
+
+    /**
+     * @brief Header-only implementation of a reader which splits files in to lines.
+     *
+     * Files are read in large chunks and every complete line is passed to the handler as a view in to the chunk,
+     * so no per-line allocations take place. Views are only valid for the duration of the handler call.
+     */
+    class LogReader final {
+        public: // +++ Static +++
+            static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20; //!< The default number of bytes read per call
+            static constexpr const char* LINES_SPAN = "parse+aggregate"; //!< Traces a chunk's lines; the handler parses and aggregates each in turn
+
+        public: // +++ Constructor / Destructor +++
+            explicit LogReader(size_t chunkSize = DEFAULT_CHUNK_SIZE): m_chunkSize(chunkSize) {}
+            LogReader(const LogReader&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Counts the bytes read by this reader, e.g. to report progress. Either counter may be nullptr.
+             *
+             * @param inputBytes Receives the bytes read from files and descriptors; compressed bytes for gzip files.
+             * @param decodedBytes Receives the bytes split in to lines, i.e. after decompression.
+             */
+            void setByteCounters(RelaxedCounter* inputBytes, RelaxedCounter* decodedBytes) {
+                m_inputBytes = inputBytes;
+                m_decodedBytes = decodedBytes;
+            }
+
+            /**
+             * @brief Times every read (and, for gzip files, decompression) call in to the given statistics; nullptr disables timing.
+             */
+            void setStats(PipelineStats* stats) { m_stats = stats; }
+
+            /**
+             * @brief Reads all lines from a file, transparently decompressing gzip files.
+             *
+             * @param path The file to read.
+             * @param handler A callable accepting a string_view per line.
+             *
+             * @return true If the file was read completely.
+             * @return false If the file couldn't be opened or read. errno is set accordingly.
+             */
+            template<typename LineHandler>
+            bool readFile(const fs::path& path, LineHandler&& handler) {
+                const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) { return false; }
+                HTTPDREPORT_PROBE2(file_open, path.c_str(), fd);
+
+                setTraceFile(&path);
+                const auto success = readDescriptor(fd, isGzipFile(fd), true, handler);
+                setTraceFile(nullptr);
+                HTTPDREPORT_PROBE2(file_close, path.c_str(), success);
+
+                return success;
+            }
+
+            /**
+             * @brief Reads all lines from an already opened file descriptor (e.g. stdin).
+             *
+             * @param fd The descriptor to read from. It is not closed.
+             * @param handler A callable accepting a string_view per line.
+             *
+             * @return true If the descriptor was read until EOF.
+             * @return false Otherwise.
+             */
+            template<typename LineHandler>
+            bool readDescriptor(int fd, LineHandler&& handler) { return readDescriptor(fd, false, false, handler); }
+
+            /**
+             * @brief Reads the lines of an uncompressed file which start within [start, end), so a file can be split at any offset
+             * and every line is still read exactly once.
+             *
+             * @param path The file to read.
+             * @param start The first byte of the range. A line beginning before it belongs to the previous range.
+             * @param handler A callable accepting a string_view per line.
+             * @param getEnd Called before every chunk with the offset of the next unread line; returns the (exclusive) end of the
+             * range, which may shrink while reading, but never below that offset.
+             *
+             * @return true If the range was read completely.
+             * @return false If the file couldn't be opened or read. errno is set accordingly.
+             */
+            template<typename LineHandler, typename EndProvider>
+            bool readRange(const fs::path& path, uint64_t start, LineHandler&& handler, EndProvider&& getEnd) {
+                const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) { return false; }
+                HTTPDREPORT_PROBE2(file_open, path.c_str(), fd);
+
+                // unless the range starts right after a line break, its first (partial) line belongs to the previous range
+                char previous = '\n';
+                if (start > 0 && pread(fd, &previous, 1, static_cast<off_t>(start - 1)) != 1) {
+                    close(fd);
+                    HTTPDREPORT_PROBE2(file_close, path.c_str(), false);
+                    return false;
+                }
+                bool skipPartialLine = previous != '\n';
+                setTraceFile(&path);
+
+                resizeBuffer(m_chunkSize * 2);
+                // lineOffset is the file offset of m_buffer[0], i.e. of the next unread line
+                uint64_t lineOffset = start;
+                uint64_t readOffset = start;
+                uint64_t end = start;
+                size_t carry = 0;
+                bool success = true;
+
+                while (true) {
+                    end = getEnd(lineOffset);
+                    if (!skipPartialLine && lineOffset >= end) { break; }
+                    if (carry + m_chunkSize > m_buffer.size()) { resizeBuffer(carry + m_chunkSize); }
+
+                    ssize_t bytesRead = 0;
+                    PipelineStats::Timer timer(m_stats, PipelineStage::READ);
+                    do {
+                        bytesRead = pread(fd, m_buffer.data() + carry, m_chunkSize, static_cast<off_t>(readOffset));
+                    } while (bytesRead < 0 && errno == EINTR);
+                    timer.stop(static_cast<uint64_t>(std::max<ssize_t>(0, bytesRead)));
+
+                    if (bytesRead < 0) { success = false; break; }
+                    if (bytesRead == 0) { break; }
+                    readOffset += static_cast<uint64_t>(bytesRead);
+                    countBytes(static_cast<uint64_t>(bytesRead), static_cast<uint64_t>(bytesRead));
+
+                    const char* begin = m_buffer.data();
+                    const char* bufferEnd = begin + carry + bytesRead;
+                    const char* lineStart = begin;
+                    const char* newLine = nullptr;
+
+                    if (skipPartialLine) {
+                        if ((newLine = static_cast<const char*>(std::memchr(lineStart, '\n', bufferEnd - lineStart))) == nullptr) {
+                            lineOffset += static_cast<uint64_t>(bufferEnd - begin);
+                            carry = 0;
+                            continue;
+                        }
+
+                        lineStart = newLine + 1;
+                        skipPartialLine = false;
+                    }
+
+                    HTTPDREPORT_PROBE1(chunk_dispatch, bufferEnd - lineStart);
+                    TraceRecorder::Span linesSpan(getTrace(), LINES_SPAN);
+                    uint64_t lines = 0;
+                    while (
+                        lineOffset + static_cast<uint64_t>(lineStart - begin) < end &&
+                        (newLine = static_cast<const char*>(std::memchr(lineStart, '\n', bufferEnd - lineStart))) != nullptr
+                    ) {
+                        if (newLine != lineStart) {
+                            handler(string_view(lineStart, newLine - lineStart));
+                            lines++;
+                        }
+                        lineStart = newLine + 1;
+                    }
+                    linesSpan.end(static_cast<uint64_t>(lineStart - begin), lines);
+                    HTTPDREPORT_PROBE2(parse_batch, lineStart - begin, lines);
+
+                    lineOffset += static_cast<uint64_t>(lineStart - begin);
+                    carry = bufferEnd - lineStart;
+                    if (carry > 0 && lineStart != begin) { std::memmove(m_buffer.data(), lineStart, carry); }
+                }
+
+                // the last line of the file may lack its line break
+                if (success && carry > 0 && !skipPartialLine && lineOffset < end) { handler(string_view(m_buffer.data(), carry)); }
+
+                setTraceFile(nullptr);
+                close(fd);
+                HTTPDREPORT_PROBE2(file_close, path.c_str(), success);
+                return success;
+            }
+
+            /**
+             * @brief Gets a value indicating whether or not a file starts with the gzip magic number.
+             *
+             * @param path The file to check.
+             */
+            static bool isGzipFile(const fs::path& path) {
+                const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0) { return false; }
+
+                const auto isGzip = isGzipFile(fd);
+                close(fd);
+
+                return isGzip;
+            }
+
+        private: // +++ Private Business +++
+            void resizeBuffer(size_t size) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::READER);
+                m_buffer.resize(size);
+            }
+
+            TraceRecorder* getTrace() const { return m_stats != nullptr ? m_stats->getTrace() : nullptr; }
+
+            /**
+             * @brief Tags the trace events of the following chunks with a file; nullptr ends the tagging.
+             */
+            void setTraceFile(const fs::path* path) {
+                auto* trace = getTrace();
+                if (trace == nullptr) { return; }
+
+                trace->setFile(path != nullptr ? trace->addFile(path->string()) : TraceRecorder::NO_FILE);
+            }
+
+            void countBytes(uint64_t inputBytes, uint64_t decodedBytes) {
+                if (m_inputBytes != nullptr) { m_inputBytes->add(inputBytes); }
+                if (m_decodedBytes != nullptr) { m_decodedBytes->add(decodedBytes); }
+            }
+
+            static bool isGzipFile(int fd) {
+                unsigned char magic[2] = {0};
+                const auto isGzip = pread(fd, magic, sizeof(magic), 0) == sizeof(magic) && magic[0] == 0x1f && magic[1] == 0x8b;
+
+                return isGzip;
+            }
+
+            template<typename LineHandler>
+            bool readDescriptor(int fd, bool isGzip, bool closeWhenDone, LineHandler& handler) {
+                gzFile gzHandle = nullptr;
+                if (isGzip) {
+                    if ((gzHandle = gzdopen(fd, "rb")) == nullptr) {
+                        if (closeWhenDone) { close(fd); }
+                        return false;
+                    }
+                    gzbuffer(gzHandle, static_cast<unsigned>(m_chunkSize));
+                }
+
+                // the buffer holds the unfinished line of the previous chunk followed by the new chunk
+                resizeBuffer(m_chunkSize * 2);
+                size_t carry = 0;
+                bool success = true;
+                uint64_t compressedOffset = 0;
+
+                while (true) {
+                    if (carry + m_chunkSize > m_buffer.size()) { resizeBuffer(carry + m_chunkSize); }
+
+                    ssize_t bytesRead = 0;
+                    uint64_t inputBytes = 0;
+                    PipelineStats::Timer timer(m_stats, gzHandle != nullptr ? PipelineStage::DECOMPRESS : PipelineStage::READ);
+                    if (gzHandle != nullptr) {
+                        bytesRead = gzread(gzHandle, m_buffer.data() + carry, static_cast<unsigned>(m_chunkSize));
+
+                        // zlib reads ahead, so this is the compressed input consumed so far, give or take its buffer
+                        const auto offset = static_cast<uint64_t>(std::max<z_off_t>(0, gzoffset(gzHandle)));
+                        inputBytes = offset > compressedOffset ? offset - compressedOffset : 0;
+                        compressedOffset = std::max(compressedOffset, offset);
+                    } else {
+                        do {
+                            bytesRead = read(fd, m_buffer.data() + carry, m_chunkSize);
+                        } while (bytesRead < 0 && errno == EINTR);
+                        inputBytes = bytesRead > 0 ? static_cast<uint64_t>(bytesRead) : 0;
+                    }
+                    timer.stop(static_cast<uint64_t>(std::max<ssize_t>(0, bytesRead)));
+
+                    if (bytesRead < 0) { success = false; break; }
+                    if (bytesRead == 0) { break; }
+                    countBytes(inputBytes, static_cast<uint64_t>(bytesRead));
+
+                    const char* begin = m_buffer.data();
+                    const char* end = begin + carry + bytesRead;
+                    const char* lineStart = begin;
+                    const char* newLine = nullptr;
+
+                    HTTPDREPORT_PROBE1(chunk_dispatch, end - lineStart);
+                    TraceRecorder::Span linesSpan(getTrace(), LINES_SPAN);
+                    uint64_t lines = 0;
+                    while ((newLine = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart))) != nullptr) {
+                        if (newLine != lineStart) {
+                            handler(string_view(lineStart, newLine - lineStart));
+                            lines++;
+                        }
+                        lineStart = newLine + 1;
+                    }
+                    linesSpan.end(static_cast<uint64_t>(lineStart - begin), lines);
+                    HTTPDREPORT_PROBE2(parse_batch, lineStart - begin, lines);
+
+                    carry = end - lineStart;
+                    if (carry > 0 && lineStart != begin) { std::memmove(m_buffer.data(), lineStart, carry); }
+                }
+
+                if (carry > 0) { handler(string_view(m_buffer.data(), carry)); }
+
+                if (gzHandle != nullptr) {
+                    gzclose(gzHandle); // closes fd, too; gzip is only detected on files we own
+                } else if (closeWhenDone) {
+                    close(fd);
+                }
+
+                return success;
+            }
+
+        private:
+            size_t          m_chunkSize{DEFAULT_CHUNK_SIZE};
+            RelaxedCounter* m_inputBytes{nullptr};
+            RelaxedCounter* m_decodedBytes{nullptr};
+            PipelineStats*  m_stats{nullptr};
+
+            vector<char>    m_buffer{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_LOGREADER_HPP
@@ -16,6 +16,7 @@
 /////////////////////
 
 // stl
+#include <algorithm>
 #include <string>
 #include <filesystem>
 #include <vector>
@@ -23,6 +24,9 @@
 // fmt
 #include <fmt/format.h>
 
+// libc
+#include <fnmatch.h>
+
 /////////////////////
 // LOCAL  INCLUDES //
 /////////////////////
@@ -48,7 +52,16 @@ namespace httpdreport {
             LogSearcher(const LogSearcher&) = delete;
 
         public: // +++ Business Logic +++
-            void searchLogFiles() { searchLogFiles(m_appOpts.LogDirectory); }
+            void searchLogFiles() {
+                searchLogFiles(m_appOpts.LogDirectory);
+
+                // directory iteration order is unspecified; keep reports reproducible
+                std::sort(m_accessLogs.begin(), m_accessLogs.end());
+                std::sort(m_errorLogs.begin(), m_errorLogs.end());
+            }
+
+            const vector<fs::path>& getAccessLogs() const { return m_accessLogs; } //!< Gets the access logs found by the last search
+            const vector<fs::path>& getErrorLogs() const { return m_errorLogs; } //!< Gets the error logs found by the last search
 
         private: // +++ Private Business +++
             void searchLogFiles(const fs::path& dirPath) {
@@ -81,7 +94,14 @@ namespace httpdreport {
                             continue;
                         }
 
-                        
+                        if (entry.is_directory()) { continue; }
+
+                        const auto fileName = entry.path().filename().string();
+                        if (fnmatch(m_appOpts.AccessFileGlob.c_str(), fileName.c_str(), 0) == 0) {
+                            m_accessLogs.push_back(entry.path());
+                        } else if (fnmatch(m_appOpts.ErrorFileGlob.c_str(), fileName.c_str(), 0) == 0) {
+                            m_errorLogs.push_back(entry.path());
+                        }
                     }
                 } catch (const fs::filesystem_error& ex) {
                     // exception handling later
@@ -0,0 +1,267 @@
+/**
+ * @file MetricsRegistry.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the per-thread live counters exposed in the Prometheus/OpenMetrics text format.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_METRICSREGISTRY_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_METRICSREGISTRY_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <stdint.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "RelaxedCounter.hpp"
+#include "RequestAggregator.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using std::array;
+    using std::atomic;
+    using std::deque;
+    using std::map;
+    using std::mutex;
+    using std::string;
+    using std::string_view;
+    using std::unique_lock;
+    using std::unordered_map;
+
+    /**
+     * @brief The upper bounds (inclusive, in bytes) of the response size histogram; the last bucket is +Inf.
+     */
+    static constexpr array<uint64_t, 9> RESPONSE_SIZE_BUCKETS = { 256, 1 << 10, 4 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20, 4 << 20, 16 << 20 };
+
+    /**
+     * @brief The counters of a single virtual host, as kept by a single thread.
+     */
+    struct alignas(64) VhostCounters final {
+        string                                              vhost{}; //!< The virtual host; never changes once created
+        RelaxedCounter                                      requests{};
+        RelaxedCounter                                      bytes{};
+        array<RelaxedCounter, 6>                            statusClasses{}; //!< See StatusClassCounts
+        array<RelaxedCounter, RESPONSE_SIZE_BUCKETS.size() + 1> sizeBuckets{}; //!< Non-cumulative; made cumulative when exposed
+    };
+
+    /**
+     * @brief One thread's set of counters. Only the owning thread records; scrapes read concurrently.
+     */
+    class alignas(64) MetricsShard final {
+        public: // +++ Constructor / Destructor +++
+            MetricsShard() = default;
+            MetricsShard(const MetricsShard&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Counts a parsed request, which stands for weight requests (e.g. when sampled). Owning thread only.
+             */
+            void record(const RequestRecord& record, uint64_t weight = 1) {
+                auto* counters = m_last;
+                if (counters == nullptr || counters->vhost != record.virtualHost) {
+                    counters = getCounters(record.virtualHost);
+                    m_last = counters;
+                }
+
+                const auto size = static_cast<uint64_t>(record.responseSize);
+                size_t bucket = 0;
+                while (bucket < RESPONSE_SIZE_BUCKETS.size() && size > RESPONSE_SIZE_BUCKETS[bucket]) { bucket++; }
+
+                counters->requests.add(weight);
+                counters->bytes.add(size * weight);
+                counters->statusClasses[getStatusClass(record.statusCode)].add(weight);
+                counters->sizeBuckets[bucket].add(weight);
+            }
+
+            void reject() { m_rejected.add(1); } //!< Counts a malformed line. Owning thread only.
+
+            /**
+             * @brief Calls visitor for every vhost's counters. Any thread.
+             */
+            template<typename Visitor>
+            void forEach(Visitor&& visitor) const {
+                unique_lock<mutex> lock(m_lock);
+                for (const auto& counters : m_vhosts) { visitor(counters); }
+            }
+
+            uint64_t getRejected() const { return m_rejected.get(); } //!< Gets the number of malformed lines
+
+        private: // +++ Private Business +++
+            VhostCounters* getCounters(string_view vhost) {
+                // only the owning thread modifies the index, so it is read without locking
+                if (const auto it = m_index.find(vhost); it != m_index.end()) { return it->second; }
+
+                unique_lock<mutex> lock(m_lock);
+                m_vhosts.emplace_back();
+                m_vhosts.back().vhost = string(vhost);
+                m_index.emplace(m_vhosts.back().vhost, &m_vhosts.back());
+
+                return &m_vhosts.back();
+            }
+
+        private:
+            mutable mutex                                   m_lock{}; //!< Guards m_vhosts against growing during a scrape
+            deque<VhostCounters>                            m_vhosts{}; //!< A deque never moves its elements
+            unordered_map<string_view, VhostCounters*>      m_index{};
+            VhostCounters*                                  m_last{nullptr}; //!< Consecutive requests nearly always share their vhost
+
+            RelaxedCounter                                  m_rejected{};
+    };
+
+    /**
+     * @brief Header-only implementation of the registry of all threads' counters, summed only when scraped.
+     */
+    class MetricsRegistry final {
+        public: // +++ Constructor / Destructor +++
+            MetricsRegistry() = default;
+            MetricsRegistry(const MetricsRegistry&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Creates the counters for a recording thread. The shard lives as long as the registry.
+             */
+            MetricsShard& createShard() {
+                unique_lock<mutex> lock(m_lock);
+                return m_shards.emplace_back();
+            }
+
+            /**
+             * @brief The counters of a single vhost, summed over all shards.
+             */
+            struct VhostTotals {
+                uint64_t                                        requests{0};
+                uint64_t                                        bytes{0};
+                StatusClassCounts                               statusClasses{};
+                array<uint64_t, RESPONSE_SIZE_BUCKETS.size() + 1> sizeBuckets{};
+            };
+
+            /**
+             * @brief Sums the counters of all shards, per vhost.
+             *
+             * @param rejected Receives the number of malformed lines.
+             */
+            map<string, VhostTotals> getVhostTotals(uint64_t& rejected) const {
+                map<string, VhostTotals> vhosts;
+                rejected = 0;
+
+                unique_lock<mutex> lock(m_lock);
+                for (const auto& shard : m_shards) {
+                    rejected += shard.getRejected();
+                    shard.forEach([&](const VhostCounters& counters) {
+                        auto& totals = vhosts[counters.vhost];
+                        totals.requests += counters.requests.get();
+                        totals.bytes += counters.bytes.get();
+                        for (size_t i = 0; i < totals.statusClasses.size(); i++) { totals.statusClasses[i] += counters.statusClasses[i].get(); }
+                        for (size_t i = 0; i < totals.sizeBuckets.size(); i++) { totals.sizeBuckets[i] += counters.sizeBuckets[i].get(); }
+                    });
+                }
+
+                return vhosts;
+            }
+
+            /**
+             * @brief Renders the sum of all shards in the Prometheus text exposition format (version 0.0.4).
+             */
+            string render() const {
+                uint64_t rejected = 0;
+                const auto vhosts = getVhostTotals(rejected);
+
+                static constexpr const char* STATUS_CLASS_LABELS[] = { "other", "1xx", "2xx", "3xx", "4xx", "5xx" };
+
+                string text;
+                auto out = std::back_inserter(text);
+
+                text += "# HELP httpd_requests_total Requests by virtual host and status class.\n# TYPE httpd_requests_total counter\n";
+                for (const auto& vhost : vhosts) {
+                    const auto label = escapeLabel(vhost.first);
+                    for (size_t i = 0; i < vhost.second.statusClasses.size(); i++) {
+                        fmt::format_to(out, "httpd_requests_total{{vhost=\"{0:s}\",class=\"{1:s}\"}} {2:d}\n", label, STATUS_CLASS_LABELS[i], vhost.second.statusClasses[i]);
+                    }
+                }
+
+                text += "# HELP httpd_response_bytes_total Response bytes (without headers) by virtual host.\n# TYPE httpd_response_bytes_total counter\n";
+                for (const auto& vhost : vhosts) {
+                    fmt::format_to(out, "httpd_response_bytes_total{{vhost=\"{0:s}\"}} {1:d}\n", escapeLabel(vhost.first), vhost.second.bytes);
+                }
+
+                text += "# HELP httpd_response_size_bytes Response sizes by virtual host.\n# TYPE httpd_response_size_bytes histogram\n";
+                for (const auto& vhost : vhosts) {
+                    const auto label = escapeLabel(vhost.first);
+                    uint64_t cumulative = 0;
+                    for (size_t i = 0; i < RESPONSE_SIZE_BUCKETS.size(); i++) {
+                        cumulative += vhost.second.sizeBuckets[i];
+                        fmt::format_to(out, "httpd_response_size_bytes_bucket{{vhost=\"{0:s}\",le=\"{1:d}\"}} {2:d}\n", label, RESPONSE_SIZE_BUCKETS[i], cumulative);
+                    }
+                    fmt::format_to(out, "httpd_response_size_bytes_bucket{{vhost=\"{0:s}\",le=\"+Inf\"}} {1:d}\n", label, vhost.second.requests);
+                    fmt::format_to(out, "httpd_response_size_bytes_sum{{vhost=\"{0:s}\"}} {1:d}\n", label, vhost.second.bytes);
+                    fmt::format_to(out, "httpd_response_size_bytes_count{{vhost=\"{0:s}\"}} {1:d}\n", label, vhost.second.requests);
+                }
+
+                fmt::format_to(out, "# HELP httpd_rejected_lines_total Malformed log lines.\n# TYPE httpd_rejected_lines_total counter\nhttpd_rejected_lines_total {0:d}\n", rejected);
+
+                return text;
+            }
+
+            /**
+             * @brief Writes the exposition to a file for node_exporter's textfile collector, replacing the previous file atomically.
+             */
+            bool writeTextFile(const fs::path& path) const {
+                const auto tempFile = path.string() + ".tmp";
+                {
+                    std::ofstream output(tempFile, std::ios::trunc);
+                    output << render();
+                    if (!output.good()) { return false; }
+                }
+
+                return std::rename(tempFile.c_str(), path.c_str()) == 0;
+            }
+
+        private: // +++ Private Business +++
+            static string escapeLabel(string_view value) {
+                string escaped;
+                escaped.reserve(value.size());
+                for (const auto c : value) {
+                    if (c == '\\' || c == '"') { escaped += '\\'; }
+                    if (c == '\n') { escaped += "\\n"; continue; }
+                    escaped += c;
+                }
+
+                return escaped;
+            }
+
+        private:
+            mutable mutex           m_lock{};
+            deque<MetricsShard>     m_shards{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_METRICSREGISTRY_HPP
@@ -0,0 +1,174 @@
+/**
+ * @file MetricsServer.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the minimal HTTP listener serving /metrics on the loopback interface.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_METRICSSERVER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_METRICSSERVER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "MetricsRegistry.hpp"
+
+namespace httpdreport {
+
+    using fmt::format;
+
+    using std::atomic;
+    using std::string;
+    using std::string_view;
+    using std::thread;
+
+    /**
+     * @brief Header-only implementation of the scrape endpoint.
+     *
+     * Listens on 127.0.0.1 only and answers GET /metrics; every other request is answered with 404.
+     * Scrapes are served one at a time on a dedicated thread.
+     */
+    class MetricsServer final {
+        public: // +++ Static +++
+            static constexpr int32_t RECEIVE_TIMEOUT_SECONDS = 5; //!< Idle clients are disconnected after this time
+            static constexpr size_t MAX_REQUEST_SIZE = 8192; //!< Larger request headers are rejected
+
+        public: // +++ Constructor / Destructor +++
+            explicit MetricsServer(const MetricsRegistry& registry): m_registry(registry) {}
+            MetricsServer(const MetricsServer&) = delete;
+            ~MetricsServer() { stop(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Starts listening on 127.0.0.1:port.
+             *
+             * @return true If the server is running. Otherwise getLastError() contains the reason.
+             */
+            bool start(uint16_t port) {
+                sockaddr_in address{};
+                address.sin_family = AF_INET;
+                address.sin_port = htons(port);
+                address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+                const int reuse = 1;
+                if (
+                    (m_listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0 || pipe2(m_wakePipe, O_CLOEXEC) != 0 ||
+                    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+                    bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(m_listenFd, 16) != 0
+                ) {
+                    m_lastError = strerror(errno);
+                    return false;
+                }
+
+                m_worker = thread([this]() { serveLoop(); });
+                return true;
+            }
+
+            /**
+             * @brief Stops serving and waits for the current scrape to finish.
+             */
+            void stop() {
+                if (m_worker.joinable()) {
+                    m_stopRequested = true;
+                    const char wake = 0;
+                    (void)!::write(m_wakePipe[1], &wake, 1);
+                    m_worker.join();
+                }
+
+                for (auto* fd : { &m_listenFd, &m_wakePipe[0], &m_wakePipe[1] }) {
+                    if (*fd >= 0) { close(*fd); }
+                    *fd = -1;
+                }
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            void serveLoop() {
+                while (!m_stopRequested) {
+                    pollfd fds[] = { { m_listenFd, POLLIN, 0 }, { m_wakePipe[0], POLLIN, 0 } };
+                    if (::poll(fds, 2, -1) < 0 || !(fds[0].revents & POLLIN)) { continue; }
+
+                    const auto clientFd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                    if (clientFd < 0) { continue; }
+
+                    const timeval timeout{ RECEIVE_TIMEOUT_SECONDS, 0 };
+                    setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                    serveClient(clientFd);
+                    close(clientFd);
+                }
+            }
+
+            void serveClient(int clientFd) {
+                string request;
+                char buffer[1024];
+                while (request.find("\r\n\r\n") == string::npos && request.find("\n\n") == string::npos) {
+                    const auto bytesRead = recv(clientFd, buffer, sizeof(buffer), 0);
+                    if (bytesRead < 0 && errno == EINTR) { continue; }
+                    if (bytesRead <= 0 || request.size() + static_cast<size_t>(bytesRead) > MAX_REQUEST_SIZE) { return; }
+                    request.append(buffer, static_cast<size_t>(bytesRead));
+                }
+
+                const auto isMetrics = request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET /metrics?", 0) == 0;
+                const auto body = isMetrics ? m_registry.render() : string("Not found. Try /metrics\n");
+                const auto header = format(
+                    "HTTP/1.0 {0:s}\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: {1:d}\r\nConnection: close\r\n\r\n",
+                    isMetrics ? "200 OK" : "404 Not Found", body.size()
+                );
+
+                sendText(clientFd, header) && sendText(clientFd, body);
+            }
+
+            static bool sendText(int clientFd, string_view text) {
+                while (!text.empty()) {
+                    const auto sent = send(clientFd, text.data(), text.size(), MSG_NOSIGNAL);
+                    if (sent < 0 && errno == EINTR) { continue; }
+                    if (sent <= 0) { return false; }
+                    text.remove_prefix(static_cast<size_t>(sent));
+                }
+
+                return true;
+            }
+
+        private:
+            const MetricsRegistry&  m_registry;
+
+            int                     m_listenFd{-1};
+            int                     m_wakePipe[2]{-1, -1};
+
+            atomic<bool>            m_stopRequested{false};
+            thread                  m_worker{};
+
+            string                  m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_METRICSSERVER_HPP
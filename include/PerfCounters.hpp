@@ -0,0 +1,192 @@
+/**
+ * @file PerfCounters.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the hardware performance counters read via perf_event_open for --counters.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_PERFCOUNTERS_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_PERFCOUNTERS_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <array>
+#include <string>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace httpdreport {
+
+    using fmt::format;
+
+    using std::array;
+    using std::string;
+
+    /**
+     * @brief The hardware events counted per stage and thread.
+     */
+    enum class HardwareCounter: uint8_t {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES, //!< Last level cache misses, as the kernel maps PERF_COUNT_HW_CACHE_MISSES
+        BRANCH_MISSES,
+        COUNTER_COUNT
+    };
+
+    static constexpr size_t HARDWARE_COUNTER_COUNT = static_cast<size_t>(HardwareCounter::COUNTER_COUNT);
+
+    using CounterValues = array<uint64_t, HARDWARE_COUNTER_COUNT>; //!< A reading of every counter, indexed by HardwareCounter
+
+    /**
+     * @brief Header-only implementation of a perf_event_open group counting the calling thread's user space events.
+     *
+     * The counters form one group, so the kernel schedules them together and a single read() returns consistent values.
+     * If the PMU has to multiplex groups, the values are scaled up by the share of the time the group was counting.
+     * Counters the CPU doesn't provide are left out of the group; if none can be opened, open() says why.
+     */
+    class PerfCounterGroup final {
+        public: // +++ Static +++
+            /**
+             * @brief Gets the names of the counters, as used in both the text and the JSON output.
+             */
+            static const char* getCounterName(HardwareCounter counter) {
+                static constexpr const char* NAMES[] = { "cycles", "instructions", "cache_misses", "branch_misses" };
+                return NAMES[static_cast<size_t>(counter)];
+            }
+
+        public: // +++ Constructor / Destructor +++
+            PerfCounterGroup() { m_fds.fill(-1); }
+            PerfCounterGroup(const PerfCounterGroup&) = delete;
+            ~PerfCounterGroup() {
+                for (const auto fd : m_fds) {
+                    if (fd >= 0) { close(fd); }
+                }
+            }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Opens the counters for the calling thread and starts them.
+             *
+             * @return true If at least one counter is counting. Otherwise getLastError() contains the reason.
+             */
+            bool open() {
+                static constexpr uint64_t CONFIGS[] = {
+                    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+                };
+
+                int firstError = 0;
+                for (size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+                    perf_event_attr attributes{};
+                    attributes.size = sizeof(attributes);
+                    attributes.type = PERF_TYPE_HARDWARE;
+                    attributes.config = CONFIGS[i];
+                    attributes.disabled = m_leader < 0 ? 1 : 0; // the group starts when its leader is enabled
+                    attributes.exclude_kernel = 1; // permitted with perf_event_paranoid <= 2
+                    attributes.exclude_hv = 1;
+                    attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                    const auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, m_leader, PERF_FLAG_FD_CLOEXEC));
+                    if (fd < 0) {
+                        if (firstError == 0) { firstError = errno; }
+                        continue;
+                    }
+
+                    if (m_leader < 0) { m_leader = fd; }
+                    m_fds[i] = fd;
+                    m_slots[i] = m_memberCount++;
+                }
+
+                if (m_leader < 0) {
+                    m_lastError = describeError(firstError);
+                    return false;
+                }
+
+                ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+                return true;
+            }
+
+            bool isOpen() const { return m_leader >= 0; } //!< Gets a value indicating whether or not any counter is counting
+            bool has(HardwareCounter counter) const { return m_fds[static_cast<size_t>(counter)] >= 0; } //!< Gets a value indicating whether or not a counter is counting
+
+            /**
+             * @brief Reads all counters; those which aren't counting read as 0.
+             *
+             * @return true If the group was read.
+             */
+            bool read(CounterValues& values) const {
+                // nr, time enabled, time running, then a value per member
+                uint64_t buffer[3 + HARDWARE_COUNTER_COUNT] = {0};
+                if (m_leader < 0 || ::read(m_leader, buffer, sizeof(buffer)) < static_cast<ssize_t>((3 + m_memberCount) * sizeof(uint64_t))) { return false; }
+
+                const auto enabled = buffer[1];
+                const auto running = buffer[2];
+                for (size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+                    if (m_fds[i] < 0) {
+                        values[i] = 0;
+                        continue;
+                    }
+
+                    const auto value = buffer[3 + m_slots[i]];
+                    values[i] = running > 0 && running < enabled ? static_cast<uint64_t>(static_cast<double>(value) * enabled / running) : value;
+                }
+
+                return true;
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason open() failed
+
+        private: // +++ Private Business +++
+            static string describeError(int error) {
+                switch (error) {
+                    case EACCES:
+                    case EPERM: {
+                        int paranoid = -1;
+                        if (auto* file = fopen("/proc/sys/kernel/perf_event_paranoid", "re"); file != nullptr) {
+                            if (fscanf(file, "%d", &paranoid) != 1) { paranoid = -1; }
+                            fclose(file);
+                        }
+
+                        return format("not permitted (kernel.perf_event_paranoid is {0:d}; 2 or lower, or CAP_PERFMON, is required)", paranoid);
+                    }
+                    case ENOENT:
+                    case ENODEV:
+                    case EOPNOTSUPP:
+                        return "the CPU (or hypervisor) provides no hardware counters";
+                    case ENOSYS:
+                        return "the kernel doesn't support perf_event_open";
+                    default:
+                        return strerror(error);
+                }
+            }
+
+        private:
+            int                                         m_leader{-1};
+            array<int, HARDWARE_COUNTER_COUNT>          m_fds{};
+            array<size_t, HARDWARE_COUNTER_COUNT>       m_slots{}; //!< The position of each counter's value in a group read
+            size_t                                      m_memberCount{0};
+
+            string                                      m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_PERFCOUNTERS_HPP
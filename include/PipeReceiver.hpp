@@ -0,0 +1,301 @@
+/**
+ * @file PipeReceiver.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the receiver used when running as httpd's piped logger, which never lets httpd block on its pipe.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_PIPERECEIVER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_PIPERECEIVER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace httpdreport {
+
+    using std::atomic;
+    using std::condition_variable;
+    using std::deque;
+    using std::mutex;
+    using std::string_view;
+    using std::thread;
+    using std::unique_lock;
+    using std::vector;
+
+    /**
+     * @brief Header-only implementation of the piped-log receiver.
+     *
+     * A dedicated thread drains the pipe with large non-blocking reads and queues the data for the parsing thread.
+     * Draining never waits for parsing: once the queue nears its capacity, the parser only parses every 2nd, 4th or 8th line
+     * and each parsed line stands for the lines skipped (sampling); once the queue is full, whole chunks are dropped. Both are
+     * counted, so reports can state how complete they are.
+     */
+    class PipeReceiver final {
+        public: // +++ Static +++
+            static constexpr size_t CHUNK_SIZE = 1 << 20; //!< The size of each buffer handed to the parser; also the requested pipe capacity
+            static constexpr size_t MAX_QUEUED_CHUNKS = 64; //!< Once this many chunks wait for the parser, new data is dropped
+            static constexpr int32_t POLL_INTERVAL_MS = 100; //!< How long the reader waits for data before re-checking for stop()
+
+        public: // +++ Constructor / Destructor +++
+            explicit PipeReceiver(int fd): m_fd(fd) {}
+            PipeReceiver(const PipeReceiver&) = delete;
+            ~PipeReceiver() { stop(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Makes the descriptor non-blocking and starts draining it.
+             *
+             * @return true If the reader thread was started.
+             */
+            bool start() {
+                const auto flags = fcntl(m_fd, F_GETFL);
+                if (flags < 0 || fcntl(m_fd, F_SETFL, flags | O_NONBLOCK) != 0) { return false; }
+
+                // a larger pipe absorbs bursts; failing (e.g. not a pipe or over the user's limit) is harmless
+                fcntl(m_fd, F_SETPIPE_SZ, static_cast<int>(CHUNK_SIZE));
+
+                m_stopRequested = false;
+                m_reader = thread([this]() { readLoop(); });
+
+                return true;
+            }
+
+            /**
+             * @brief Stops draining the descriptor. Data still queued can be processed with poll(), which returns false once it's done.
+             */
+            void stop() {
+                m_stopRequested = true;
+                if (m_reader.joinable()) { m_reader.join(); }
+            }
+
+            /**
+             * @brief Passes the lines of all queued data to a handler, waiting for data if none is queued.
+             *
+             * @param handler A callable accepting a string_view per line and the number of lines it stands for (the sampling rate).
+             * @param timeout The maximum time to wait for data.
+             *
+             * @return false Once the writer closed the pipe (or stop() was called) and everything was processed; true otherwise.
+             */
+            template<typename LineHandler>
+            bool poll(LineHandler&& handler, std::chrono::milliseconds timeout) {
+                Chunk chunk;
+                size_t queued = 0;
+                {
+                    unique_lock<mutex> lock(m_queueLock);
+                    if (!m_queueChanged.wait_for(lock, timeout, [this]() { return !m_queue.empty() || m_readerDone; })) { return true; }
+                    if (m_queue.empty()) {
+                        // the last line might not have been terminated
+                        if (m_carry > 0) { handleLine(string_view(m_lineBuffer.data(), m_carry), handler); }
+                        m_carry = 0;
+                        return false;
+                    }
+
+                    chunk = std::move(m_queue.front());
+                    m_queue.pop_front();
+                    queued = m_queue.size();
+                }
+
+                m_sampleRate = getSampleRate(queued);
+                processChunk(chunk, handler);
+
+                unique_lock<mutex> lock(m_queueLock);
+                m_freeBuffers.emplace_back(std::move(chunk.data));
+
+                return true;
+            }
+
+            uint64_t getReceivedBytes() const { return m_receivedBytes; } //!< Gets the number of bytes read from the pipe
+            uint64_t getDroppedBytes() const { return m_droppedBytes; } //!< Gets the number of bytes dropped because the queue was full
+            uint64_t getDroppedLines() const { return m_droppedLines; } //!< Gets the number of lines (approximately) dropped because the queue was full
+            uint64_t getSampledOutLines() const { return m_sampledOutLines; } //!< Gets the number of lines skipped by sampling
+            uint32_t getSampleRate() const { return m_sampleRate; } //!< Gets the current sampling rate; 1 in this many lines is parsed
+
+        private: // +++ Private Business +++
+            struct Chunk {
+                vector<char>    data{};
+                bool            followsDrop{false}; //!< Data was dropped before this chunk; its first line is incomplete
+            };
+
+            static uint32_t getSampleRate(size_t queuedChunks) {
+                // a burst the queue can hold is parsed completely; sampling only keeps it from overflowing
+                if (queuedChunks >= MAX_QUEUED_CHUNKS * 15 / 16) { return 8; }
+                if (queuedChunks >= MAX_QUEUED_CHUNKS * 7 / 8) { return 4; }
+                if (queuedChunks >= MAX_QUEUED_CHUNKS * 3 / 4) { return 2; }
+
+                return 1;
+            }
+
+            void readLoop() {
+                Chunk chunk;
+                bool followsDrop = false;
+                while (!m_stopRequested) {
+                    if (chunk.data.capacity() < CHUNK_SIZE) { chunk.data = takeFreeBuffer(); }
+                    chunk.data.resize(CHUNK_SIZE);
+
+                    // fill the chunk as far as the pipe allows without waiting
+                    size_t filled = 0;
+                    bool endOfFile = false;
+                    while (filled < CHUNK_SIZE) {
+                        const auto bytesRead = read(m_fd, chunk.data.data() + filled, CHUNK_SIZE - filled);
+                        if (bytesRead > 0) { filled += static_cast<size_t>(bytesRead); continue; }
+                        if (bytesRead < 0 && errno == EINTR) { continue; }
+
+                        endOfFile = bytesRead == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                        break;
+                    }
+
+                    if (filled > 0) {
+                        chunk.data.resize(filled);
+                        chunk.followsDrop = followsDrop;
+                        m_receivedBytes += filled;
+                        followsDrop = !tryEnqueue(chunk);
+                    }
+
+                    if (endOfFile) { break; }
+
+                    if (filled < CHUNK_SIZE) {
+                        pollfd fd{ m_fd, POLLIN, 0 };
+                        ::poll(&fd, 1, POLL_INTERVAL_MS);
+                    }
+                }
+
+                {
+                    unique_lock<mutex> lock(m_queueLock);
+                    m_readerDone = true;
+                }
+                m_queueChanged.notify_all();
+            }
+
+            /**
+             * @brief Queues a chunk unless the queue is full, in which case the chunk is dropped (and its buffer reused).
+             */
+            bool tryEnqueue(Chunk& chunk) {
+                {
+                    unique_lock<mutex> lock(m_queueLock);
+                    if (m_queue.size() < MAX_QUEUED_CHUNKS) {
+                        m_queue.emplace_back(std::move(chunk));
+                        chunk = Chunk{};
+                        lock.unlock();
+                        m_queueChanged.notify_all();
+                        return true;
+                    }
+                }
+
+                m_droppedBytes += chunk.data.size();
+                m_droppedLines += static_cast<uint64_t>(std::count(chunk.data.begin(), chunk.data.end(), '\n'));
+                return false;
+            }
+
+            vector<char> takeFreeBuffer() {
+                vector<char> buffer;
+                {
+                    unique_lock<mutex> lock(m_queueLock);
+                    if (!m_freeBuffers.empty()) {
+                        buffer = std::move(m_freeBuffers.back());
+                        m_freeBuffers.pop_back();
+                    }
+                }
+
+                buffer.reserve(CHUNK_SIZE);
+                return buffer;
+            }
+
+            template<typename LineHandler>
+            void processChunk(const Chunk& chunk, LineHandler& handler) {
+                const char* lineStart = chunk.data.data();
+                const char* end = lineStart + chunk.data.size();
+
+                if (chunk.followsDrop) {
+                    // neither the carried line nor the start of this chunk form a complete line
+                    m_carry = 0;
+                    const auto* newLine = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+                    if (newLine == nullptr) { return; }
+                    lineStart = newLine + 1;
+                } else if (m_carry > 0) {
+                    // finish the line begun in the previous chunk
+                    const auto* newLine = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+                    const auto* partEnd = newLine != nullptr ? newLine : end;
+                    if (m_lineBuffer.size() < m_carry + (partEnd - lineStart)) { m_lineBuffer.resize(m_carry + (partEnd - lineStart)); }
+                    std::memcpy(m_lineBuffer.data() + m_carry, lineStart, partEnd - lineStart);
+                    m_carry += partEnd - lineStart;
+                    if (newLine == nullptr) { return; }
+
+                    handleLine(string_view(m_lineBuffer.data(), m_carry), handler);
+                    m_carry = 0;
+                    lineStart = newLine + 1;
+                }
+
+                const char* newLine = nullptr;
+                while ((newLine = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart))) != nullptr) {
+                    handleLine(string_view(lineStart, newLine - lineStart), handler);
+                    lineStart = newLine + 1;
+                }
+
+                m_carry = end - lineStart;
+                if (m_carry > 0) {
+                    if (m_lineBuffer.size() < m_carry) { m_lineBuffer.resize(m_carry); }
+                    std::memcpy(m_lineBuffer.data(), lineStart, m_carry);
+                }
+            }
+
+            template<typename LineHandler>
+            void handleLine(string_view line, LineHandler& handler) {
+                if (line.empty()) { return; }
+
+                const uint32_t sampleRate = m_sampleRate;
+                if (sampleRate > 1 && (m_lineCounter++ % sampleRate) != 0) {
+                    m_sampledOutLines++;
+                    return;
+                }
+
+                handler(line, sampleRate);
+            }
+
+        private:
+            int                     m_fd{-1};
+
+            thread                  m_reader{};
+            atomic<bool>            m_stopRequested{false};
+
+            mutex                   m_queueLock{};
+            condition_variable      m_queueChanged{};
+            deque<Chunk>            m_queue{};
+            vector<vector<char>>    m_freeBuffers{};
+            bool                    m_readerDone{false};
+
+            atomic<uint64_t>        m_receivedBytes{0};
+            atomic<uint64_t>        m_droppedBytes{0};
+            atomic<uint64_t>        m_droppedLines{0};
+            atomic<uint64_t>        m_sampledOutLines{0};
+            atomic<uint32_t>        m_sampleRate{1};
+            uint64_t                m_lineCounter{0};
+
+            vector<char>            m_lineBuffer{}; //!< The unfinished last line of the previous chunk
+            size_t                  m_carry{0};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_PIPERECEIVER_HPP
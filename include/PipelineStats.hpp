@@ -0,0 +1,572 @@
+/**
+ * @file PipelineStats.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the per-stage timings of a run and the --stats report rendered from them.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_PIPELINESTATS_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_PIPELINESTATS_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <stdint.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AllocationCounter.hpp"
+#include "PerfCounters.hpp"
+#include "RelaxedCounter.hpp"
+#include "TraceRecorder.hpp"
+
+namespace httpdreport {
+
+    using fmt::format;
+
+    using std::array;
+    using std::string;
+    using std::unique_ptr;
+    using std::vector;
+
+    /**
+     * @brief The stages of the pipeline, in the order in which they're reported.
+     */
+    enum class PipelineStage: uint8_t {
+        DISCOVERY, //!< Searching for and sizing the input files
+        READ, //!< Reading plain files or stdin
+        DECOMPRESS, //!< Reading gzip files; zlib reads and inflates in one call
+        PARSE, //!< Decoding lines in to records
+        AGGREGATE, //!< Adding records to the tables, filtered reports included
+        EXPORT, //!< Writing Arrow, SQLite and snapshot files
+        MERGE, //!< Merging snapshots received from workers
+        RENDER, //!< Rendering the reports
+        STAGE_COUNT
+    };
+
+    /**
+     * @brief The figures of a single stage. Each stage is only ever written by one thread.
+     */
+    struct StageStats final {
+        RelaxedCounter  wallNanos{}; //!< Wall-clock time of the calls timed with a Timer
+        RelaxedCounter  cpuNanos{}; //!< CPU time of the calls timed with a Timer
+        RelaxedCounter  calls{}; //!< Calls timed with a Timer
+        RelaxedCounter  sampledNanos{}; //!< Wall-clock time of the sampled calls which were timed
+        RelaxedCounter  sampledCalls{}; //!< All sampled calls, timed or not
+        RelaxedCounter  sampledTimedCalls{}; //!< Sampled calls which were timed
+        RelaxedCounter  bytes{}; //!< Bytes processed
+        RelaxedCounter  items{}; //!< Lines, records or files processed
+
+        array<RelaxedCounter, HARDWARE_COUNTER_COUNT>   counters{}; //!< Hardware events of the calls timed with a Timer
+        array<RelaxedCounter, HARDWARE_COUNTER_COUNT>   sampledCounters{}; //!< Hardware events of the sampled calls which were timed
+    };
+
+    /**
+     * @brief Header-only implementation of the --stats instrumentation.
+     *
+     * Coarse stages (reading a chunk, rendering a report) are timed on every call, with both the wall clock and the thread's CPU
+     * clock, so time spent waiting for the disk shows as CPU usage below 100%. Parsing and aggregating are timed per line, which
+     * would cost more than the work itself; only every SAMPLE_INTERVAL-th line is timed (wall clock only: neither stage ever
+     * blocks) and the totals are extrapolated from the sample.
+     *
+     * With enableCounters(), every timed call also reads the calling thread's hardware counters (see PerfCounterGroup), which
+     * adds two read() calls per timed call; the sampled stages' counters are extrapolated like their time.
+     */
+    class PipelineStats final {
+        public: // +++ Static +++
+            static constexpr uint64_t SAMPLE_INTERVAL = 32; //!< One in this many lines is timed
+
+            /**
+             * @brief Gets the names of the stages, as used in both the text and the JSON output.
+             */
+            static const char* getStageName(PipelineStage stage) {
+                static constexpr const char* NAMES[] = { "discovery", "read", "decompress", "parse", "aggregate", "export", "merge", "render" };
+                return NAMES[static_cast<size_t>(stage)];
+            }
+
+            static uint64_t getWallNanos() { return clockNanos(CLOCK_MONOTONIC); } //!< Gets the monotonic clock in nanoseconds
+            static uint64_t getThreadCpuNanos() { return clockNanos(CLOCK_THREAD_CPUTIME_ID); } //!< Gets the calling thread's CPU time in nanoseconds
+
+        public: // +++ Constructor / Destructor +++
+            PipelineStats(): m_id(s_nextId.fetch_add(1) + 1), m_startWallNanos(getWallNanos()), m_startCpuNanos(getProcessCpuNanos()) {
+                AllocationCounter::enable();
+                m_startAllocations = AllocationCounter::getAllocations();
+                m_startAllocatedBytes = AllocationCounter::getAllocatedBytes();
+                for (size_t i = 0; i < ALLOCATION_TAG_COUNT; i++) {
+                    m_startTagAllocations[i] = AllocationCounter::getAllocations(static_cast<AllocationTag>(i));
+                    m_startTagBytes[i] = AllocationCounter::getAllocatedBytes(static_cast<AllocationTag>(i));
+                }
+            }
+            PipelineStats(const PipelineStats&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Times a call of a stage from its construction until stop() or its destruction, whichever comes first.
+             * With a trace attached, the call is recorded there, too.
+             */
+            class Timer final {
+                public:
+                    Timer(PipelineStats* stats, PipelineStage stage): m_stats(stats), m_stage(stage) {
+                        if (m_stats == nullptr) { return; }
+
+                        m_counting = m_stats->readCounters(m_startCounters);
+                        m_startWall = getWallNanos();
+                        m_startCpu = getThreadCpuNanos();
+                    }
+                    Timer(const Timer&) = delete;
+                    ~Timer() { stop(); }
+
+                    /**
+                     * @brief Stops timing and books the call with the bytes and items it processed.
+                     */
+                    void stop(uint64_t bytes = 0, uint64_t items = 0) {
+                        if (m_stats == nullptr) { return; }
+
+                        const auto endWall = getWallNanos();
+                        m_stats->addCall(m_stage, endWall - m_startWall, getThreadCpuNanos() - m_startCpu, bytes, items);
+                        if (auto* trace = m_stats->getTrace(); trace != nullptr) { trace->record(getStageName(m_stage), m_startWall, endWall, bytes, items); }
+
+                        CounterValues endCounters{};
+                        if (m_counting && m_stats->readCounters(endCounters)) { m_stats->addCounters(m_stage, m_startCounters, endCounters, false); }
+                        m_stats = nullptr;
+                    }
+
+                private:
+                    PipelineStats*  m_stats{nullptr}; //!< nullptr if statistics are disabled or the timer was stopped
+                    PipelineStage   m_stage{PipelineStage::READ};
+                    uint64_t        m_startWall{0};
+                    uint64_t        m_startCpu{0};
+                    bool            m_counting{false}; //!< Whether or not m_startCounters holds a reading
+                    CounterValues   m_startCounters{};
+            };
+
+            /**
+             * @brief Books consecutive per-line steps to sampled stages; only one in SAMPLE_INTERVAL lines is timed.
+             */
+            class Sampler final {
+                public:
+                    explicit Sampler(PipelineStats* stats): m_stats(stats), m_timed(stats != nullptr && stats->shouldSample()) {
+                        if (!m_timed) { return; }
+
+                        m_counting = m_stats->readCounters(m_startCounters);
+                        m_start = getWallNanos();
+                    }
+                    Sampler(const Sampler&) = delete;
+
+                    /**
+                     * @brief Books the work since the construction (or the previous lap) to a stage.
+                     */
+                    void lap(PipelineStage stage, uint64_t bytes, uint64_t items) {
+                        if (m_stats == nullptr) { return; }
+                        if (!m_timed) {
+                            m_stats->addSampledCall(stage, bytes, items, false);
+                            return;
+                        }
+
+                        const auto now = getWallNanos();
+                        m_stats->addSampledCall(stage, bytes, items, true, now - m_start);
+
+                        if (m_counting) {
+                            CounterValues counters{};
+                            if (m_stats->readCounters(counters)) { m_stats->addCounters(stage, m_startCounters, counters, true); }
+
+                            // the next lap starts here, so booking this one isn't counted towards it
+                            m_counting = m_stats->readCounters(m_startCounters);
+                        }
+                        m_start = getWallNanos();
+                    }
+
+                private:
+                    PipelineStats*  m_stats{nullptr};
+                    bool            m_timed{false};
+                    bool            m_counting{false};
+                    uint64_t        m_start{0};
+                    CounterValues   m_startCounters{};
+            };
+
+            void setTrace(TraceRecorder* trace) { m_trace = trace; } //!< Records every timed call in the given trace; nullptr disables tracing
+            TraceRecorder* getTrace() const { return m_trace; } //!< Gets the trace timed calls are recorded in; nullptr if there is none
+
+            /**
+             * @brief Books a timed call of a stage.
+             */
+            void addCall(PipelineStage stage, uint64_t wallNanos, uint64_t cpuNanos, uint64_t bytes, uint64_t items) {
+                auto& stats = m_stages[static_cast<size_t>(stage)];
+                stats.wallNanos.add(wallNanos);
+                stats.cpuNanos.add(cpuNanos);
+                stats.calls.add(1);
+                stats.bytes.add(bytes);
+                stats.items.add(items);
+            }
+
+            /**
+             * @brief Books a call of a sampled stage; wallNanos is only given for sampled calls (see shouldSample()).
+             */
+            void addSampledCall(PipelineStage stage, uint64_t bytes, uint64_t items, bool timed, uint64_t wallNanos = 0) {
+                auto& stats = m_stages[static_cast<size_t>(stage)];
+                stats.sampledCalls.add(1);
+                stats.bytes.add(bytes);
+                stats.items.add(items);
+                if (!timed) { return; }
+
+                stats.sampledNanos.add(wallNanos);
+                stats.sampledTimedCalls.add(1);
+            }
+
+            /**
+             * @brief Starts reading hardware counters on every timed call. Each thread opens its own counters on its first call.
+             *
+             * @return true If the calling thread's counters could be opened. Otherwise the statistics say why they're missing.
+             */
+            bool enableCounters() {
+                auto& thread = getThreadCounters();
+                if (!thread.group.isOpen()) {
+                    m_countersError = thread.group.getLastError();
+                    return false;
+                }
+
+                for (size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) { m_countersAvailable[i] = thread.group.has(static_cast<HardwareCounter>(i)); }
+                m_countersEnabled.store(true, std::memory_order_relaxed);
+
+                return true;
+            }
+
+            /**
+             * @brief Reads the calling thread's hardware counters.
+             *
+             * @return false If counters are disabled or couldn't be opened for this thread.
+             */
+            bool readCounters(CounterValues& values) {
+                if (!m_countersEnabled.load(std::memory_order_relaxed)) { return false; }
+
+                return getThreadCounters().group.read(values);
+            }
+
+            /**
+             * @brief Books the hardware events between two readings to a stage.
+             */
+            void addCounters(PipelineStage stage, const CounterValues& start, const CounterValues& end, bool sampled) {
+                auto& stats = m_stages[static_cast<size_t>(stage)];
+                auto& counters = sampled ? stats.sampledCounters : stats.counters;
+                for (size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) { counters[i].add(end[i] > start[i] ? end[i] - start[i] : 0); }
+            }
+
+            /**
+             * @brief Gets a value indicating whether or not the next line shall be timed.
+             */
+            bool shouldSample() { return m_lineCounter++ % SAMPLE_INTERVAL == 0; }
+
+            const StageStats& getStage(PipelineStage stage) const { return m_stages[static_cast<size_t>(stage)]; } //!< Gets the figures of a stage
+
+            /**
+             * @brief Renders a table with a row per stage that ran and the totals of the run so far.
+             */
+            string toText() const {
+                const auto totals = getTotals();
+                auto text = format(
+                    "Pipeline statistics: {0:.3f} s wall, {1:.3f} s CPU ({2:.0f}%), peak RSS {3:.1f} MiB, {4:d} allocations ({5:.1f} MiB)\n",
+                    totals.wallSeconds, totals.cpuSeconds, percentOf(totals.cpuSeconds, totals.wallSeconds), totals.peakRssBytes / 1048576.0,
+                    totals.allocations, totals.allocatedBytes / 1048576.0
+                );
+                text += "Allocations by subsystem:";
+                for (size_t i = 0; i < ALLOCATION_TAG_COUNT; i++) {
+                    const auto allocations = AllocationCounter::getAllocations(static_cast<AllocationTag>(i)) - m_startTagAllocations[i];
+                    const auto bytes = AllocationCounter::getAllocatedBytes(static_cast<AllocationTag>(i)) - m_startTagBytes[i];
+                    text += format(" {0:s} {1:d} ({2:.1f} MiB){3:s}", AllocationCounter::getTagName(static_cast<AllocationTag>(i)), allocations, bytes / 1048576.0, i + 1 < ALLOCATION_TAG_COUNT ? "," : "\n");
+                }
+                text += format("{0:<12s} {1:>10s} {2:>10s} {3:>6s} {4:>12s} {5:>12s} {6:>10s} {7:>12s}\n", "stage", "wall s", "cpu s", "cpu%", "calls", "items", "MiB/s", "M items/s");
+
+                double stageSeconds = 0;
+                for (size_t i = 0; i < m_stages.size(); i++) {
+                    const auto stage = static_cast<PipelineStage>(i);
+                    const auto& stats = m_stages[i];
+                    if (getCalls(stats) == 0) { continue; }
+
+                    const auto wallSeconds = getWallSeconds(stats);
+                    const auto cpuSeconds = getCpuSeconds(stats);
+                    stageSeconds += wallSeconds;
+                    text += format(
+                        "{0:<12s} {1:>10.3f} {2:>10.3f} {3:>6.0f} {4:>12d} {5:>12d} {6:>10.1f} {7:>12.2f}{8:s}\n",
+                        getStageName(stage), wallSeconds, cpuSeconds, percentOf(cpuSeconds, wallSeconds), getCalls(stats), stats.items.get(),
+                        perSecond(static_cast<double>(stats.bytes.get()) / 1048576.0, wallSeconds), perSecond(static_cast<double>(stats.items.get()) / 1e6, wallSeconds),
+                        isSampled(stats) ? "  (sampled)" : ""
+                    );
+                }
+
+                // line splitting, filtering and the instrumentation itself
+                text += format("{0:<12s} {1:>10.3f}\n", "other", std::max(0.0, totals.wallSeconds - stageSeconds));
+
+                if (!m_countersError.empty()) { text += format("Hardware counters unavailable: {0:s}\n", m_countersError); }
+                if (m_countersEnabled.load(std::memory_order_relaxed)) { text += countersToText(); }
+
+                return text;
+            }
+
+            /**
+             * @brief Renders the same figures as toText() as a single JSON object, for comparing runs with scripts.
+             */
+            string toJson() const {
+                const auto totals = getTotals();
+                auto json = format(
+                    R"({{"wall_seconds":{0:.6f},"cpu_seconds":{1:.6f},"peak_rss_bytes":{2:.0f},"allocations":{3:d},"allocated_bytes":{4:d},"allocations_by_subsystem":{{)",
+                    totals.wallSeconds, totals.cpuSeconds, totals.peakRssBytes, totals.allocations, totals.allocatedBytes
+                );
+                for (size_t i = 0; i < ALLOCATION_TAG_COUNT; i++) {
+                    json += format(
+                        R"({0:s}"{1:s}":{{"allocations":{2:d},"bytes":{3:d}}})", i == 0 ? "" : ",", AllocationCounter::getTagName(static_cast<AllocationTag>(i)),
+                        AllocationCounter::getAllocations(static_cast<AllocationTag>(i)) - m_startTagAllocations[i],
+                        AllocationCounter::getAllocatedBytes(static_cast<AllocationTag>(i)) - m_startTagBytes[i]
+                    );
+                }
+                json += R"(},"stages":[)";
+
+                bool first = true;
+                for (size_t i = 0; i < m_stages.size(); i++) {
+                    const auto& stats = m_stages[i];
+                    if (getCalls(stats) == 0) { continue; }
+
+                    const auto wallSeconds = getWallSeconds(stats);
+                    json += format(
+                        R"({0:s}{{"name":"{1:s}","wall_seconds":{2:.6f},"cpu_seconds":{3:.6f},"calls":{4:d},"bytes":{5:d},"items":{6:d},"bytes_per_second":{7:.0f},"items_per_second":{8:.0f},"sampled":{9:s}}})",
+                        first ? "" : ",", getStageName(static_cast<PipelineStage>(i)), wallSeconds, getCpuSeconds(stats), getCalls(stats), stats.bytes.get(),
+                        stats.items.get(), perSecond(static_cast<double>(stats.bytes.get()), wallSeconds), perSecond(static_cast<double>(stats.items.get()), wallSeconds),
+                        isSampled(stats) ? "true" : "false"
+                    );
+                    if (m_countersEnabled.load(std::memory_order_relaxed)) { json.insert(json.size() - 1, R"(,"counters":)" + countersToJson(getCounters(stats))); }
+                    first = false;
+                }
+                json += "]";
+
+                if (!m_countersError.empty()) { json += format(R"(,"counters_error":"{0:s}")", m_countersError); }
+                if (m_countersEnabled.load(std::memory_order_relaxed)) {
+                    json += R"(,"threads":[)";
+                    const auto threads = getThreadReadings();
+                    for (size_t i = 0; i < threads.size(); i++) {
+                        json += format(R"({0:s}{{"thread_id":{1:d},"counters":{2:s}}})", i == 0 ? "" : ",", threads[i].first, countersToJson(threads[i].second));
+                    }
+                    json += "]";
+                }
+
+                return json + "}\n";
+            }
+
+        private: // +++ Private Business +++
+            struct ThreadCounters {
+                uint32_t            threadId{0};
+                PerfCounterGroup    group{};
+            };
+
+            /**
+             * @brief Gets the calling thread's counters, opening them on the thread's first call; only that takes the lock.
+             */
+            ThreadCounters& getThreadCounters() {
+                thread_local uint64_t t_statsId = 0;
+                thread_local ThreadCounters* t_counters = nullptr;
+                if (t_statsId == m_id) { return *t_counters; }
+
+                auto counters = std::make_unique<ThreadCounters>();
+                counters->threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+                counters->group.open();
+
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_threads.push_back(std::move(counters));
+                t_statsId = m_id;
+                t_counters = m_threads.back().get();
+
+                return *t_counters;
+            }
+
+            /**
+             * @brief Reads the counters of every thread; they count everything the thread did, the time between stages included.
+             */
+            vector<std::pair<uint32_t, array<double, HARDWARE_COUNTER_COUNT>>> getThreadReadings() const {
+                vector<std::pair<uint32_t, array<double, HARDWARE_COUNTER_COUNT>>> readings;
+
+                std::lock_guard<std::mutex> guard(m_lock);
+                for (const auto& thread : m_threads) {
+                    CounterValues values{};
+                    if (!thread->group.read(values)) { continue; }
+
+                    readings.emplace_back(thread->threadId, array<double, HARDWARE_COUNTER_COUNT>{});
+                    for (size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) { readings.back().second[i] = static_cast<double>(values[i]); }
+                }
+
+                return readings;
+            }
+
+            /**
+             * @brief Gets a stage's hardware events, with those of the sampled calls scaled up like their time.
+             */
+            static array<double, HARDWARE_COUNTER_COUNT> getCounters(const StageStats& stats) {
+                const auto timedCalls = stats.sampledTimedCalls.get();
+                const auto scale = timedCalls > 0 ? static_cast<double>(stats.sampledCalls.get()) / static_cast<double>(timedCalls) : 0.0;
+
+                array<double, HARDWARE_COUNTER_COUNT> counters{};
+                for (size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+                    counters[i] = static_cast<double>(stats.counters[i].get()) + static_cast<double>(stats.sampledCounters[i].get()) * scale;
+                }
+
+                return counters;
+            }
+
+            string countersToText() const {
+                static constexpr auto CYCLES = static_cast<size_t>(HardwareCounter::CYCLES);
+                static constexpr auto INSTRUCTIONS = static_cast<size_t>(HardwareCounter::INSTRUCTIONS);
+                static constexpr auto CACHE_MISSES = static_cast<size_t>(HardwareCounter::CACHE_MISSES);
+                static constexpr auto BRANCH_MISSES = static_cast<size_t>(HardwareCounter::BRANCH_MISSES);
+
+                auto text = format(
+                    "Hardware counters (user space only):\n{0:<12s} {1:>10s} {2:>10s} {3:>6s} {4:>9s} {5:>11s} {6:>13s} {7:>13s}\n",
+                    "stage", "M cycles", "M instr", "IPC", "cycles/B", "cycles/item", "LLC miss/item", "br miss/item"
+                );
+                for (size_t i = 0; i < m_stages.size(); i++) {
+                    const auto& stats = m_stages[i];
+                    if (getCalls(stats) == 0) { continue; }
+
+                    const auto counters = getCounters(stats);
+                    const auto bytes = static_cast<double>(stats.bytes.get());
+                    const auto items = static_cast<double>(stats.items.get());
+                    text += format(
+                        "{0:<12s} {1:>10s} {2:>10s} {3:>6s} {4:>9s} {5:>11s} {6:>13s} {7:>13s}\n", getStageName(static_cast<PipelineStage>(i)),
+                        formatCounter(counters, CYCLES, 1e6, 1), formatCounter(counters, INSTRUCTIONS, 1e6, 1),
+                        m_countersAvailable[CYCLES] ? formatCounter(counters, INSTRUCTIONS, counters[CYCLES], 2) : "-",
+                        formatCounter(counters, CYCLES, bytes, 2), formatCounter(counters, CYCLES, items, 0),
+                        formatCounter(counters, CACHE_MISSES, items, 3), formatCounter(counters, BRANCH_MISSES, items, 3)
+                    );
+                }
+
+                text += format("{0:<12s} {1:>10s} {2:>10s} {3:>6s} {4:>13s} {5:>13s}\n", "thread", "M cycles", "M instr", "IPC", "M LLC misses", "M br misses");
+                for (const auto& thread : getThreadReadings()) {
+                    const auto& counters = thread.second;
+                    text += format(
+                        "{0:<12d} {1:>10s} {2:>10s} {3:>6s} {4:>13s} {5:>13s}\n", thread.first,
+                        formatCounter(counters, CYCLES, 1e6, 1), formatCounter(counters, INSTRUCTIONS, 1e6, 1),
+                        m_countersAvailable[CYCLES] ? formatCounter(counters, INSTRUCTIONS, counters[CYCLES], 2) : "-",
+                        formatCounter(counters, CACHE_MISSES, 1e6, 3), formatCounter(counters, BRANCH_MISSES, 1e6, 3)
+                    );
+                }
+
+                return text;
+            }
+
+            /**
+             * @brief Formats a counter divided by another figure; "-" if the counter isn't available or the divisor is 0.
+             */
+            string formatCounter(const array<double, HARDWARE_COUNTER_COUNT>& counters, size_t counter, double divisor, int precision) const {
+                if (!m_countersAvailable[counter] || divisor <= 0) { return "-"; }
+
+                return format("{0:.{1}f}", counters[counter] / divisor, precision);
+            }
+
+            string countersToJson(const array<double, HARDWARE_COUNTER_COUNT>& counters) const {
+                string json = "{";
+                for (size_t i = 0; i < HARDWARE_COUNTER_COUNT; i++) {
+                    json += format(
+                        R"({0:s}"{1:s}":{2:s})", i == 0 ? "" : ",", PerfCounterGroup::getCounterName(static_cast<HardwareCounter>(i)),
+                        m_countersAvailable[i] ? format("{0:.0f}", counters[i]) : "null"
+                    );
+                }
+
+                return json + "}";
+            }
+
+            struct Totals {
+                double      wallSeconds{0};
+                double      cpuSeconds{0};
+                double      peakRssBytes{0};
+                uint64_t    allocations{0};
+                uint64_t    allocatedBytes{0};
+            };
+
+            Totals getTotals() const {
+                rusage usage{};
+                getrusage(RUSAGE_SELF, &usage);
+
+                Totals totals;
+                totals.wallSeconds = static_cast<double>(getWallNanos() - m_startWallNanos) / 1e9;
+                totals.cpuSeconds = static_cast<double>(getProcessCpuNanos() - m_startCpuNanos) / 1e9;
+                totals.peakRssBytes = static_cast<double>(usage.ru_maxrss) * 1024.0;
+                totals.allocations = AllocationCounter::getAllocations() - m_startAllocations;
+                totals.allocatedBytes = AllocationCounter::getAllocatedBytes() - m_startAllocatedBytes;
+
+                return totals;
+            }
+
+            static uint64_t clockNanos(clockid_t clock) {
+                timespec time{};
+                clock_gettime(clock, &time);
+
+                return static_cast<uint64_t>(time.tv_sec) * 1000000000ull + static_cast<uint64_t>(time.tv_nsec);
+            }
+
+            static uint64_t getProcessCpuNanos() { return clockNanos(CLOCK_PROCESS_CPUTIME_ID); }
+
+            static bool isSampled(const StageStats& stats) { return stats.sampledCalls.get() > 0; }
+            static uint64_t getCalls(const StageStats& stats) { return stats.calls.get() + stats.sampledCalls.get(); }
+
+            /**
+             * @brief Scales the time of the timed sampled calls up to all sampled calls.
+             */
+            static double extrapolateSample(const StageStats& stats) {
+                const auto timedCalls = stats.sampledTimedCalls.get();
+                if (timedCalls == 0) { return 0; }
+
+                return static_cast<double>(stats.sampledNanos.get()) / 1e9 * static_cast<double>(stats.sampledCalls.get()) / static_cast<double>(timedCalls);
+            }
+
+            // sampled calls never block, so their CPU time is their wall-clock time
+            static double getWallSeconds(const StageStats& stats) { return static_cast<double>(stats.wallNanos.get()) / 1e9 + extrapolateSample(stats); }
+            static double getCpuSeconds(const StageStats& stats) { return static_cast<double>(stats.cpuNanos.get()) / 1e9 + extrapolateSample(stats); }
+
+            static double perSecond(double amount, double seconds) { return seconds > 0 ? amount / seconds : 0.0; }
+            static double percentOf(double part, double whole) { return whole > 0 ? 100.0 * part / whole : 0.0; }
+
+        private:
+            static inline std::atomic<uint64_t>    s_nextId{0}; //!< Tells the counters of an instance apart from those of its predecessors
+
+            array<StageStats, static_cast<size_t>(PipelineStage::STAGE_COUNT)>  m_stages{};
+
+            const uint64_t  m_id{0};
+
+            uint64_t    m_startWallNanos{0};
+            uint64_t    m_startCpuNanos{0};
+            uint64_t    m_startAllocations{0};
+            uint64_t    m_startAllocatedBytes{0};
+            array<uint64_t, ALLOCATION_TAG_COUNT>   m_startTagAllocations{};
+            array<uint64_t, ALLOCATION_TAG_COUNT>   m_startTagBytes{};
+            uint64_t    m_lineCounter{0}; //!< Drives shouldSample()
+
+            TraceRecorder*  m_trace{nullptr};
+
+            std::atomic<bool>                       m_countersEnabled{false};
+            array<bool, HARDWARE_COUNTER_COUNT>     m_countersAvailable{};
+            string                                  m_countersError{}; //!< Why enableCounters() failed
+            mutable std::mutex                      m_lock{}; //!< Guards m_threads
+            vector<unique_ptr<ThreadCounters>>      m_threads{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_PIPELINESTATS_HPP
@@ -0,0 +1,129 @@
+/**
+ * @file Probes.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the USDT probes of the pipeline, which bpftrace, perf and SystemTap can attach to in a running process.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_PROBES_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_PROBES_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <type_traits>
+
+// libc
+#include <stdint.h>
+
+/**
+ * Probes of the provider "httpdreport"; every argument is a 64-bit value, pointers included:
+ *
+ *     file_open(path, fd)                  a log file was opened for reading
+ *     file_close(path, success)            it was read to its end (or failed)
+ *     chunk_dispatch(bytes)                a chunk is handed to the line handler
+ *     parse_batch(bytes, lines)            the chunk's lines were parsed and aggregated
+ *     reject(line, length)                 a line was malformed
+ *     range_dispatch(id, start, end, path) the coordinator handed a byte range to a worker
+ *     table_resize(table, old_buckets, new_buckets, entries)
+ *     merge_start(requests, clients)       tables (or a snapshot) start being merged in to tables of this size
+ *     merge_end(requests, clients)         the merge is done; the size of the tables merged in to
+ *     report_write(fd, bytes, success)     a report was written; bytes before compression
+ *
+ * e.g. bpftrace -e 'usdt:./httpd-hit-report:httpdreport:reject { printf("%s\n", str(arg0, arg1)); }' -p $(pidof httpd-hit-report)
+ *
+ * A probe is a single nop plus an ELF note naming it and where its arguments are; a tracer attaching replaces the nop with a
+ * breakpoint. Until then the arguments, which every probe site has at hand anyway, are all it costs. sys/sdt.h is used if it
+ * is installed; otherwise the note is emitted the same way here, for x86-64 and AArch64. Building with HTTPDREPORT_NO_PROBES
+ * (-DHTTPDREPORT_PROBES=OFF) compiles the probes out.
+ */
+
+#if defined(HTTPDREPORT_NO_PROBES)
+    #define HTTPDREPORT_PROBE0(name) do {} while (false)
+    #define HTTPDREPORT_PROBE1(name, a0) do {} while (false)
+    #define HTTPDREPORT_PROBE2(name, a0, a1) do {} while (false)
+    #define HTTPDREPORT_PROBE3(name, a0, a1, a2) do {} while (false)
+    #define HTTPDREPORT_PROBE4(name, a0, a1, a2, a3) do {} while (false)
+#elif __has_include(<sys/sdt.h>)
+    #include <sys/sdt.h>
+
+    #define HTTPDREPORT_PROBE0(name) DTRACE_PROBE(httpdreport, name)
+    #define HTTPDREPORT_PROBE1(name, a0) DTRACE_PROBE1(httpdreport, name, httpdreport::probes::toArgument(a0))
+    #define HTTPDREPORT_PROBE2(name, a0, a1) \
+        DTRACE_PROBE2(httpdreport, name, httpdreport::probes::toArgument(a0), httpdreport::probes::toArgument(a1))
+    #define HTTPDREPORT_PROBE3(name, a0, a1, a2) \
+        DTRACE_PROBE3(httpdreport, name, httpdreport::probes::toArgument(a0), httpdreport::probes::toArgument(a1), httpdreport::probes::toArgument(a2))
+    #define HTTPDREPORT_PROBE4(name, a0, a1, a2, a3) \
+        DTRACE_PROBE4(httpdreport, name, httpdreport::probes::toArgument(a0), httpdreport::probes::toArgument(a1), httpdreport::probes::toArgument(a2), \
+            httpdreport::probes::toArgument(a3))
+#elif defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__))
+    // the layout of the note is the one sys/sdt.h emits, version 3
+    #define HTTPDREPORT_PROBE_NOTE(name, arguments, ...) \
+        __asm__ __volatile__( \
+            "990: nop\n" \
+            ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+            ".balign 4\n" \
+            ".4byte 992f-991f, 994f-993f, 3\n" \
+            "991: .asciz \"stapsdt\"\n" \
+            "992: .balign 4\n" \
+            "993: .8byte 990b\n" \
+            ".8byte _.stapsdt.base\n" \
+            ".8byte 0\n" \
+            ".asciz \"httpdreport\"\n" \
+            ".asciz \"" #name "\"\n" \
+            ".asciz \"" arguments "\"\n" \
+            "994: .balign 4\n" \
+            ".popsection\n" \
+            ".ifndef _.stapsdt.base\n" \
+            ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+            ".weak _.stapsdt.base\n" \
+            ".hidden _.stapsdt.base\n" \
+            "_.stapsdt.base: .space 1\n" \
+            ".size _.stapsdt.base, 1\n" \
+            ".popsection\n" \
+            ".endif\n" \
+            :: __VA_ARGS__ \
+        )
+
+    #define HTTPDREPORT_PROBE_ARGUMENT(index, value) [a##index] "nor" (httpdreport::probes::toArgument(value))
+
+    #define HTTPDREPORT_PROBE0(name) HTTPDREPORT_PROBE_NOTE(name, "")
+    #define HTTPDREPORT_PROBE1(name, a0) HTTPDREPORT_PROBE_NOTE(name, "8@%[a0]", HTTPDREPORT_PROBE_ARGUMENT(0, a0))
+    #define HTTPDREPORT_PROBE2(name, a0, a1) \
+        HTTPDREPORT_PROBE_NOTE(name, "8@%[a0] 8@%[a1]", HTTPDREPORT_PROBE_ARGUMENT(0, a0), HTTPDREPORT_PROBE_ARGUMENT(1, a1))
+    #define HTTPDREPORT_PROBE3(name, a0, a1, a2) \
+        HTTPDREPORT_PROBE_NOTE(name, "8@%[a0] 8@%[a1] 8@%[a2]", HTTPDREPORT_PROBE_ARGUMENT(0, a0), HTTPDREPORT_PROBE_ARGUMENT(1, a1), \
+            HTTPDREPORT_PROBE_ARGUMENT(2, a2))
+    #define HTTPDREPORT_PROBE4(name, a0, a1, a2, a3) \
+        HTTPDREPORT_PROBE_NOTE(name, "8@%[a0] 8@%[a1] 8@%[a2] 8@%[a3]", HTTPDREPORT_PROBE_ARGUMENT(0, a0), HTTPDREPORT_PROBE_ARGUMENT(1, a1), \
+            HTTPDREPORT_PROBE_ARGUMENT(2, a2), HTTPDREPORT_PROBE_ARGUMENT(3, a3))
+#else
+    #define HTTPDREPORT_PROBE0(name) do {} while (false)
+    #define HTTPDREPORT_PROBE1(name, a0) do {} while (false)
+    #define HTTPDREPORT_PROBE2(name, a0, a1) do {} while (false)
+    #define HTTPDREPORT_PROBE3(name, a0, a1, a2) do {} while (false)
+    #define HTTPDREPORT_PROBE4(name, a0, a1, a2, a3) do {} while (false)
+#endif
+
+namespace httpdreport::probes {
+
+    /**
+     * @brief Widens a probe argument to the 64 bits every probe argument has; pointers become their address.
+     */
+    template<typename T>
+    inline uint64_t toArgument(T value) {
+        if constexpr (std::is_pointer_v<T>) {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+        } else {
+            return static_cast<uint64_t>(value);
+        }
+    }
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_PROBES_HPP
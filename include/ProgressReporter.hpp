@@ -0,0 +1,206 @@
+/**
+ * @file ProgressReporter.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the pipeline's progress counters and the status line drawn from them on a terminal.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_PROGRESSREPORTER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_PROGRESSREPORTER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <stdint.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "RelaxedCounter.hpp"
+
+namespace httpdreport {
+
+    using fmt::format;
+
+    using std::atomic;
+    using std::condition_variable;
+    using std::mutex;
+    using std::string;
+    using std::thread;
+    using std::unique_lock;
+
+    /**
+     * @brief The counters of a run. The reading thread writes them; any thread may read them at any time.
+     */
+    struct PipelineProgress final {
+        RelaxedCounter      inputBytes{}; //!< Bytes read from the inputs; compressed bytes for gzip files
+        RelaxedCounter      decodedBytes{}; //!< Bytes split in to lines, i.e. after decompression
+        RelaxedCounter      lines{}; //!< Lines parsed, including rejected ones
+        RelaxedCounter      rejectedLines{}; //!< Malformed lines
+        RelaxedCounter      filesDone{}; //!< Files read completely (or given up on)
+
+        atomic<uint64_t>    totalInputBytes{0}; //!< The size of all inputs on disk; 0 if unknown, e.g. for stdin
+        atomic<uint64_t>    totalFiles{0}; //!< The number of files to read
+    };
+
+    /**
+     * @brief Header-only implementation of the progress line.
+     *
+     * While running on a terminal, a single line on stderr is redrawn every UPDATE_INTERVAL_MS with the files done, the
+     * bytes read, throughput, the estimated time left and the process's CPU usage. A CPU usage well below 100% while the
+     * throughput is low means the run waits for I/O; a usage near 100% means parsing is the bottleneck.
+     */
+    class ProgressReporter final {
+        public: // +++ Static +++
+            static constexpr int32_t UPDATE_INTERVAL_MS = 1000; //!< How often the line is redrawn
+
+        public: // +++ Constructor / Destructor +++
+            explicit ProgressReporter(const PipelineProgress& progress): m_progress(progress), m_startTime(std::chrono::steady_clock::now()), m_lastTime(m_startTime) {
+                m_lastCpuSeconds = getCpuSeconds();
+            }
+            ProgressReporter(const ProgressReporter&) = delete;
+            ~ProgressReporter() { stop(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Starts redrawing the progress line, if stderr is a terminal.
+             */
+            void start() {
+                if (!isatty(STDERR_FILENO) || m_worker.joinable()) { return; }
+
+                m_stopRequested = false;
+                m_worker = thread([this]() {
+                    while (true) {
+                        {
+                            unique_lock<mutex> lock(m_lock);
+                            if (m_wakeUp.wait_for(lock, std::chrono::milliseconds(UPDATE_INTERVAL_MS), [this]() { return m_stopRequested; })) { return; }
+                        }
+
+                        const auto line = describe();
+                        std::fprintf(stderr, "\r%s\033[K", line.c_str());
+                        std::fflush(stderr);
+                    }
+                });
+            }
+
+            /**
+             * @brief Stops redrawing and clears the line, so later messages start on an empty line.
+             */
+            void stop() {
+                if (!m_worker.joinable()) { return; }
+
+                {
+                    unique_lock<mutex> lock(m_lock);
+                    m_stopRequested = true;
+                }
+                m_wakeUp.notify_all();
+                m_worker.join();
+
+                std::fprintf(stderr, "\r\033[K");
+                std::fflush(stderr);
+            }
+
+            /**
+             * @brief Prints a message on a line of its own, even while the progress line is shown.
+             */
+            void printMessage(const string& message) {
+                unique_lock<mutex> lock(m_describeLock);
+                std::fprintf(stderr, "%s%s\n", m_worker.joinable() ? "\r\033[K" : "", message.c_str());
+                std::fflush(stderr);
+            }
+
+            /**
+             * @brief Describes the progress in a single line, e.g. for a SIGUSR1 dump. CPU usage covers the time since the last call.
+             */
+            string describe() {
+                unique_lock<mutex> lock(m_describeLock);
+                const auto now = std::chrono::steady_clock::now();
+                const auto elapsed = std::chrono::duration<double>(now - m_startTime).count();
+                const auto sinceLast = std::chrono::duration<double>(now - m_lastTime).count();
+                const auto cpuSeconds = getCpuSeconds();
+                const auto cpuUsage = sinceLast > 0 ? 100.0 * (cpuSeconds - m_lastCpuSeconds) / sinceLast : 0.0;
+                m_lastTime = now;
+                m_lastCpuSeconds = cpuSeconds;
+
+                const auto inputBytes = m_progress.inputBytes.get();
+                const auto decodedBytes = m_progress.decodedBytes.get();
+                const auto totalBytes = m_progress.totalInputBytes.load(std::memory_order_relaxed);
+                const auto bytesPerSecond = elapsed > 0 ? static_cast<double>(inputBytes) / elapsed : 0.0;
+
+                auto line = format("{0:d}/{1:d} files | {2:s}", m_progress.filesDone.get(), m_progress.totalFiles.load(std::memory_order_relaxed), formatBytes(static_cast<double>(inputBytes)));
+                if (totalBytes > 0) {
+                    line += format(" of {0:s} ({1:.1f}%)", formatBytes(static_cast<double>(totalBytes)), 100.0 * static_cast<double>(std::min(inputBytes, totalBytes)) / static_cast<double>(totalBytes));
+                }
+                if (decodedBytes != inputBytes) { line += format(" ({0:s} decompressed)", formatBytes(static_cast<double>(decodedBytes))); }
+
+                line += format(
+                    " | {0:s}/s | {1:.2f}M lines/s | {2:d} rejected | cpu {3:.0f}%", formatBytes(bytesPerSecond),
+                    elapsed > 0 ? static_cast<double>(m_progress.lines.get()) / elapsed / 1e6 : 0.0, m_progress.rejectedLines.get(), cpuUsage
+                );
+
+                if (totalBytes > inputBytes && bytesPerSecond > 0) {
+                    const auto secondsLeft = static_cast<uint64_t>(static_cast<double>(totalBytes - inputBytes) / bytesPerSecond);
+                    line += format(" | ETA {0:d}:{1:02d}:{2:02d}", secondsLeft / 3600, secondsLeft / 60 % 60, secondsLeft % 60);
+                }
+
+                return line;
+            }
+
+        private: // +++ Private Business +++
+            static double getCpuSeconds() {
+                rusage usage{};
+                getrusage(RUSAGE_SELF, &usage);
+
+                return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+            }
+
+            static string formatBytes(double bytes) {
+                static constexpr const char* UNITS[] = { "B", "KiB", "MiB", "GiB", "TiB" };
+
+                size_t unit = 0;
+                while (bytes >= 1024.0 && unit + 1 < std::size(UNITS)) {
+                    bytes /= 1024.0;
+                    unit++;
+                }
+
+                return format("{0:.1f} {1:s}", bytes, UNITS[unit]);
+            }
+
+        private:
+            const PipelineProgress&                     m_progress;
+
+            std::chrono::steady_clock::time_point       m_startTime{};
+            std::chrono::steady_clock::time_point       m_lastTime{}; //!< When describe() was called last
+            double                                      m_lastCpuSeconds{0};
+
+            thread                                      m_worker{};
+            mutex                                       m_lock{}; //!< Guards m_stopRequested
+            mutex                                       m_describeLock{}; //!< Serialises describe(), which updates m_lastTime
+            condition_variable                          m_wakeUp{};
+            bool                                        m_stopRequested{false};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_PROGRESSREPORTER_HPP
@@ -0,0 +1,376 @@
+/**
+ * @file QueryServer.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the Unix domain socket server answering queries against the daemon's live aggregates.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_QUERYSERVER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_QUERYSERVER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// fmt
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AggregateSnapshot.hpp"
+#include "Extensions.hpp"
+#include "LiveAggregates.hpp"
+#include "ReportOutput.hpp"
+#include "ReportRenderer.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using fmt::format;
+
+    using std::atomic;
+    using std::string;
+    using std::string_view;
+    using std::thread;
+    using std::vector;
+
+    /**
+     * @brief Header-only implementation of the daemon's query socket.
+     *
+     * Clients send one command per line and receive plain-text answers; errors start with "ERR ".
+     * Connections are served on a dedicated thread, which polls them all alongside the listener, so an idle client doesn't
+     * hold up the others. Every query runs against a consistent view of the live aggregates and never holds up ingestion.
+     *
+     *     summary                      Total requests, clients and URIs
+     *     windows                      Requests, bytes and status class ratios of the last 1, 5, 15 and 60 minutes
+     *     top [count] [minutes]        The busiest clients within the last minutes (default: 5, at most 60)
+     *     client <source> [minutes]    Requests per status code of one client; per status class within the last minutes if given
+     *     reports                      The names of the configured reports (see --reports) and their request counts
+     *     report [name]                The full markdown report, or the named report with its sections
+     *     snapshot <file>              Writes a binary snapshot (see --snapshot) of the all-time tables
+     */
+    class QueryServer final {
+        public: // +++ Static +++
+            static constexpr int64_t DEFAULT_WINDOW_MINUTES = 5; //!< The window used if a query doesn't specify one
+            static constexpr int64_t MAX_WINDOW_MINUTES = SlidingWindow::MAX_WINDOW_SECONDS / 60; //!< Longer windows are clamped to this
+            static constexpr const char* STATUS_CLASS_NAMES[] = { "other", "1xx", "2xx", "3xx", "4xx", "5xx" }; //!< See StatusClassCounts
+            static constexpr int32_t RECEIVE_TIMEOUT_SECONDS = 5; //!< Idle clients are disconnected after this time
+            static constexpr int32_t SEND_TIMEOUT_SECONDS = 5; //!< Clients which don't read their answer are disconnected after this time
+            static constexpr size_t MAX_CONNECTIONS = 64; //!< Further clients wait in the listen backlog
+            static constexpr int32_t POLL_INTERVAL_MS = 1000; //!< How often idle clients are checked for
+            static constexpr size_t MAX_COMMAND_LENGTH = 4096; //!< Longer commands are rejected
+
+        public: // +++ Constructor / Destructor +++
+            QueryServer(const LiveAggregates& aggregates, size_t topCount): m_aggregates(aggregates), m_topCount(topCount) {}
+            QueryServer(const QueryServer&) = delete;
+            ~QueryServer() { stop(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Creates the socket (replacing a stale one) and starts serving queries.
+             *
+             * @return true If the server is running. Otherwise getLastError() contains the reason.
+             */
+            bool start(const fs::path& socketPath) {
+                sockaddr_un address{};
+                address.sun_family = AF_UNIX;
+                if (socketPath.native().size() >= sizeof(address.sun_path)) {
+                    m_lastError = "socket path too long";
+                    return false;
+                }
+                std::memcpy(address.sun_path, socketPath.c_str(), socketPath.native().size());
+
+                if ((m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0 || pipe2(m_wakePipe, O_CLOEXEC) != 0) {
+                    m_lastError = strerror(errno);
+                    return false;
+                }
+
+                unlink(socketPath.c_str());
+                // queries can write files (snapshot), so only the daemon's user may connect
+                const auto previousMask = umask(0077);
+                const auto bound = bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+                umask(previousMask);
+
+                if (!bound || listen(m_listenFd, 16) != 0) {
+                    m_lastError = strerror(errno);
+                    return false;
+                }
+
+                m_socketPath = socketPath;
+                m_worker = thread([this]() { serveLoop(); });
+
+                return true;
+            }
+
+            /**
+             * @brief Stops serving, waits for the current query to finish, disconnects all clients and removes the socket.
+             */
+            void stop() {
+                if (m_worker.joinable()) {
+                    m_stopRequested = true;
+                    const char wake = 0;
+                    (void)!::write(m_wakePipe[1], &wake, 1);
+                    m_worker.join();
+                }
+
+                for (auto* fd : { &m_listenFd, &m_wakePipe[0], &m_wakePipe[1] }) {
+                    if (*fd >= 0) { close(*fd); }
+                    *fd = -1;
+                }
+
+                if (!m_socketPath.empty()) {
+                    unlink(m_socketPath.c_str());
+                    m_socketPath.clear();
+                }
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            struct Connection {
+                int                                     fd{-1};
+                string                                  pending{}; //!< Received, but not a complete command yet
+                std::chrono::steady_clock::time_point   lastActivity{};
+            };
+
+            void serveLoop() {
+                vector<Connection> connections;
+                vector<pollfd> fds;
+                while (!m_stopRequested) {
+                    // while all connections are taken, new clients wait in the backlog
+                    fds.clear();
+                    fds.push_back({ m_wakePipe[0], POLLIN, 0 });
+                    fds.push_back({ m_listenFd, static_cast<short>(connections.size() < MAX_CONNECTIONS ? POLLIN : 0), 0 });
+                    for (const auto& connection : connections) { fds.push_back({ connection.fd, POLLIN, 0 }); }
+
+                    if (::poll(fds.data(), fds.size(), POLL_INTERVAL_MS) < 0) { continue; }
+
+                    const auto now = std::chrono::steady_clock::now();
+                    for (size_t i = 0; i < connections.size() && !m_stopRequested; i++) {
+                        auto& connection = connections[i];
+                        if (fds[i + 2].revents != 0) {
+                            connection.lastActivity = now;
+                            if (serveClient(connection)) { continue; }
+                        } else if (now - connection.lastActivity < std::chrono::seconds(RECEIVE_TIMEOUT_SECONDS)) {
+                            continue;
+                        }
+
+                        close(connection.fd);
+                        connection.fd = -1;
+                    }
+                    connections.erase(
+                        std::remove_if(connections.begin(), connections.end(), [](const Connection& connection) { return connection.fd < 0; }),
+                        connections.end()
+                    );
+
+                    if (!(fds[1].revents & POLLIN)) { continue; }
+
+                    const auto clientFd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                    if (clientFd < 0) { continue; }
+
+                    // answers are sent blocking; a client which doesn't read them mustn't stall the others for long
+                    const timeval timeout{ SEND_TIMEOUT_SECONDS, 0 };
+                    setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+                    connections.push_back({ clientFd, {}, now });
+                }
+
+                for (const auto& connection : connections) { close(connection.fd); }
+            }
+
+            /**
+             * @brief Reads what a client sent and answers all complete commands.
+             *
+             * @return false If the connection is to be closed.
+             */
+            bool serveClient(Connection& connection) {
+                char buffer[1024];
+                const auto bytesRead = recv(connection.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+                if (bytesRead < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) { return true; }
+                if (bytesRead <= 0) {
+                    // a command without a trailing newline
+                    if (bytesRead == 0 && !trim(connection.pending, " \t\r").empty()) { handleCommand(connection.fd, connection.pending); }
+                    return false;
+                }
+
+                connection.pending.append(buffer, static_cast<size_t>(bytesRead));
+                size_t newLine = 0;
+                while ((newLine = connection.pending.find('\n')) != string::npos) {
+                    if (!handleCommand(connection.fd, connection.pending.substr(0, newLine))) { return false; }
+                    connection.pending.erase(0, newLine + 1);
+                }
+
+                if (connection.pending.size() > MAX_COMMAND_LENGTH) {
+                    sendText(connection.fd, "ERR command too long\n");
+                    return false;
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Answers a single command.
+             *
+             * @return false If the connection is broken.
+             */
+            bool handleCommand(int clientFd, const string& line) {
+                vector<string> arguments;
+                splitString(line, " \t\r", arguments);
+                if (arguments.empty()) { return true; }
+
+                const auto& command = arguments[0];
+                const auto getNumber = [&](size_t index, int64_t defaultValue) {
+                    return index < arguments.size() ? std::strtoll(arguments[index].c_str(), nullptr, 10) : defaultValue;
+                };
+
+                if (command == "summary") {
+                    return sendText(clientFd, m_aggregates.read([](const LiveTables& tables) {
+                        const auto& totals = tables.getTotals();
+                        return format(
+                            "requests {0:d}\nclients {1:d}\nuris {2:d}\nnewest {3:d}\n", totals.getTotalRequests(), totals.getClientCount(),
+                            totals.getUriCount(), totals.getTotalRequests() > 0 ? tables.getNewestEpoch() : 0
+                        );
+                    }));
+                } else if (command == "top") {
+                    const auto count = static_cast<size_t>(std::max<int64_t>(1, getNumber(1, static_cast<int64_t>(m_topCount))));
+                    const auto minutes = std::clamp<int64_t>(getNumber(2, DEFAULT_WINDOW_MINUTES), 1, MAX_WINDOW_MINUTES);
+                    return sendText(clientFd, m_aggregates.read([&](const LiveTables& tables) {
+                        string response;
+                        for (const auto& client : tables.getClientWindow().getTop(count, minutes * 60)) {
+                            fmt::format_to(std::back_inserter(response), "{0:s} {1:d} {2:d}\n", client.first, client.second.requests, client.second.bytes);
+                        }
+
+                        return response;
+                    }));
+                } else if (command == "client" && arguments.size() >= 2) {
+                    const auto minutes = std::clamp<int64_t>(getNumber(2, 0), 0, MAX_WINDOW_MINUTES);
+                    return sendText(clientFd, m_aggregates.read([&](const LiveTables& tables) {
+                        string response;
+                        if (minutes > 0) {
+                            WindowCounters counters;
+                            if (!tables.getClientWindow().getCounters(arguments[1], minutes * 60, counters)) { return format("ERR unknown client {0:s}\n", arguments[1]); }
+
+                            for (size_t i = 0; i < counters.statusClasses.size(); i++) {
+                                if (counters.statusClasses[i] > 0) { fmt::format_to(std::back_inserter(response), "{0:s} {1:d}\n", STATUS_CLASS_NAMES[i], counters.statusClasses[i]); }
+                            }
+
+                            return response;
+                        }
+
+                        vector<pair<uint16_t, uint64_t>> statuses;
+                        if (!tables.getClientStatuses(arguments[1], statuses)) { return format("ERR unknown client {0:s}\n", arguments[1]); }
+
+                        for (const auto& status : statuses) { fmt::format_to(std::back_inserter(response), "{0:d} {1:d}\n", status.first, status.second); }
+
+                        return response;
+                    }));
+                } else if (command == "windows") {
+                    return sendText(clientFd, m_aggregates.read([](const LiveTables& tables) {
+                        string response;
+                        for (const auto minutes : { 1, 5, 15, 60 }) {
+                            const auto counters = tables.getClientWindow().getTotals(minutes * 60);
+                            const auto ratio = [&](size_t statusClass) {
+                                return counters.requests > 0 ? 100.0 * static_cast<double>(counters.statusClasses[statusClass]) / static_cast<double>(counters.requests) : 0.0;
+                            };
+
+                            fmt::format_to(
+                                std::back_inserter(response), "{0:d}m requests {1:d} rate {2:.2f}/s bytes {3:d} 2xx {4:.1f}% 3xx {5:.1f}% 4xx {6:.1f}% 5xx {7:.1f}%\n",
+                                minutes, counters.requests, static_cast<double>(counters.requests) / (minutes * 60.0), counters.bytes, ratio(2), ratio(3), ratio(4), ratio(5)
+                            );
+                        }
+
+                        return response;
+                    }));
+                } else if (command == "reports") {
+                    return sendText(clientFd, m_aggregates.read([](const LiveTables& tables) {
+                        string response;
+                        if (!tables.getReportSet()) { return response; }
+
+                        for (size_t i = 0; i < tables.getReportSet()->reports.size(); i++) {
+                            fmt::format_to(std::back_inserter(response), "{0:s} {1:d}\n", tables.getReportSet()->reports[i].name, tables.getReportTables(i).getTotalRequests());
+                        }
+
+                        return response;
+                    }));
+                } else if (command == "report") {
+                    // written with write(2), so the daemon must ignore SIGPIPE
+                    return m_aggregates.read([&](const LiveTables& tables) {
+                        size_t index = 0;
+                        if (arguments.size() >= 2 && (!tables.getReportSet() || !tables.getReportSet()->find(arguments[1], index))) {
+                            return sendText(clientFd, format("ERR unknown report {0:s}\n", arguments[1]));
+                        }
+
+                        ReportOutput output;
+                        if (!output.open(clientFd, ReportOutput::Compression::NONE)) { return false; }
+
+                        if (arguments.size() >= 2) {
+                            ReportRenderer(tables.getReportTables(index), output).render(tables.getReportSet()->reports[index].sections);
+                        } else {
+                            ReportRenderer(tables.getTotals(), output).render();
+                        }
+
+                        return output.close();
+                    });
+                } else if (command == "snapshot" && arguments.size() >= 2) {
+                    const auto written = m_aggregates.read([&](const LiveTables& tables) { return SnapshotWriter::write(tables.getTotals(), arguments[1]); });
+                    return sendText(clientFd, written ? format("OK {0:s}\n", arguments[1]) : format("ERR {0:s}\n", strerror(errno)));
+                }
+
+                return sendText(clientFd, format("ERR unknown command: {0:s}\n", line));
+            }
+
+            static bool sendText(int clientFd, string_view text) {
+                while (!text.empty()) {
+                    const auto sent = send(clientFd, text.data(), text.size(), MSG_NOSIGNAL);
+                    if (sent < 0 && errno == EINTR) { continue; }
+                    if (sent <= 0) { return false; }
+                    text.remove_prefix(static_cast<size_t>(sent));
+                }
+
+                return true;
+            }
+
+        private:
+            const LiveAggregates&   m_aggregates;
+            size_t                  m_topCount{20};
+
+            int                     m_listenFd{-1};
+            int                     m_wakePipe[2]{-1, -1};
+            fs::path                m_socketPath{};
+
+            atomic<bool>            m_stopRequested{false};
+            thread                  m_worker{};
+
+            string                  m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_QUERYSERVER_HPP
@@ -0,0 +1,40 @@
+/**
+ * @file RelaxedCounter.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the single-writer counter shared by the live metrics and the progress reporting.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_RELAXEDCOUNTER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_RELAXEDCOUNTER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <atomic>
+
+// libc
+#include <stdint.h>
+
+namespace httpdreport {
+
+    using std::atomic;
+
+    /**
+     * @brief A counter with a single writer; increments are plain loads and stores, so they cost no more than a non-atomic add.
+     */
+    struct RelaxedCounter final {
+        atomic<uint64_t>    value{0};
+
+        void add(uint64_t amount) { value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed); }
+        uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_RELAXEDCOUNTER_HPP
@@ -0,0 +1,505 @@
+/**
+ * @file ReportCoordinator.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the coordinator of a distributed run, which hands out file ranges to workers and merges their snapshots.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_REPORTCOORDINATOR_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_REPORTCOORDINATOR_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AggregateSnapshot.hpp"
+#include "PipelineStats.hpp"
+#include "Probes.hpp"
+#include "RequestAggregator.hpp"
+#include "WorkProtocol.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using fmt::format;
+
+    using std::atomic;
+    using std::string;
+    using std::string_view;
+    using std::unique_ptr;
+    using std::vector;
+
+    /**
+     * @brief A part of a log file, handed to one worker at a time.
+     */
+    struct WorkRange final {
+        uint64_t            id{0}; //!< Unique within a run; split ranges get new IDs
+        string              path{};
+        uint64_t            start{0}; //!< The range holds the lines starting in [start, end)
+        uint64_t            end{WorkConnection::WHOLE_FILE};
+        uint64_t            size{0}; //!< The (estimated) number of bytes; larger ranges are handed out first
+        bool                splittable{true}; //!< Cleared once a worker declined to split the range
+        vector<uint64_t>    failedOn{}; //!< The serials of the workers which couldn't read the range
+    };
+
+    /**
+     * @brief Header-only implementation of a distributed run's coordinator.
+     *
+     * Workers connect over TCP (see WorkConnection for the protocol) and pull one range at a time, largest first, so the
+     * biggest files don't end up as the last ones. Once the queue is empty, idle workers steal: the coordinator asks the
+     * worker holding the largest range in progress to give up its unread half, which is queued as a new range.
+     * When nothing is left to do, every worker sends its tables as a snapshot, which is merged as soon as it arrives.
+     *
+     * A worker which can't open a file leaves it to the others; a worker which disconnects before its snapshot was merged
+     * takes nothing with it, as every range it read is queued again.
+     */
+    class ReportCoordinator final {
+        public: // +++ Static +++
+            static constexpr int32_t POLL_INTERVAL_MS = 500; //!< How often the stop flag is checked while no messages arrive
+
+            /**
+             * @brief Receives the coordinator's progress messages (workers joining, leaving, failing to read files).
+             */
+            using MessageHandler = std::function<void(const string& message)>;
+
+        public: // +++ Constructor / Destructor +++
+            ReportCoordinator(RequestAggregator& aggregator, MessageHandler handler): m_aggregator(aggregator), m_handler(std::move(handler)) {}
+            ReportCoordinator(const ReportCoordinator&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Times the merging of snapshots in to the given statistics; nullptr disables timing.
+             */
+            void setStats(PipelineStats* stats) { m_stats = stats; }
+
+            /**
+             * @brief Queues a file for the workers.
+             *
+             * @param size The file's size, or 0 if it isn't known here; the range then covers the whole file.
+             * @param splittable false for compressed files, which can only be read as a whole.
+             */
+            void addFile(const fs::path& path, uint64_t size, bool splittable) {
+                WorkRange range;
+                range.id = m_nextRangeId++;
+                range.path = path.string();
+                range.end = size > 0 && splittable ? size : WorkConnection::WHOLE_FILE;
+                range.size = size;
+                range.splittable = splittable;
+
+                queueRange(std::move(range));
+                m_openRanges++;
+            }
+
+            /**
+             * @brief Listens on address:port and distributes the queued files until every range was merged (or given up).
+             *
+             * @param stopRequested Checked regularly; the run is aborted once it is set.
+             *
+             * @return true If the run completed. Otherwise getLastError() contains the reason.
+             */
+            bool run(const string& address, uint16_t port, const atomic<bool>& stopRequested) {
+                if (!listenOn(address, port)) { return false; }
+
+                vector<pollfd> fds;
+                while (m_openRanges > 0) {
+                    if (stopRequested) { return fail("stopped"); }
+
+                    fds.clear();
+                    fds.push_back({ m_listenFd, POLLIN, 0 });
+                    for (const auto& worker : m_workers) { fds.push_back({ worker->connection->getFd(), POLLIN, 0 }); }
+
+                    if (::poll(fds.data(), fds.size(), POLL_INTERVAL_MS) < 0 && errno != EINTR) { return fail(strerror(errno)); }
+
+                    // workers are only added or removed below, so fds[i + 1] still belongs to m_workers[i]
+                    for (size_t i = 0; i < m_workers.size(); i++) {
+                        auto& worker = *m_workers[i];
+                        if (fds[i + 1].revents == 0) { continue; }
+
+                        if (!worker.connection->receive() || worker.connection->isOverlong() || !handleMessages(worker)) {
+                            if (!m_lastError.empty()) { return false; }
+                            dropWorker(worker);
+                        }
+                    }
+
+                    if (fds[0].revents & POLLIN) { acceptWorker(); }
+
+                    dispatch();
+
+                    m_workers.erase(
+                        std::remove_if(m_workers.begin(), m_workers.end(), [](const auto& worker) { return worker->state == WorkerState::GONE; }),
+                        m_workers.end()
+                    );
+                }
+
+                close(m_listenFd);
+                m_listenFd = -1;
+                m_workers.clear();
+
+                return true;
+            }
+
+            uint64_t getWorkerCount() const { return m_mergedWorkers; } //!< Gets the number of workers whose snapshot was merged
+            uint64_t getStolenRanges() const { return m_stolenRanges; } //!< Gets the number of ranges split off for idle workers
+            uint64_t getRejectedLines() const { return m_rejectedLines; } //!< Gets the number of malformed lines the workers reported
+            const vector<string>& getFailedRanges() const { return m_failedRanges; } //!< Gets the ranges no worker could read, with the reasons
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            enum class WorkerState {
+                CONNECTED,  //!< Hasn't introduced itself yet
+                IDLE,       //!< Waits for a range
+                WORKING,    //!< Reads a range
+                FINISHING,  //!< Was told to send its snapshot
+                RECEIVING,  //!< Sends its snapshot
+                GONE,       //!< Disconnected or done; removed after the current poll
+            };
+
+            struct Worker {
+                uint64_t                    serial{0};
+                string                      name{};
+                unique_ptr<WorkConnection>  connection{};
+                WorkerState                 state{WorkerState::CONNECTED};
+
+                WorkRange                   current{}; //!< Only valid while WORKING
+                bool                        splitRequested{false}; //!< Whether the current range was asked to be split
+                vector<WorkRange>           completed{}; //!< The ranges in the worker's tables, i.e. in its snapshot
+
+                int                         snapshotFd{-1};
+                string                      snapshotPath{};
+                uint64_t                    snapshotRemaining{0};
+                uint64_t                    rejectedLines{0};
+            };
+
+            bool fail(const string& error) {
+                m_lastError = error;
+                return false;
+            }
+
+            bool listenOn(const string& address, uint16_t port) {
+                sockaddr_in bindAddress{};
+                bindAddress.sin_family = AF_INET;
+                bindAddress.sin_port = htons(port);
+                if (inet_pton(AF_INET, address.c_str(), &bindAddress.sin_addr) != 1) { return fail("invalid IPv4 address " + address); }
+
+                const int reuse = 1;
+                if (
+                    (m_listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0 ||
+                    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+                    bind(m_listenFd, reinterpret_cast<sockaddr*>(&bindAddress), sizeof(bindAddress)) != 0 || listen(m_listenFd, 64) != 0
+                ) {
+                    return fail(strerror(errno));
+                }
+
+                return true;
+            }
+
+            void acceptWorker() {
+                const auto fd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd < 0) { return; }
+
+                auto worker = std::make_unique<Worker>();
+                worker->serial = m_nextWorkerSerial++;
+                worker->connection = std::make_unique<WorkConnection>(fd);
+                m_workers.emplace_back(std::move(worker));
+            }
+
+            /**
+             * @brief Handles everything a worker sent.
+             *
+             * @return false If the worker broke the protocol or its snapshot couldn't be stored.
+             */
+            bool handleMessages(Worker& worker) {
+                string line;
+                while (worker.state != WorkerState::RECEIVING && worker.connection->nextLine(line)) {
+                    if (worker.state == WorkerState::CONNECTED) {
+                        if (line.rfind("HELLO ", 0) != 0) { return false; }
+
+                        worker.name = line.substr(6);
+                        worker.state = WorkerState::IDLE;
+                        m_handler(format("Worker {0:s} connected", worker.name));
+                        continue;
+                    }
+
+                    char* cursor = nullptr;
+                    const auto id = std::strtoull(line.c_str() + line.find(' ') + 1, &cursor, 10);
+                    const auto isCurrent = worker.state == WorkerState::WORKING && worker.current.id == id;
+
+                    if (line.rfind("DONE ", 0) == 0 && isCurrent) {
+                        finishRange(worker);
+                        worker.completed.emplace_back(std::move(worker.current));
+                    } else if (line.rfind("FAILED ", 0) == 0 && isCurrent) {
+                        const string reason(*cursor == ' ' ? cursor + 1 : cursor);
+                        finishRange(worker);
+                        worker.current.failedOn.push_back(worker.serial);
+                        m_handler(format("Worker {0:s} failed to read {1:s}: {2:s}", worker.name, worker.current.path, reason));
+
+                        if (isReadableByNone(worker.current)) {
+                            giveUp(worker.current, reason);
+                        } else {
+                            queueRange(std::move(worker.current));
+                        }
+                    } else if (line.rfind("SPLIT ", 0) == 0 && isCurrent) {
+                        splitRange(worker, std::strtoull(cursor, nullptr, 10));
+                    } else if (line.rfind("KEEP ", 0) == 0 && isCurrent) {
+                        worker.current.splittable = false;
+                        clearSplitRequest(worker);
+                    } else if (line.rfind("SNAPSHOT ", 0) == 0 && worker.state == WorkerState::FINISHING) {
+                        worker.snapshotRemaining = id;
+                        worker.rejectedLines = std::strtoull(cursor, nullptr, 10);
+                        if (!beginSnapshot(worker)) { return false; }
+                    }
+                }
+
+                return worker.state != WorkerState::RECEIVING || receiveSnapshot(worker);
+            }
+
+            void finishRange(Worker& worker) {
+                clearSplitRequest(worker);
+                worker.state = WorkerState::IDLE;
+            }
+
+            void clearSplitRequest(Worker& worker) {
+                if (!worker.splitRequested) { return; }
+
+                worker.splitRequested = false;
+                m_pendingSplits--;
+            }
+
+            /**
+             * @brief Queues the second half of a worker's range, which it gave up at newEnd.
+             */
+            void splitRange(Worker& worker, uint64_t newEnd) {
+                auto& current = worker.current;
+                clearSplitRequest(worker);
+                if (newEnd <= current.start || newEnd >= current.end) { return; }
+
+                WorkRange stolen;
+                stolen.id = m_nextRangeId++;
+                stolen.path = current.path;
+                stolen.start = newEnd;
+                stolen.end = current.end;
+                stolen.size = current.end == WorkConnection::WHOLE_FILE ? 0 : current.end - newEnd;
+
+                current.end = newEnd;
+                current.size = newEnd - current.start;
+
+                queueRange(std::move(stolen));
+                m_openRanges++;
+                m_stolenRanges++;
+            }
+
+            bool beginSnapshot(Worker& worker) {
+                char snapshotPath[] = "/tmp/httpd-hit-report-coordinator-XXXXXX";
+                if ((worker.snapshotFd = mkstemp(snapshotPath)) < 0) { return fail(format("failed to create a temporary file: {0:s}", strerror(errno))); }
+
+                worker.snapshotPath = snapshotPath;
+                worker.state = WorkerState::RECEIVING;
+                return true;
+            }
+
+            /**
+             * @brief Stores the snapshot bytes received so far; merges the snapshot once it is complete.
+             */
+            bool receiveSnapshot(Worker& worker) {
+                while (worker.snapshotRemaining > 0) {
+                    const auto bytes = worker.connection->takeBytes(static_cast<size_t>(std::min<uint64_t>(worker.snapshotRemaining, 1 << 20)));
+                    if (bytes.empty()) { return true; }
+
+                    if (::write(worker.snapshotFd, bytes.data(), bytes.size()) != static_cast<ssize_t>(bytes.size())) {
+                        return fail(format("failed to store the snapshot of {0:s}: {1:s}", worker.name, strerror(errno)));
+                    }
+                    worker.snapshotRemaining -= bytes.size();
+                }
+
+                const auto snapshotSize = lseek(worker.snapshotFd, 0, SEEK_CUR);
+                close(worker.snapshotFd);
+                worker.snapshotFd = -1;
+
+                // a snapshot is only merged once it is complete, but a corrupt one would leave the tables half-merged
+                PipelineStats::Timer timer(m_stats, PipelineStage::MERGE);
+                const auto merged = mergeSnapshot(worker.snapshotPath, m_aggregator);
+                timer.stop(static_cast<uint64_t>(std::max<off_t>(0, snapshotSize)), 1);
+                unlink(worker.snapshotPath.c_str());
+                if (!merged) { return fail(format("the snapshot of {0:s} is corrupt", worker.name)); }
+
+                m_handler(format("Merged the snapshot of {0:s} ({1:d} ranges)", worker.name, worker.completed.size()));
+                m_openRanges -= worker.completed.size();
+                m_rejectedLines += worker.rejectedLines;
+                m_mergedWorkers++;
+                worker.completed.clear();
+                worker.state = WorkerState::GONE;
+
+                return true;
+            }
+
+            /**
+             * @brief Forgets a disconnected worker and queues every range it read or was reading again.
+             */
+            void dropWorker(Worker& worker) {
+                if (worker.snapshotFd >= 0) {
+                    close(worker.snapshotFd);
+                    unlink(worker.snapshotPath.c_str());
+                    worker.snapshotFd = -1;
+                }
+
+                if (worker.state == WorkerState::WORKING) {
+                    clearSplitRequest(worker);
+                    worker.completed.emplace_back(std::move(worker.current));
+                }
+
+                if (!worker.name.empty()) {
+                    m_handler(format("Lost worker {0:s}; queueing its {1:d} ranges again", worker.name, worker.completed.size()));
+                }
+
+                for (auto& range : worker.completed) { queueRange(std::move(range)); }
+                worker.completed.clear();
+                worker.state = WorkerState::GONE;
+            }
+
+            /**
+             * @brief Hands out queued ranges to idle workers, lets idle workers steal and sends FINISH once everything was read.
+             */
+            void dispatch() {
+                size_t idleWorkers = 0;
+                bool anyWorking = false;
+
+                for (auto& worker : m_workers) {
+                    if (worker->state == WorkerState::IDLE) {
+                        // the queue is sorted by size; the largest range this worker didn't fail on is taken from the back
+                        auto range = std::find_if(m_queue.rbegin(), m_queue.rend(), [&](const WorkRange& candidate) {
+                            return std::find(candidate.failedOn.begin(), candidate.failedOn.end(), worker->serial) == candidate.failedOn.end();
+                        });
+
+                        if (range == m_queue.rend()) {
+                            idleWorkers++;
+                            continue;
+                        }
+
+                        worker->current = std::move(*range);
+                        m_queue.erase(std::next(range).base());
+                        HTTPDREPORT_PROBE4(range_dispatch, worker->current.id, worker->current.start, worker->current.end, worker->current.path.c_str());
+                        if (!worker->connection->sendLine(format("WORK {0:d} {1:d} {2:d} {3:s}", worker->current.id, worker->current.start, worker->current.end, worker->current.path))) {
+                            worker->state = WorkerState::WORKING;
+                            dropWorker(*worker);
+                            continue;
+                        }
+
+                        worker->state = WorkerState::WORKING;
+                    }
+
+                    anyWorking = anyWorking || worker->state == WorkerState::WORKING;
+                }
+
+                // one steal per idle worker; the largest range still being read is the likeliest straggler
+                while (m_pendingSplits < idleWorkers) {
+                    Worker* victim = nullptr;
+                    for (auto& worker : m_workers) {
+                        if (worker->state != WorkerState::WORKING || worker->splitRequested || !worker->current.splittable) { continue; }
+                        if (victim == nullptr || worker->current.size > victim->current.size) { victim = worker.get(); }
+                    }
+
+                    if (victim == nullptr) { break; }
+
+                    victim->splitRequested = true;
+                    m_pendingSplits++;
+                    if (!victim->connection->sendLine(format("SPLIT {0:d}", victim->current.id))) { dropWorker(*victim); }
+                }
+
+                if (anyWorking) { return; }
+
+                // nobody is left to read what every idle worker failed on
+                const auto hopeless = std::partition(m_queue.begin(), m_queue.end(), [&](const WorkRange& range) { return !isReadableByNone(range); });
+                for (auto range = hopeless; range != m_queue.end(); range++) { giveUp(*range, "no worker could read it"); }
+                m_queue.erase(hopeless, m_queue.end());
+
+                if (!m_queue.empty()) { return; }
+
+                for (auto& worker : m_workers) {
+                    if (worker->state != WorkerState::IDLE) { continue; }
+
+                    worker->state = WorkerState::FINISHING;
+                    if (!worker->connection->sendLine("FINISH")) { dropWorker(*worker); }
+                }
+            }
+
+            void queueRange(WorkRange range) {
+                const auto position = std::upper_bound(m_queue.begin(), m_queue.end(), range.size, [](uint64_t size, const WorkRange& queued) { return size < queued.size; });
+                m_queue.insert(position, std::move(range));
+            }
+
+            /**
+             * @brief Gets a value indicating whether or not every connected worker failed to read a range (and there is one).
+             */
+            bool isReadableByNone(const WorkRange& range) const {
+                bool anyWorker = false;
+                for (const auto& worker : m_workers) {
+                    if (worker->state == WorkerState::CONNECTED || worker->state == WorkerState::GONE) { continue; }
+                    if (std::find(range.failedOn.begin(), range.failedOn.end(), worker->serial) == range.failedOn.end()) { return false; }
+                    anyWorker = true;
+                }
+
+                return anyWorker;
+            }
+
+            void giveUp(const WorkRange& range, const string& reason) {
+                m_failedRanges.push_back(format("{0:s} (from byte {1:d}): {2:s}", range.path, range.start, reason));
+                m_openRanges--;
+            }
+
+        private:
+            RequestAggregator&          m_aggregator;
+            MessageHandler              m_handler{};
+            PipelineStats*              m_stats{nullptr};
+
+            int                         m_listenFd{-1};
+            vector<unique_ptr<Worker>>  m_workers{};
+            vector<WorkRange>           m_queue{}; //!< Sorted by ascending size
+            uint64_t                    m_openRanges{0}; //!< Ranges which were neither merged nor given up
+            size_t                      m_pendingSplits{0}; //!< SPLIT requests which weren't answered yet
+
+            uint64_t                    m_nextRangeId{1};
+            uint64_t                    m_nextWorkerSerial{1};
+
+            uint64_t                    m_mergedWorkers{0};
+            uint64_t                    m_stolenRanges{0};
+            uint64_t                    m_rejectedLines{0};
+            vector<string>              m_failedRanges{};
+
+            string                      m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_REPORTCOORDINATOR_HPP
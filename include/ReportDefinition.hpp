@@ -0,0 +1,301 @@
+/**
+ * @file ReportDefinition.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains report definitions (filters, sections, output) and the loader for report configuration files.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_REPORTDEFINITION_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_REPORTDEFINITION_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "Extensions.hpp"
+#include "ReportRenderer.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using fmt::format;
+
+    using std::ifstream;
+    using std::shared_ptr;
+    using std::string;
+    using std::string_view;
+    using std::vector;
+
+    /**
+     * @brief A filter selecting the requests a report is built from. Empty criteria match everything.
+     */
+    struct RequestFilter final {
+        uint16_t    minStatusCode{0}; //!< The lowest status code to include
+        uint16_t    maxStatusCode{999}; //!< The highest status code to include
+
+        string      virtualHost{}; //!< Only include requests to this vhost
+        string      requestMethod{}; //!< Only include requests with this method
+        string      uriPrefix{}; //!< Only include URIs starting with this prefix
+        string      userAgentSubstring{}; //!< Only include user agents containing this string
+
+        /**
+         * @brief Gets a value indicating whether or not a request passes this filter.
+         */
+        bool matches(const RequestRecord& record) const {
+            return
+                record.statusCode >= minStatusCode && record.statusCode <= maxStatusCode &&
+                (virtualHost.empty() || record.virtualHost == virtualHost) &&
+                (requestMethod.empty() || record.httpRequestMethod == requestMethod) &&
+                (uriPrefix.empty() || record.requestUri.substr(0, uriPrefix.size()) == uriPrefix) &&
+                (userAgentSubstring.empty() || record.userAgent.find(userAgentSubstring) != string_view::npos);
+        }
+
+        /**
+         * @brief Gets a value indicating whether or not this filter lets every request pass.
+         */
+        bool isEmpty() const {
+            return minStatusCode == 0 && maxStatusCode == 999 && virtualHost.empty() && requestMethod.empty() && uriPrefix.empty() && userAgentSubstring.empty();
+        }
+
+        /**
+         * @brief Gets the RecordFields this filter needs decoded.
+         */
+        uint32_t getRequiredFields() const { return userAgentSubstring.empty() ? 0 : static_cast<uint32_t>(FIELD_REFERER_AND_USER_AGENT); }
+
+        bool operator==(const RequestFilter& other) const {
+            return
+                minStatusCode == other.minStatusCode && maxStatusCode == other.maxStatusCode && virtualHost == other.virtualHost &&
+                requestMethod == other.requestMethod && uriPrefix == other.uriPrefix && userAgentSubstring == other.userAgentSubstring;
+        }
+    };
+
+    /**
+     * @brief A single report: what to render, from which requests, and where to.
+     */
+    struct ReportDefinition final {
+        string          name{}; //!< The report's name, as given in the configuration
+        string          outputFile{}; //!< The output file; empty for stdout. .gz/.zst are compressed
+
+        uint32_t        sections{SECTION_ALL}; //!< The ReportSections to render
+
+        RequestFilter   filter{}; //!< Selects the requests the report is built from
+
+        /**
+         * @brief Gets the RecordFields this report needs decoded, besides FIELD_TIMESTAMP, which every line needs validated.
+         */
+        uint32_t getRequiredFields() const { return filter.getRequiredFields(); }
+
+        /**
+         * @brief Gets a value indicating whether or not another definition selects and renders the same (the output may differ).
+         */
+        bool isSameReport(const ReportDefinition& other) const { return name == other.name && sections == other.sections && filter == other.filter; }
+    };
+
+    /**
+     * @brief The report definitions of one configuration file. Never modified once loaded; a reload creates a new set.
+     */
+    struct ReportSet final {
+        vector<ReportDefinition>    reports{};
+        uint32_t                    requiredFields{0}; //!< The RecordFields all reports need decoded
+
+        /**
+         * @brief Gets the index of a report by its name.
+         *
+         * @return false If there is no such report.
+         */
+        bool find(string_view name, size_t& index) const {
+            for (index = 0; index < reports.size(); index++) {
+                if (reports[index].name == name) { return true; }
+            }
+
+            return false;
+        }
+    };
+
+    /**
+     * @brief Parses a comma-separated list of section names (summary, clients, uris, timeseries, scanners, all).
+     *
+     * @return true If all names were known.
+     */
+    inline bool parseReportSections(const string& value, uint32_t& sections) {
+        vector<string> names;
+        splitString(value, ", \t", names);
+
+        sections = 0;
+        for (const auto& name : names) {
+            if (name.empty()) { continue; } // splitString yields empty tokens between adjacent delimiters
+            else if (name == "summary") { sections |= SECTION_SUMMARY; }
+            else if (name == "clients") { sections |= SECTION_CLIENTS; }
+            else if (name == "uris") { sections |= SECTION_URIS; }
+            else if (name == "timeseries") { sections |= SECTION_TIME_SERIES; }
+            else if (name == "scanners") { sections |= SECTION_SCANNERS; }
+            else if (name == "all") { sections |= SECTION_ALL; }
+            else { return false; }
+        }
+
+        return sections != 0;
+    }
+
+    /**
+     * @brief Parses a status code (404) or an inclusive range of them (400-499).
+     *
+     * @return false If value isn't a code from 100 to 999, or a range of them whose end isn't below its start.
+     */
+    inline bool parseStatusRange(const string& value, uint16_t& minStatusCode, uint16_t& maxStatusCode) {
+        const auto parseCode = [](const char* text, const char*& end, uint16_t& code) {
+            if (!std::isdigit(static_cast<unsigned char>(*text))) { return false; }
+
+            char* numberEnd = nullptr;
+            const auto number = std::strtoul(text, &numberEnd, 10);
+            end = numberEnd;
+            code = static_cast<uint16_t>(number);
+
+            return number >= 100 && number <= 999;
+        };
+
+        const char* end = nullptr;
+        if (!parseCode(value.c_str(), end, minStatusCode)) { return false; }
+
+        maxStatusCode = minStatusCode;
+        if (*end == '-' && !parseCode(end + 1, end, maxStatusCode)) { return false; }
+
+        return *end == '\0' && minStatusCode <= maxStatusCode;
+    }
+
+    /**
+     * @brief Loads report definitions from an INI-style configuration file.
+     *
+     * Example:
+     *
+     *     [report errors-by-client]
+     *     output = errors.md.gz
+     *     sections = summary, clients
+     *     status = 400-599
+     *     vhost = www.example.com
+     *     uri-prefix = /api/
+     *     method = POST
+     *     user-agent = curl
+     *
+     * @param path The configuration file.
+     * @param reports The vector the definitions are appended to.
+     * @param error Contains the reason on failure.
+     *
+     * @return true If the file was loaded successfully.
+     */
+    inline bool loadReportDefinitions(const fs::path& path, vector<ReportDefinition>& reports, string& error) {
+        ifstream input(path);
+        if (!input.good()) {
+            error = format("cannot open {0:s}", path.string());
+            return false;
+        }
+
+        string line;
+        size_t lineNumber = 0;
+        while (std::getline(input, line)) {
+            lineNumber++;
+            line = trim(line, " \t\r");
+            if (line.empty() || line[0] == '#' || line[0] == ';') { continue; }
+
+            if (line.front() == '[' && line.back() == ']') {
+                // [report] or [report <name>]; [reportfoo] is a typo, not a report named foo
+                const auto header = trim(line.substr(1, line.size() - 2), " \t");
+                if (header.rfind("report", 0) != 0 || (header.size() > 6 && header[6] != ' ' && header[6] != '\t')) {
+                    error = format("{0:s}:{1:d}: unknown section [{2:s}]", path.string(), lineNumber, header);
+                    return false;
+                }
+
+                const auto name = trim(header.substr(6), " \t");
+                if (std::any_of(reports.begin(), reports.end(), [&](const ReportDefinition& report) { return report.name == name; })) {
+                    error = format("{0:s}:{1:d}: report \"{2:s}\" is defined twice", path.string(), lineNumber, name);
+                    return false;
+                }
+
+                reports.emplace_back();
+                reports.back().name = name;
+                continue;
+            }
+
+            const auto separator = line.find('=');
+            if (separator == string::npos || reports.empty()) {
+                error = format("{0:s}:{1:d}: expected key = value inside a [report] section", path.string(), lineNumber);
+                return false;
+            }
+
+            const auto key = trim(line.substr(0, separator), " \t");
+            const auto value = trim(line.substr(separator + 1), " \t");
+            auto& report = reports.back();
+
+            if (key == "output") {
+                report.outputFile = value;
+            } else if (key == "sections") {
+                if (!parseReportSections(value, report.sections)) {
+                    error = format("{0:s}:{1:d}: unknown section in \"{2:s}\"", path.string(), lineNumber, value);
+                    return false;
+                }
+            } else if (key == "status") {
+                // either a single code or an inclusive range, e.g. 400-499
+                if (!parseStatusRange(value, report.filter.minStatusCode, report.filter.maxStatusCode)) {
+                    error = format("{0:s}:{1:d}: invalid status \"{2:s}\"; expected a code or a range, e.g. 404 or 400-499", path.string(), lineNumber, value);
+                    return false;
+                }
+            } else if (key == "vhost") {
+                report.filter.virtualHost = value;
+            } else if (key == "method") {
+                report.filter.requestMethod = value;
+            } else if (key == "uri-prefix") {
+                report.filter.uriPrefix = value;
+            } else if (key == "user-agent") {
+                report.filter.userAgentSubstring = value;
+            } else {
+                error = format("{0:s}:{1:d}: unknown key \"{2:s}\"", path.string(), lineNumber, key);
+                return false;
+            }
+        }
+
+        if (reports.empty()) {
+            error = format("{0:s} doesn't define any reports", path.string());
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Loads a report configuration file (see loadReportDefinitions) in to a new set.
+     *
+     * @return nullptr If the file couldn't be loaded; error contains the reason.
+     */
+    inline shared_ptr<const ReportSet> loadReportSet(const fs::path& path, string& error) {
+        auto reportSet = std::make_shared<ReportSet>();
+        if (!loadReportDefinitions(path, reportSet->reports, error)) { return nullptr; }
+
+        for (const auto& report : reportSet->reports) { reportSet->requiredFields |= report.getRequiredFields(); }
+
+        return reportSet;
+    }
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_REPORTDEFINITION_HPP
@@ -0,0 +1,396 @@
+/**
+ * @file ReportOutput.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the buffered report output stream, optionally compressing on a separate thread.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_REPORTOUTPUT_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_REPORTOUTPUT_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// zlib
+#include <zlib.h>
+
+// zstd
+#ifdef HTTPDREPORT_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AllocationCounter.hpp"
+#include "Probes.hpp"
+
+namespace httpdreport {
+
+    using std::condition_variable;
+    using std::deque;
+    using std::mutex;
+    using std::string;
+    using std::string_view;
+    using std::thread;
+    using std::unique_lock;
+    using std::vector;
+
+    /**
+     * @brief Header-only implementation of the stream every report is written to.
+     *
+     * Text is formatted in to large buffers. Uncompressed output is written as soon as a buffer is full;
+     * compressed output hands full buffers to a dedicated thread, so compression overlaps with rendering.
+     * zstd additionally uses its own worker threads.
+     */
+    class ReportOutput final {
+        public: // +++ Static +++
+            static constexpr size_t BUFFER_SIZE = 1 << 20; //!< The size of each buffer handed to the writer
+            static constexpr size_t MAX_QUEUED_BUFFERS = 4; //!< The number of buffers which may wait for compression
+
+            enum class Compression { NONE, GZIP, ZSTD };
+
+            /**
+             * @brief Gets the compression implied by a file's extension (.gz, .zst).
+             */
+            static Compression getCompressionForPath(string_view path) {
+                const auto endsWith = [&](string_view suffix) { return path.size() >= suffix.size() && path.substr(path.size() - suffix.size()) == suffix; };
+
+                if (endsWith(".gz")) { return Compression::GZIP; }
+                if (endsWith(".zst") || endsWith(".zstd")) { return Compression::ZSTD; }
+
+                return Compression::NONE;
+            }
+
+            static bool isZstdSupported() { //!< Gets a value indicating whether or not zstd support was compiled in
+            #ifdef HTTPDREPORT_HAVE_ZSTD
+                return true;
+            #else
+                return false;
+            #endif
+            }
+
+        public: // +++ Constructor / Destructor +++
+            ReportOutput() = default;
+            ReportOutput(const ReportOutput&) = delete;
+            ~ReportOutput() { close(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Opens the output.
+             *
+             * @param path The file to write to. If empty, stdout is used.
+             * @param compression The compression to apply.
+             *
+             * @return true If the output is ready. Otherwise getLastError() contains the reason.
+             */
+            bool open(const string& path, Compression compression) {
+                m_compression = compression;
+                m_failed = false;
+
+                if (compression == Compression::ZSTD && !isZstdSupported()) {
+                    m_lastError = "zstd support was not compiled in (requires libzstd-dev)";
+                    return false;
+                }
+
+                if (path.empty()) {
+                    m_fd = STDOUT_FILENO;
+                    m_ownsFd = false;
+                } else if ((m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)) < 0) {
+                    m_lastError = strerror(errno);
+                    return false;
+                } else {
+                    m_ownsFd = true;
+                }
+
+                return start();
+            }
+
+            /**
+             * @brief Opens the output on an already opened descriptor (e.g. a socket), which is not closed.
+             *
+             * @return true If the output is ready. Otherwise getLastError() contains the reason.
+             */
+            bool open(int fd, Compression compression) {
+                m_compression = compression;
+                m_failed = false;
+
+                if (compression == Compression::ZSTD && !isZstdSupported()) {
+                    m_lastError = "zstd support was not compiled in (requires libzstd-dev)";
+                    return false;
+                }
+
+                m_fd = fd;
+                m_ownsFd = false;
+
+                return start();
+            }
+
+            /**
+             * @brief Formats text in to the output.
+             */
+            template<typename... Args>
+            void print(fmt::format_string<Args...> formatString, Args&&... args) {
+                fmt::format_to(std::back_inserter(m_buffer), formatString, std::forward<Args>(args)...);
+                if (m_buffer.size() >= BUFFER_SIZE) { submitBuffer(); }
+            }
+
+            /**
+             * @brief Writes raw text to the output.
+             */
+            void write(string_view text) {
+                m_buffer.insert(m_buffer.end(), text.begin(), text.end());
+                if (m_buffer.size() >= BUFFER_SIZE) { submitBuffer(); }
+            }
+
+            /**
+             * @brief Flushes all pending text, finishes the compressed stream and closes the output.
+             *
+             * @return true If everything was written successfully.
+             */
+            bool close() {
+                if (!m_isOpen) { return !m_failed; }
+                m_isOpen = false;
+
+                submitBuffer();
+
+                if (m_worker.joinable()) {
+                    {
+                        unique_lock<mutex> lock(m_queueLock);
+                        m_stopWorker = true;
+                    }
+                    m_queueChanged.notify_all();
+                    m_worker.join();
+                }
+
+                destroyCompressor();
+                HTTPDREPORT_PROBE3(report_write, m_fd, m_bytesSubmitted, !m_failed);
+                closeFd();
+
+                return !m_failed;
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            bool start() {
+                if (!initCompressor()) {
+                    closeFd();
+                    return false;
+                }
+
+                m_buffer.reserve(BUFFER_SIZE + BUFFER_SIZE / 4);
+                m_bytesSubmitted = 0;
+                if (m_compression != Compression::NONE) {
+                    m_stopWorker = false;
+                    m_worker = thread([this]() { compressionLoop(); });
+                }
+
+                m_isOpen = true;
+                return true;
+            }
+
+            void submitBuffer() {
+                if (m_buffer.empty()) { return; }
+                m_bytesSubmitted += m_buffer.size();
+
+                if (m_compression == Compression::NONE) {
+                    writeFully(m_buffer.data(), m_buffer.size());
+                    m_buffer.clear();
+                    return;
+                }
+
+                vector<char> next;
+                {
+                    unique_lock<mutex> lock(m_queueLock);
+                    m_queueChanged.wait(lock, [this]() { return m_queue.size() < MAX_QUEUED_BUFFERS; });
+                    m_queue.emplace_back(std::move(m_buffer));
+
+                    // recycle buffers the worker is done with instead of allocating new ones
+                    if (!m_freeBuffers.empty()) {
+                        next = std::move(m_freeBuffers.back());
+                        m_freeBuffers.pop_back();
+                    }
+                }
+                m_queueChanged.notify_all();
+
+                next.clear();
+                next.reserve(BUFFER_SIZE + BUFFER_SIZE / 4);
+                m_buffer = std::move(next);
+            }
+
+            void compressionLoop() {
+                const AllocationCounter::Scope allocationScope(AllocationTag::RENDER);
+                while (true) {
+                    vector<char> buffer;
+                    {
+                        unique_lock<mutex> lock(m_queueLock);
+                        m_queueChanged.wait(lock, [this]() { return !m_queue.empty() || m_stopWorker; });
+                        if (m_queue.empty()) { break; }
+
+                        buffer = std::move(m_queue.front());
+                        m_queue.pop_front();
+                    }
+                    m_queueChanged.notify_all();
+
+                    compress(buffer.data(), buffer.size(), false);
+
+                    buffer.clear();
+                    unique_lock<mutex> lock(m_queueLock);
+                    m_freeBuffers.emplace_back(std::move(buffer));
+                }
+
+                compress(nullptr, 0, true);
+            }
+
+            bool initCompressor() {
+                m_compressed.resize(BUFFER_SIZE / 4);
+
+                if (m_compression == Compression::GZIP) {
+                    m_gzStream = z_stream{};
+                    // 15 window bits + 16 for a gzip header and trailer
+                    if (deflateInit2(&m_gzStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                        m_lastError = "failed to initialise zlib";
+                        return false;
+                    }
+                }
+            #ifdef HTTPDREPORT_HAVE_ZSTD
+                else if (m_compression == Compression::ZSTD) {
+                    if ((m_zstdContext = ZSTD_createCCtx()) == nullptr) {
+                        m_lastError = "failed to initialise zstd";
+                        return false;
+                    }
+
+                    ZSTD_CCtx_setParameter(m_zstdContext, ZSTD_c_compressionLevel, 3);
+                    // silently stays single-threaded if libzstd was built without multi-threading
+                    ZSTD_CCtx_setParameter(m_zstdContext, ZSTD_c_nbWorkers, static_cast<int>(std::max(1u, thread::hardware_concurrency())));
+                }
+            #endif
+
+                return true;
+            }
+
+            void destroyCompressor() {
+                if (m_compression == Compression::GZIP) { deflateEnd(&m_gzStream); }
+            #ifdef HTTPDREPORT_HAVE_ZSTD
+                if (m_zstdContext != nullptr) {
+                    ZSTD_freeCCtx(m_zstdContext);
+                    m_zstdContext = nullptr;
+                }
+            #endif
+            }
+
+            /**
+             * @brief Compresses a buffer and writes the result; called on the worker thread only.
+             */
+            void compress(const char* data, size_t size, bool finish) {
+                if (m_compression == Compression::GZIP) {
+                    m_gzStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+                    m_gzStream.avail_in = static_cast<uInt>(size);
+
+                    int result = Z_OK;
+                    do {
+                        m_gzStream.next_out = reinterpret_cast<Bytef*>(m_compressed.data());
+                        m_gzStream.avail_out = static_cast<uInt>(m_compressed.size());
+                        result = deflate(&m_gzStream, finish ? Z_FINISH : Z_NO_FLUSH);
+                        writeFully(m_compressed.data(), m_compressed.size() - m_gzStream.avail_out);
+                    } while (m_gzStream.avail_out == 0 || (finish && result != Z_STREAM_END && result != Z_STREAM_ERROR));
+                }
+            #ifdef HTTPDREPORT_HAVE_ZSTD
+                else if (m_compression == Compression::ZSTD) {
+                    ZSTD_inBuffer input{ data, size, 0 };
+                    size_t remaining = 0;
+                    do {
+                        ZSTD_outBuffer output{ m_compressed.data(), m_compressed.size(), 0 };
+                        remaining = ZSTD_compressStream2(m_zstdContext, &output, &input, finish ? ZSTD_e_end : ZSTD_e_continue);
+                        if (ZSTD_isError(remaining)) {
+                            m_lastError = ZSTD_getErrorName(remaining);
+                            m_failed = true;
+                            return;
+                        }
+                        writeFully(m_compressed.data(), output.pos);
+                    } while (finish ? remaining != 0 : input.pos < input.size);
+                }
+            #endif
+            }
+
+            void writeFully(const char* data, size_t size) {
+                while (size > 0 && !m_failed) {
+                    const auto written = ::write(m_fd, data, size);
+                    if (written < 0) {
+                        if (errno == EINTR) { continue; }
+                        m_lastError = strerror(errno);
+                        m_failed = true;
+                        return;
+                    }
+
+                    data += written;
+                    size -= static_cast<size_t>(written);
+                }
+            }
+
+            void closeFd() {
+                if (m_ownsFd && m_fd >= 0 && ::close(m_fd) != 0 && !m_failed) {
+                    m_lastError = strerror(errno);
+                    m_failed = true;
+                }
+
+                m_fd = -1;
+                m_ownsFd = false;
+            }
+
+        private:
+            std::atomic<bool>   m_failed{false};
+            bool                m_isOpen{false};
+            bool                m_ownsFd{false};
+            bool                m_stopWorker{false};
+            int                 m_fd{-1};
+            uint64_t            m_bytesSubmitted{0}; //!< Bytes written (or queued for compression) since open(), for the report_write probe
+
+            Compression         m_compression{Compression::NONE};
+
+            string              m_lastError{};
+
+            vector<char>        m_buffer{};
+            vector<char>        m_compressed{};
+
+            mutex               m_queueLock{};
+            condition_variable  m_queueChanged{};
+            deque<vector<char>> m_queue{};
+            vector<vector<char>> m_freeBuffers{};
+            thread              m_worker{};
+
+            z_stream            m_gzStream{};
+        #ifdef HTTPDREPORT_HAVE_ZSTD
+            ZSTD_CCtx*          m_zstdContext{nullptr};
+        #endif
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_REPORTOUTPUT_HPP
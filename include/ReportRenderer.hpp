@@ -0,0 +1,225 @@
+/**
+ * @file ReportRenderer.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the renderer for the markdown-formatted report.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_REPORTRENDERER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_REPORTRENDERER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+// fmt
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AllocationCounter.hpp"
+#include "ReportOutput.hpp"
+#include "RequestAggregator.hpp"
+
+namespace httpdreport {
+
+    using std::pair;
+    using std::vector;
+
+    /**
+     * @brief The sections a report can consist of.
+     */
+    enum ReportSections : uint32_t {
+        SECTION_SUMMARY     = 1 << 0, //!< Total requests and unique clients
+        SECTION_CLIENTS     = 1 << 1, //!< Status code table per client
+        SECTION_URIS        = 1 << 2, //!< Per-URI table
+        SECTION_TIME_SERIES = 1 << 3, //!< Requests per minute
+        SECTION_SCANNERS    = 1 << 4, //!< Clients with conspicuously many client errors
+
+        SECTION_ALL         = SECTION_SUMMARY | SECTION_CLIENTS | SECTION_URIS | SECTION_TIME_SERIES | SECTION_SCANNERS
+    };
+
+    /**
+     * @brief Gets the aggregate tables (AggregateTables) required to render the given sections.
+     */
+    inline uint32_t getRequiredTables(uint32_t sections) {
+        uint32_t tables = 0;
+        if (sections & (SECTION_SUMMARY | SECTION_CLIENTS | SECTION_SCANNERS)) { tables |= TABLE_CLIENTS; }
+        if (sections & SECTION_URIS) { tables |= TABLE_URIS; }
+        if (sections & SECTION_TIME_SERIES) { tables |= TABLE_TIME_SERIES; }
+
+        return tables;
+    }
+
+    /**
+     * @brief Header-only implementation of the markdown report renderer.
+     *
+     * Rows are formatted straight in to the output's buffers; nothing is rendered in to intermediate strings.
+     */
+    class ReportRenderer final {
+        public: // +++ Static +++
+            static constexpr uint16_t CLIENT_STATUS_COLUMNS[] = { 200, 204, 301, 400, 401, 403, 404, 500, 503 }; //!< The status codes shown per client
+            static constexpr uint64_t SCANNER_MIN_CLIENT_ERRORS = 20; //!< The number of 4xx responses after which a client is considered a scanner
+
+        public: // +++ Constructor / Destructor +++
+            ReportRenderer(const RequestAggregator& aggregator, ReportOutput& output): m_aggregator(aggregator), m_output(output) {}
+            ReportRenderer(const ReportRenderer&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Renders the report.
+             *
+             * @param sections The ReportSections to render.
+             */
+            void render(uint32_t sections = SECTION_ALL) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::RENDER);
+                m_output.write("# HTTPD Report\n");
+                if (sections & SECTION_SUMMARY) {
+                    m_output.print("## Total Requests: {0:d}\n## Total Unique IPs: {1:d}\n", m_aggregator.getTotalRequests(), m_aggregator.getClientCount());
+                }
+                m_output.write("\n");
+
+                if (sections & SECTION_CLIENTS) { renderClientTable(); }
+                if (sections & SECTION_URIS) { renderUriTable(); }
+                if (sections & SECTION_TIME_SERIES) { renderTimeSeries(); }
+                if (sections & SECTION_SCANNERS) { renderScanners(); }
+            }
+
+            /**
+             * @brief Renders the status code table per client, busiest clients first.
+             */
+            void renderClientTable() {
+                const auto order = getOrderByRequests(
+                    m_aggregator.getClientCount(), [this](uint32_t id) { return m_aggregator.getClient(id).requests; },
+                    [this](uint32_t id) { return m_aggregator.getClientName(id); }
+                );
+
+                size_t sourceWidth = 6;
+                for (const auto id : order) { sourceWidth = std::max(sourceWidth, m_aggregator.getClientName(id).size()); }
+
+                m_output.print("## Clients\n\n| {0:<{1}} | Requests |", "Source", sourceWidth);
+                for (const auto status : CLIENT_STATUS_COLUMNS) { m_output.print(" Total {0:d} |", status); }
+                m_output.print("\n|{0:-<{1}}|----------|", "", sourceWidth + 2);
+                for (size_t i = 0; i < std::size(CLIENT_STATUS_COLUMNS); i++) { m_output.write("-----------|"); }
+                m_output.write("\n");
+
+                for (const auto id : order) {
+                    const auto& client = m_aggregator.getClient(id);
+                    m_output.print("| {0:<{1}} | {2:>8d} |", m_aggregator.getClientName(id), sourceWidth, client.requests);
+                    for (const auto status : CLIENT_STATUS_COLUMNS) { m_output.print(" {0:>9d} |", client.getStatusCount(status)); }
+                    m_output.write("\n");
+                }
+
+                m_output.write("\n");
+            }
+
+            /**
+             * @brief Renders the per-URI table, most requested URIs first.
+             */
+            void renderUriTable() {
+                const auto order = getOrderByRequests(
+                    m_aggregator.getUriCount(), [this](uint32_t id) { return m_aggregator.getUriStats(id).requests; },
+                    [this](uint32_t id) { return m_aggregator.getUri(id); }
+                );
+
+                m_output.write("## URIs\n\n| URI | Requests | Bytes | 1xx | 2xx | 3xx | 4xx | 5xx |\n|-----|----------|-------|-----|-----|-----|-----|-----|\n");
+                for (const auto id : order) {
+                    const auto& uri = m_aggregator.getUriStats(id);
+                    m_output.print("| {0:s} ", m_aggregator.getUri(id));
+                    renderCounters(uri);
+                }
+
+                m_output.write("\n");
+            }
+
+            /**
+             * @brief Renders the per-minute time series in chronological order.
+             */
+            void renderTimeSeries() {
+                m_output.write("## Requests per Minute\n\n| Minute (UTC) | Requests | Bytes | 1xx | 2xx | 3xx | 4xx | 5xx |\n|--------------|----------|-------|-----|-----|-----|-----|-----|\n");
+                for (const auto& bucket : m_aggregator.getTimeSeries()) {
+                    m_output.print("| {0:%Y-%m-%d %H:%M} ", fmt::gmtime(static_cast<time_t>(bucket.first)));
+                    renderCounters(bucket.second);
+                }
+
+                m_output.write("\n");
+            }
+
+            /**
+             * @brief Renders the clients which received the most client errors (4xx), i.e. likely vulnerability scanners.
+             */
+            void renderScanners() {
+                vector<pair<uint64_t, uint32_t>> scanners;
+                for (uint32_t id = 0; id < m_aggregator.getClientCount(); id++) {
+                    uint64_t clientErrors = 0;
+                    for (const auto& status : m_aggregator.getClient(id).statusCounts) {
+                        if (getStatusClass(status.first) == 4) { clientErrors += status.second; }
+                    }
+
+                    if (clientErrors >= SCANNER_MIN_CLIENT_ERRORS) { scanners.emplace_back(clientErrors, id); }
+                }
+
+                // ties by name, so the table doesn't depend on the order clients were first seen in
+                std::sort(scanners.begin(), scanners.end(), [this](const auto& a, const auto& b) {
+                    return a.first != b.first ? a.first > b.first : m_aggregator.getClientName(a.second) < m_aggregator.getClientName(b.second);
+                });
+
+                m_output.write("## Suspected Scanners\n\n| Source | Requests | 4xx | 4xx % |\n|--------|----------|-----|-------|\n");
+                for (const auto& scanner : scanners) {
+                    const auto& client = m_aggregator.getClient(scanner.second);
+                    m_output.print("| {0:s} | {1:d} | {2:d} | {3:.1f} |\n", m_aggregator.getClientName(scanner.second), client.requests, scanner.first,
+                        100.0 * static_cast<double>(scanner.first) / static_cast<double>(client.requests));
+                }
+
+                m_output.write("\n");
+            }
+
+        private: // +++ Private Business +++
+            template<typename Counters>
+            void renderCounters(const Counters& counters) {
+                m_output.print(
+                    "| {0:d} | {1:d} | {2:d} | {3:d} | {4:d} | {5:d} | {6:d} |\n",
+                    counters.requests, counters.bytes, counters.statusClasses[1], counters.statusClasses[2],
+                    counters.statusClasses[3], counters.statusClasses[4], counters.statusClasses[5]
+                );
+            }
+
+            /**
+             * @brief Gets the IDs ordered by requests, descending, and ties by name.
+             *
+             * IDs are assigned in the order values were first seen, which differs between a single pass and merged partials;
+             * ordering ties by name renders identical tables identically either way.
+             */
+            template<typename GetRequests, typename GetName>
+            static vector<uint32_t> getOrderByRequests(size_t count, GetRequests&& getRequests, GetName&& getName) {
+                vector<uint32_t> order(count);
+                std::iota(order.begin(), order.end(), 0);
+                std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                    const auto requestsA = getRequests(a);
+                    const auto requestsB = getRequests(b);
+
+                    return requestsA != requestsB ? requestsA > requestsB : getName(a) < getName(b);
+                });
+
+                return order;
+            }
+
+        private:
+            const RequestAggregator&    m_aggregator;
+            ReportOutput&               m_output;
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_REPORTRENDERER_HPP
@@ -0,0 +1,287 @@
+/**
+ * @file ReportWorker.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the worker of a distributed run, which aggregates the file ranges a coordinator assigns and returns a snapshot.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_REPORTWORKER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_REPORTWORKER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "AggregateSnapshot.hpp"
+#include "LogReader.hpp"
+#include "PipelineStats.hpp"
+#include "Probes.hpp"
+#include "RequestAggregator.hpp"
+#include "WorkProtocol.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using fmt::format;
+
+    using std::string;
+    using std::string_view;
+    using std::unique_ptr;
+
+    /**
+     * @brief Header-only implementation of a distributed run's worker.
+     *
+     * The worker reads the ranges it is assigned from its local file system, one at a time, in to a single set of tables.
+     * Between chunks it answers the coordinator's requests to give up the unread half of its range to an idle worker.
+     * Once the coordinator runs out of work, the tables are sent back as a binary snapshot.
+     */
+    class ReportWorker final {
+        public: // +++ Static +++
+            static constexpr uint64_t MIN_SPLIT_BYTES = 4 << 20; //!< Ranges with less left to read aren't split
+            static constexpr int32_t CONNECT_RETRY_MS = 250; //!< How long to wait between attempts to reach the coordinator
+            static constexpr int32_t CONNECT_ATTEMPTS = 40; //!< The coordinator may be started after its workers
+
+        public: // +++ Constructor / Destructor +++
+            ReportWorker() = default;
+            ReportWorker(const ReportWorker&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Connects to the coordinator and works until it sends FINISH.
+             *
+             * @return true If the snapshot was delivered. Otherwise getLastError() contains the reason.
+             */
+            bool run(const string& host, const string& port) {
+                if (!connectTo(host, port)) { return false; }
+
+                char hostName[256] = {0};
+                gethostname(hostName, sizeof(hostName) - 1);
+                if (!m_connection->sendLine(format("HELLO {0:s}:{1:d}", hostName, getpid()))) { return fail("lost the connection to the coordinator"); }
+
+                string line;
+                while (true) {
+                    if (!m_connection->nextLine(line)) {
+                        if (!m_connection->receive()) { return fail("the coordinator closed the connection"); }
+                        continue;
+                    }
+
+                    if (line.rfind("WORK ", 0) == 0) {
+                        if (!work(line)) { return false; }
+                    } else if (line.rfind("SPLIT ", 0) == 0) {
+                        // the range was finished before the request arrived
+                        if (!m_connection->sendLine("KEEP " + line.substr(6))) { return fail("lost the connection to the coordinator"); }
+                    } else if (line == "FINISH") {
+                        return sendSnapshot();
+                    }
+                }
+            }
+
+            /**
+             * @brief Times reading and writing the snapshot in to the given statistics; nullptr disables timing.
+             */
+            void setStats(PipelineStats* stats) {
+                m_stats = stats;
+                m_reader.setStats(stats);
+            }
+
+            uint64_t getRangesRead() const { return m_rangesRead; } //!< Gets the number of ranges read
+            uint64_t getRejectedLines() const { return m_rejectedLines; } //!< Gets the number of malformed lines
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            bool fail(const string& error) {
+                m_lastError = error;
+                return false;
+            }
+
+            bool connectTo(const string& host, const string& port) {
+                addrinfo hints{};
+                hints.ai_family = AF_UNSPEC;
+                hints.ai_socktype = SOCK_STREAM;
+
+                addrinfo* addresses = nullptr;
+                if (const auto result = getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses); result != 0) { return fail(gai_strerror(result)); }
+
+                for (auto attempt = 0; attempt < CONNECT_ATTEMPTS && !m_connection; attempt++) {
+                    if (attempt > 0) { std::this_thread::sleep_for(std::chrono::milliseconds(CONNECT_RETRY_MS)); }
+
+                    for (auto* address = addresses; address != nullptr; address = address->ai_next) {
+                        const auto fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+                        if (fd < 0) { continue; }
+
+                        if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+                            m_connection = std::make_unique<WorkConnection>(fd);
+                            break;
+                        }
+
+                        m_lastError = strerror(errno);
+                        close(fd);
+                    }
+                }
+
+                freeaddrinfo(addresses);
+                return m_connection != nullptr;
+            }
+
+            /**
+             * @brief Reads the range of a WORK message and reports the outcome.
+             *
+             * @return false If the connection broke or the range was only read in part, which the coordinator must redo elsewhere.
+             */
+            bool work(const string& message) {
+                // WORK <id> <start> <end> <path>; the path may contain spaces
+                char* cursor = nullptr;
+                const auto id = std::strtoull(message.c_str() + 5, &cursor, 10);
+                const auto start = std::strtoull(cursor, &cursor, 10);
+                uint64_t end = std::strtoull(cursor, &cursor, 10);
+                const fs::path path(*cursor == ' ' ? cursor + 1 : cursor);
+
+                const auto linesBefore = m_linesRead;
+                bool success = false;
+                if (LogReader::isGzipFile(path)) {
+                    // compressed files are never split; the coordinator decides whether they're read at all
+                    if (start == 0) {
+                        success = m_reader.readFile(path, [&](string_view line) { handleLine(line); });
+                    } else {
+                        errno = ESPIPE;
+                    }
+                } else {
+                    struct stat info{};
+                    const auto fileSize = stat(path.c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+
+                    bool connected = true;
+                    success = m_reader.readRange(path, start, [&](string_view line) { handleLine(line); }, [&](uint64_t offset) {
+                        connected = connected && answerSplitRequests(id, offset, std::min(end, std::max(fileSize, offset)), end);
+                        return end;
+                    });
+                    if (!connected) { return fail("lost the connection to the coordinator"); }
+                }
+
+                // another worker can only retry a range this one didn't read any of; otherwise these tables are spoilt
+                if (!success && m_linesRead != linesBefore) { return fail(format("failed to read {0:s}: {1:s}", path.string(), strerror(errno))); }
+
+                if (success) { m_rangesRead++; }
+                const auto reply = success ? format("DONE {0:d}", id) : format("FAILED {0:d} {1:s}", id, strerror(errno));
+
+                return m_connection->sendLine(reply) || fail("lost the connection to the coordinator");
+            }
+
+            /**
+             * @brief Answers any SPLIT requests received while reading, without waiting for new ones.
+             *
+             * @param offset The next unread line of the current range.
+             * @param knownEnd The end of the range, limited to the file's size.
+             * @param end Receives the new end of the range if it is split.
+             */
+            bool answerSplitRequests(uint64_t id, uint64_t offset, uint64_t knownEnd, uint64_t& end) {
+                pollfd fd{ m_connection->getFd(), POLLIN, 0 };
+                if (::poll(&fd, 1, 0) <= 0) { return true; }
+                if (!m_connection->receive()) { return false; }
+
+                string line;
+                while (m_connection->nextLine(line)) {
+                    if (line.rfind("SPLIT ", 0) != 0) { continue; }
+
+                    const auto splitId = std::strtoull(line.c_str() + 6, nullptr, 10);
+                    if (splitId != id || knownEnd <= offset || knownEnd - offset < MIN_SPLIT_BYTES) {
+                        if (!m_connection->sendLine(format("KEEP {0:d}", splitId))) { return false; }
+                        continue;
+                    }
+
+                    // the ranges meet at an arbitrary byte; readRange assigns the line crossing it to this range
+                    end = offset + (knownEnd - offset) / 2;
+                    knownEnd = end;
+                    if (!m_connection->sendLine(format("SPLIT {0:d} {1:d}", id, end))) { return false; }
+                }
+
+                return true;
+            }
+
+            void handleLine(string_view line) {
+                m_linesRead++;
+                if (!parseRequestRecord(line, m_record, FIELD_ALL)) {
+                    HTTPDREPORT_PROBE2(reject, line.data(), line.size());
+                    m_rejectedLines++;
+                    return;
+                }
+
+                m_aggregator.add(m_record);
+            }
+
+            bool sendSnapshot() {
+                char snapshotPath[] = "/tmp/httpd-hit-report-worker-XXXXXX";
+                const auto fd = mkstemp(snapshotPath);
+                if (fd < 0) { return fail(format("failed to create a temporary file: {0:s}", strerror(errno))); }
+
+                PipelineStats::Timer timer(m_stats, PipelineStage::EXPORT);
+                const auto written = SnapshotWriter::write(m_aggregator, snapshotPath);
+                timer.stop();
+                unlink(snapshotPath);
+
+                struct stat info{};
+                if (!written || fstat(fd, &info) != 0) {
+                    close(fd);
+                    return fail(format("failed to write the snapshot: {0:s}", strerror(errno)));
+                }
+
+                const auto size = static_cast<uint64_t>(info.st_size);
+                const auto sent = m_connection->sendLine(format("SNAPSHOT {0:d} {1:d}", size, m_rejectedLines)) && m_connection->sendFile(fd, size);
+                close(fd);
+                if (!sent) { return fail("lost the connection to the coordinator"); }
+
+                // wait for the coordinator to hang up, so the last bytes aren't lost to a reset
+                shutdown(m_connection->getFd(), SHUT_WR);
+                while (m_connection->receive()) {}
+
+                return true;
+            }
+
+        private:
+            unique_ptr<WorkConnection>  m_connection{};
+            LogReader                   m_reader{};
+            PipelineStats*              m_stats{nullptr};
+
+            RequestAggregator           m_aggregator{};
+            RequestRecord               m_record{};
+
+            uint64_t                    m_rangesRead{0};
+            uint64_t                    m_linesRead{0};
+            uint64_t                    m_rejectedLines{0};
+
+            string                      m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_REPORTWORKER_HPP
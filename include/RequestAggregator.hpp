@@ -0,0 +1,262 @@
+/**
+ * @file RequestAggregator.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the aggregate tables (per client, per URI and per minute) built from parsed requests.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_REQUESTAGGREGATOR_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_REQUESTAGGREGATOR_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+// libc
+#include <stdint.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "AllocationCounter.hpp"
+#include "Probes.hpp"
+#include "StringInterner.hpp"
+
+namespace httpdreport {
+
+    using std::array;
+    using std::map;
+    using std::pair;
+    using std::vector;
+
+    using StatusClassCounts = array<uint64_t, 6>; //!< Request counts by status class; index 1 is 1xx, ... index 5 is 5xx. Index 0 counts anything else.
+
+    /**
+     * @brief Gets the index in to a StatusClassCounts array for a given status code.
+     */
+    inline size_t getStatusClass(uint16_t statusCode) { return (statusCode >= 100 && statusCode < 600) ? statusCode / 100 : 0; }
+
+    /**
+     * @brief The tables a RequestAggregator maintains.
+     */
+    enum AggregateTables : uint32_t {
+        TABLE_CLIENTS       = 1 << 0, //!< Per-client statistics
+        TABLE_URIS          = 1 << 1, //!< Per-URI statistics
+        TABLE_TIME_SERIES   = 1 << 2, //!< Per-minute statistics
+
+        TABLE_ALL           = TABLE_CLIENTS | TABLE_URIS | TABLE_TIME_SERIES
+    };
+
+    /**
+     * @brief Aggregated statistics for a single client.
+     */
+    struct ClientStats final {
+        ClientAddress                   address{}; //!< The client's binary address (all zeroes for host names)
+        uint64_t                        requests{0}; //!< The total number of requests
+        uint64_t                        bytes{0}; //!< The total number of response bytes
+        int64_t                         firstSeen{std::numeric_limits<int64_t>::max()}; //!< Epoch of the first request
+        int64_t                         lastSeen{std::numeric_limits<int64_t>::min()}; //!< Epoch of the last request
+        vector<pair<uint16_t, uint64_t>> statusCounts{}; //!< Number of requests per status code; clients only ever see a handful
+
+        void addStatus(uint16_t statusCode, uint64_t count = 1) {
+            for (auto& entry : statusCounts) {
+                if (entry.first == statusCode) { entry.second += count; return; }
+            }
+
+            statusCounts.emplace_back(statusCode, count);
+        }
+
+        uint64_t getStatusCount(uint16_t statusCode) const {
+            for (const auto& entry : statusCounts) {
+                if (entry.first == statusCode) { return entry.second; }
+            }
+
+            return 0;
+        }
+    };
+
+    /**
+     * @brief Aggregated statistics for a single request URI.
+     */
+    struct UriStats final {
+        uint64_t            requests{0}; //!< The total number of requests
+        uint64_t            bytes{0}; //!< The total number of response bytes
+        StatusClassCounts   statusClasses{}; //!< Requests per status class
+    };
+
+    /**
+     * @brief Aggregated statistics for a single time bucket (one minute).
+     */
+    struct TimeBucket final {
+        uint64_t            requests{0}; //!< The total number of requests
+        uint64_t            bytes{0}; //!< The total number of response bytes
+        StatusClassCounts   statusClasses{}; //!< Requests per status class
+    };
+
+    /**
+     * @brief Header-only implementation of the aggregate tables every report is rendered from.
+     *
+     * Clients and URIs are interned once and their statistics are kept in dense vectors indexed by the interned ID.
+     */
+    class RequestAggregator final {
+        public: // +++ Static +++
+            static constexpr int64_t TIME_BUCKET_SECONDS = 60; //!< The resolution of the time series
+
+        public: // +++ Constructor / Destructor +++
+            explicit RequestAggregator(uint32_t tables = TABLE_ALL): m_tables(tables) {}
+            RequestAggregator(const RequestAggregator&) = delete;
+            RequestAggregator(RequestAggregator&&) = default;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Adds a single parsed request to all tables.
+             *
+             * @param weight The number of requests the record stands for, e.g. the sampling rate of a sampled input.
+             */
+            void add(const RequestRecord& record, uint64_t weight = 1) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::TABLES);
+                const auto statusClass = getStatusClass(record.statusCode);
+
+                if (m_tables & TABLE_CLIENTS) {
+                    const auto clientId = m_clientNames.intern(record.clientSource);
+                    if (clientId == m_clients.size()) {
+                        m_clients.emplace_back();
+                        m_clients.back().address = record.clientAddress;
+                    }
+
+                    auto& client = m_clients[clientId];
+                    client.requests += weight;
+                    client.bytes += static_cast<uint64_t>(record.responseSize) * weight;
+                    client.firstSeen = std::min(client.firstSeen, record.epoch);
+                    client.lastSeen = std::max(client.lastSeen, record.epoch);
+                    client.addStatus(record.statusCode, weight);
+                }
+
+                if (m_tables & TABLE_URIS) {
+                    const auto uriId = m_uriNames.intern(record.requestUri);
+                    if (uriId == m_uris.size()) { m_uris.emplace_back(); }
+
+                    auto& uri = m_uris[uriId];
+                    uri.requests += weight;
+                    uri.bytes += static_cast<uint64_t>(record.responseSize) * weight;
+                    uri.statusClasses[statusClass] += weight;
+                }
+
+                if (m_tables & TABLE_TIME_SERIES) {
+                    // logs are (mostly) chronological, so the previous bucket is nearly always the right one
+                    const auto bucketStart = record.epoch - floorMod(record.epoch, TIME_BUCKET_SECONDS);
+                    if (m_lastBucket == nullptr || m_lastBucketStart != bucketStart) {
+                        m_lastBucket = &m_timeSeries[bucketStart];
+                        m_lastBucketStart = bucketStart;
+                    }
+
+                    auto& bucket = *m_lastBucket;
+                    bucket.requests += weight;
+                    bucket.bytes += static_cast<uint64_t>(record.responseSize) * weight;
+                    bucket.statusClasses[statusClass] += weight;
+                }
+
+                m_totalRequests += weight;
+            }
+
+            /**
+             * @brief Merges all tables of another aggregator in to this one.
+             */
+            void merge(const RequestAggregator& other) {
+                HTTPDREPORT_PROBE2(merge_start, m_totalRequests, m_clients.size());
+                for (uint32_t i = 0; i < other.m_clients.size(); i++) { mergeClient(other.m_clientNames.get(i), other.m_clients[i]); }
+                for (uint32_t i = 0; i < other.m_uris.size(); i++) { mergeUri(other.m_uriNames.get(i), other.m_uris[i]); }
+                for (const auto& bucket : other.m_timeSeries) { mergeTimeBucket(bucket.first, bucket.second); }
+
+                mergeRequestCount(other.m_totalRequests);
+                HTTPDREPORT_PROBE2(merge_end, m_totalRequests, m_clients.size());
+            }
+
+            /**
+             * @brief Merges a client's statistics in to the clients table, e.g. when restoring saved tables.
+             */
+            void mergeClient(string_view source, const ClientStats& theirs) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::TABLES);
+                const auto clientId = m_clientNames.intern(source);
+                if (clientId == m_clients.size()) {
+                    m_clients.emplace_back();
+                    m_clients.back().address = theirs.address;
+                }
+
+                auto& ours = m_clients[clientId];
+                ours.requests += theirs.requests;
+                ours.bytes += theirs.bytes;
+                ours.firstSeen = std::min(ours.firstSeen, theirs.firstSeen);
+                ours.lastSeen = std::max(ours.lastSeen, theirs.lastSeen);
+                for (const auto& status : theirs.statusCounts) { ours.addStatus(status.first, status.second); }
+            }
+
+            void mergeUri(string_view uri, const UriStats& theirs) { //!< Merges a URI's statistics in to the URIs table
+                const AllocationCounter::Scope allocationScope(AllocationTag::TABLES);
+                const auto uriId = m_uriNames.intern(uri);
+                if (uriId == m_uris.size()) { m_uris.emplace_back(); }
+                addCounters(m_uris[uriId], theirs);
+            }
+
+            void mergeTimeBucket(int64_t bucketStart, const TimeBucket& theirs) { //!< Merges a minute in to the time series
+                const AllocationCounter::Scope allocationScope(AllocationTag::TABLES);
+                addCounters(m_timeSeries[bucketStart], theirs);
+            }
+
+            void mergeRequestCount(uint64_t requests) { m_totalRequests += requests; } //!< Adds requests which were aggregated elsewhere to the total
+
+            uint64_t getTotalRequests() const { return m_totalRequests; } //!< Gets the number of requests aggregated
+
+            uint32_t getTables() const { return m_tables; } //!< Gets the AggregateTables maintained by this instance
+
+            size_t getClientCount() const { return m_clients.size(); } //!< Gets the number of unique clients
+            string_view getClientName(uint32_t id) const { return m_clientNames.get(id); } //!< Gets a client's source as logged
+            const ClientStats& getClient(uint32_t id) const { return m_clients[id]; } //!< Gets a client's statistics
+            bool findClient(string_view source, uint32_t& id) const { return m_clientNames.tryGetId(source, id); } //!< Looks up a client's ID by its source
+
+            size_t getUriCount() const { return m_uris.size(); } //!< Gets the number of unique URIs
+            string_view getUri(uint32_t id) const { return m_uriNames.get(id); } //!< Gets a URI by its ID
+            const UriStats& getUriStats(uint32_t id) const { return m_uris[id]; } //!< Gets a URI's statistics
+
+            const map<int64_t, TimeBucket>& getTimeSeries() const { return m_timeSeries; } //!< Gets the per-minute time series, keyed by bucket start
+
+        private: // +++ Private Business +++
+            static int64_t floorMod(int64_t value, int64_t divisor) { return ((value % divisor) + divisor) % divisor; }
+
+            template<typename Counters>
+            static void addCounters(Counters& ours, const Counters& theirs) {
+                ours.requests += theirs.requests;
+                ours.bytes += theirs.bytes;
+                for (size_t i = 0; i < ours.statusClasses.size(); i++) { ours.statusClasses[i] += theirs.statusClasses[i]; }
+            }
+
+        private:
+            uint32_t                    m_tables{TABLE_ALL};
+            uint64_t                    m_totalRequests{0};
+
+            StringInterner              m_clientNames{};
+            StringInterner              m_uriNames{};
+
+            vector<ClientStats>         m_clients{};
+            vector<UriStats>            m_uris{};
+
+            map<int64_t, TimeBucket>    m_timeSeries{};
+            int64_t                     m_lastBucketStart{0};
+            TimeBucket*                 m_lastBucket{nullptr};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_REQUESTAGGREGATOR_HPP
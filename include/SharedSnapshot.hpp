@@ -0,0 +1,326 @@
+/**
+ * @file SharedSnapshot.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the fixed-layout shared memory segment the daemon publishes its headline figures to, guarded by a seqlock.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_SHAREDSNAPSHOT_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_SHAREDSNAPSHOT_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "LiveAggregates.hpp"
+#include "MetricsRegistry.hpp"
+
+namespace httpdreport {
+
+    using std::atomic;
+    using std::condition_variable;
+    using std::mutex;
+    using std::pair;
+    using std::string;
+    using std::string_view;
+    using std::thread;
+    using std::unique_lock;
+    using std::unique_ptr;
+    using std::vector;
+
+    /**
+     * @brief A virtual host's totals as laid out in shared memory.
+     */
+    struct SharedVhost final {
+        char        name[64]; //!< NUL-terminated; truncated if longer
+        uint64_t    requests;
+        uint64_t    bytes;
+        uint64_t    statusClasses[6]; //!< See StatusClassCounts
+    };
+
+    /**
+     * @brief One of the busiest clients (within SharedSnapshotData::topWindowMinutes) as laid out in shared memory.
+     */
+    struct SharedClient final {
+        char        source[48]; //!< NUL-terminated; truncated if longer
+        uint64_t    requests;
+        uint64_t    bytes;
+    };
+
+    /**
+     * @brief The payload of the segment. Fixed layout, no pointers; readers copy it out as a whole.
+     */
+    struct SharedSnapshotData final {
+        static constexpr char       MAGIC[8] = { 'H', 'T', 'R', 'S', 'H', 'M', '0', '1' }; //!< Identifies the segment (and its layout version)
+        static constexpr uint32_t   MAX_VHOSTS = 512; //!< The busiest vhosts are kept if there are more
+        static constexpr uint32_t   MAX_TOP_CLIENTS = 64;
+
+        char            magic[8];
+        uint32_t        layoutSize; //!< sizeof(SharedSnapshotData) of the writer
+        uint32_t        topWindowMinutes; //!< The window topClients covers
+        int64_t         updatedAt; //!< When the segment was last written (seconds since the UNIX epoch)
+        int64_t         newestRequest; //!< The epoch of the newest request seen
+        uint64_t        totalRequests;
+        uint64_t        totalBytes;
+        uint64_t        rejectedLines;
+        uint64_t        statusClasses[6]; //!< See StatusClassCounts
+        uint32_t        vhostCount;
+        uint32_t        topClientCount;
+        SharedVhost     vhosts[MAX_VHOSTS]; //!< Busiest first
+        SharedClient    topClients[MAX_TOP_CLIENTS]; //!< Busiest first
+    };
+
+    static_assert(std::is_trivially_copyable_v<SharedSnapshotData>, "the shared layout must be copyable with memcpy");
+
+    /**
+     * @brief The segment: the seqlock's sequence number on its own cache line, followed by the payload.
+     */
+    struct SharedSnapshotSegment final {
+        alignas(64) atomic<uint64_t>    sequence; //!< Odd while the writer is updating the payload
+        alignas(64) SharedSnapshotData  data;
+    };
+
+    /**
+     * @brief Header-only implementation of the segment's writer; periodically publishes the daemon's figures on its own thread.
+     */
+    class SharedSnapshotWriter final {
+        public: // +++ Static +++
+            static constexpr int64_t TOP_WINDOW_MINUTES = 5; //!< The window the top clients are taken from
+            static constexpr std::chrono::milliseconds DEFAULT_UPDATE_INTERVAL{1000}; //!< How often the segment is updated by default
+
+        public: // +++ Constructor / Destructor +++
+            SharedSnapshotWriter(const LiveAggregates& aggregates, const MetricsRegistry& metrics): m_aggregates(aggregates), m_metrics(metrics) {}
+            SharedSnapshotWriter(const SharedSnapshotWriter&) = delete;
+            ~SharedSnapshotWriter() { stop(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Creates (or reuses) the segment and starts updating it.
+             *
+             * @param name The POSIX shared memory name, e.g. /httpd-hit-report
+             * @param interval How often the segment is updated.
+             *
+             * @return true If the segment was mapped. Otherwise getLastError() contains the reason.
+             */
+            bool start(const string& name, std::chrono::milliseconds interval = DEFAULT_UPDATE_INTERVAL) {
+                const auto fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+                if (fd < 0 || ftruncate(fd, sizeof(SharedSnapshotSegment)) != 0) {
+                    m_lastError = strerror(errno);
+                    if (fd >= 0) { close(fd); }
+                    return false;
+                }
+
+                auto* mapping = mmap(nullptr, sizeof(SharedSnapshotSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                close(fd);
+                if (mapping == MAP_FAILED) {
+                    m_lastError = strerror(errno);
+                    return false;
+                }
+
+                m_segment = static_cast<SharedSnapshotSegment*>(mapping);
+                m_name = name;
+                m_next = std::make_unique<SharedSnapshotData>();
+
+                // the segment might be left over from a previous run; make sure readers don't wait for a writer which died mid-update
+                if (m_segment->sequence.load() & 1) { m_segment->sequence.fetch_add(1); }
+
+                m_stopRequested = false;
+                m_worker = thread([this, interval]() {
+                    unique_lock<mutex> lock(m_stopLock);
+                    do { update(); } while (!m_stopChanged.wait_for(lock, interval, [this]() { return m_stopRequested; }));
+                });
+
+                return true;
+            }
+
+            /**
+             * @brief Writes a final update, stops the thread and removes the segment.
+             */
+            void stop() {
+                if (m_worker.joinable()) {
+                    {
+                        unique_lock<mutex> lock(m_stopLock);
+                        m_stopRequested = true;
+                    }
+                    m_stopChanged.notify_all();
+                    m_worker.join();
+                    update();
+                }
+
+                if (m_segment != nullptr) {
+                    munmap(m_segment, sizeof(SharedSnapshotSegment));
+                    shm_unlink(m_name.c_str());
+                    m_segment = nullptr;
+                }
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            /**
+             * @brief Gathers the current figures, then copies them in to the segment under the seqlock.
+             */
+            void update() {
+                auto& data = *m_next;
+                std::memset(&data, 0, sizeof(data));
+                std::memcpy(data.magic, SharedSnapshotData::MAGIC, sizeof(data.magic));
+                data.layoutSize = sizeof(SharedSnapshotData);
+                data.topWindowMinutes = TOP_WINDOW_MINUTES;
+                data.updatedAt = static_cast<int64_t>(std::time(nullptr));
+
+                vector<pair<string, MetricsRegistry::VhostTotals>> vhosts;
+                for (auto& vhost : m_metrics.getVhostTotals(data.rejectedLines)) { vhosts.emplace_back(vhost.first, vhost.second); }
+                std::stable_sort(vhosts.begin(), vhosts.end(), [](const auto& a, const auto& b) { return a.second.requests > b.second.requests; });
+
+                for (const auto& vhost : vhosts) {
+                    data.totalRequests += vhost.second.requests;
+                    data.totalBytes += vhost.second.bytes;
+                    for (size_t i = 0; i < 6; i++) { data.statusClasses[i] += vhost.second.statusClasses[i]; }
+                    if (data.vhostCount == SharedSnapshotData::MAX_VHOSTS) { continue; }
+
+                    auto& shared = data.vhosts[data.vhostCount++];
+                    copyString(shared.name, vhost.first);
+                    shared.requests = vhost.second.requests;
+                    shared.bytes = vhost.second.bytes;
+                    for (size_t i = 0; i < 6; i++) { shared.statusClasses[i] = vhost.second.statusClasses[i]; }
+                }
+
+                m_aggregates.read([&](const LiveTables& tables) {
+                    data.newestRequest = tables.getTotals().getTotalRequests() > 0 ? tables.getNewestEpoch() : 0;
+                    for (const auto& client : tables.getClientWindow().getTop(SharedSnapshotData::MAX_TOP_CLIENTS, TOP_WINDOW_MINUTES * 60)) {
+                        auto& shared = data.topClients[data.topClientCount++];
+                        copyString(shared.source, client.first);
+                        shared.requests = client.second.requests;
+                        shared.bytes = client.second.bytes;
+                    }
+                });
+
+                // seqlock write: odd sequence, payload, even sequence
+                const auto sequence = m_segment->sequence.load(std::memory_order_relaxed);
+                m_segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                std::memcpy(&m_segment->data, &data, sizeof(data));
+                m_segment->sequence.store(sequence + 2, std::memory_order_release);
+            }
+
+            template<size_t N>
+            static void copyString(char (&destination)[N], string_view source) {
+                const auto length = std::min(source.size(), N - 1);
+                std::memcpy(destination, source.data(), length);
+                destination[length] = '\0';
+            }
+
+        private:
+            const LiveAggregates&           m_aggregates;
+            const MetricsRegistry&          m_metrics;
+
+            SharedSnapshotSegment*          m_segment{nullptr};
+            string                          m_name{};
+            unique_ptr<SharedSnapshotData>  m_next{}; //!< Too large for the stack of a thread
+
+            mutex                           m_stopLock{};
+            condition_variable              m_stopChanged{};
+            bool                            m_stopRequested{false};
+            thread                          m_worker{};
+
+            string                          m_lastError{};
+    };
+
+    /**
+     * @brief Header-only implementation of a reader of the segment. Once opened, reads take no system calls.
+     */
+    class SharedSnapshotReader final {
+        public: // +++ Static +++
+            static constexpr uint32_t MAX_READ_ATTEMPTS = 1000; //!< Reads give up if the writer keeps interfering (or died mid-update)
+
+        public: // +++ Constructor / Destructor +++
+            SharedSnapshotReader() = default;
+            SharedSnapshotReader(const SharedSnapshotReader&) = delete;
+            ~SharedSnapshotReader() { if (m_segment != nullptr) { munmap(const_cast<SharedSnapshotSegment*>(m_segment), sizeof(SharedSnapshotSegment)); } }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Maps the segment read-only.
+             *
+             * @return true If the segment exists and has the expected size.
+             */
+            bool open(const string& name) {
+                const auto fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+                if (fd < 0) { return false; }
+
+                struct stat info{};
+                if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedSnapshotSegment)) {
+                    close(fd);
+                    errno = EINVAL;
+                    return false;
+                }
+
+                auto* mapping = mmap(nullptr, sizeof(SharedSnapshotSegment), PROT_READ, MAP_SHARED, fd, 0);
+                close(fd);
+                if (mapping == MAP_FAILED) { return false; }
+
+                m_segment = static_cast<const SharedSnapshotSegment*>(mapping);
+                return true;
+            }
+
+            /**
+             * @brief Copies a consistent version of the payload.
+             *
+             * @return true If a consistent copy with the expected layout was read.
+             */
+            bool read(SharedSnapshotData& data) const {
+                for (uint32_t attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+                    const auto before = m_segment->sequence.load(std::memory_order_acquire);
+                    if (before & 1) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    std::memcpy(&data, &m_segment->data, sizeof(data));
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (m_segment->sequence.load(std::memory_order_relaxed) == before) {
+                        return before != 0 && std::memcmp(data.magic, SharedSnapshotData::MAGIC, sizeof(data.magic)) == 0 && data.layoutSize == sizeof(data);
+                    }
+                }
+
+                return false;
+            }
+
+        private:
+            const SharedSnapshotSegment*    m_segment{nullptr};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_SHAREDSNAPSHOT_HPP
@@ -0,0 +1,266 @@
+/**
+ * @file SlidingWindow.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the rolling-window counters (last minute up to the last hour) kept per key in rings of sub-buckets.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_SLIDINGWINDOW_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_SLIDINGWINDOW_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// libc
+#include <stdint.h>
+#include <time.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "RequestAggregator.hpp"
+#include "StringInterner.hpp"
+#include "TopN.hpp"
+
+namespace httpdreport {
+
+    using std::pair;
+    using std::string_view;
+    using std::unordered_map;
+    using std::vector;
+
+    /**
+     * @brief The counters kept per key and sub-bucket.
+     */
+    struct WindowCounters final {
+        uint64_t            requests{0}; //!< The number of requests
+        uint64_t            bytes{0}; //!< The number of response bytes
+        StatusClassCounts   statusClasses{}; //!< Requests per status class
+
+        void add(const WindowCounters& other) {
+            requests += other.requests;
+            bytes += other.bytes;
+            for (size_t i = 0; i < statusClasses.size(); i++) { statusClasses[i] += other.statusClasses[i]; }
+        }
+    };
+
+    /**
+     * @brief Header-only implementation of per-key rolling-window counters.
+     *
+     * Time is divided in to sub-buckets of SLOT_SECONDS, kept in a ring covering MAX_WINDOW_SECONDS. Nothing ever ticks:
+     * a slot is recycled when a request for a newer period lands on it, and queries simply skip slots outside their window.
+     * Any window (in multiples of SLOT_SECONDS) is therefore answered by visiting only its slots.
+     * Windows end at the newest request seen, so replayed logs give the same answers as live ones, or at the time advanceTo()
+     * moved them to if that is later; live inputs advance them to the clock, so windows keep moving while no requests arrive.
+     * Requests dated more than MAX_CLOCK_SKEW_SECONDS ahead of the clock are ignored: a single one would otherwise move all
+     * windows in to the future, past every request that follows.
+     */
+    class SlidingWindow final {
+        public: // +++ Static +++
+            static constexpr int64_t SLOT_SECONDS = 10; //!< The resolution of all windows
+            static constexpr size_t SLOT_COUNT = 360; //!< The number of sub-buckets in the ring
+            static constexpr int64_t MAX_WINDOW_SECONDS = SLOT_SECONDS * static_cast<int64_t>(SLOT_COUNT); //!< The longest window which can be queried
+            static constexpr int64_t MAX_CLOCK_SKEW_SECONDS = 300; //!< How far ahead of the clock a request may be dated
+
+        public: // +++ Constructor / Destructor +++
+            SlidingWindow(): m_slots(SLOT_COUNT) {}
+            SlidingWindow(const SlidingWindow&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Counts a request (or weight requests) for a key. Requests older than the ring's span or dated in the future are ignored.
+             */
+            void add(string_view key, const RequestRecord& record, uint64_t weight = 1) {
+                // the clock is only read for requests newer than every window's end, i.e. about once per second
+                if (record.epoch > m_endEpoch && record.epoch > static_cast<int64_t>(time(nullptr)) + MAX_CLOCK_SKEW_SECONDS) { return; }
+
+                auto* slot = getSlot(record.epoch);
+                if (slot == nullptr) { return; }
+
+                m_newestEpoch = std::max(m_newestEpoch, record.epoch);
+                m_endEpoch = std::max(m_endEpoch, record.epoch);
+
+                WindowCounters counters;
+                counters.requests = weight;
+                counters.bytes = static_cast<uint64_t>(record.responseSize) * weight;
+                counters.statusClasses[getStatusClass(record.statusCode)] = weight;
+
+                slot->totals.add(counters);
+                slot->keys[m_keys.intern(key)].add(counters);
+            }
+
+            /**
+             * @brief Merges the counters of another window in to this one.
+             */
+            void merge(const SlidingWindow& other) {
+                for (const auto& theirs : other.m_slots) {
+                    if (theirs.totals.requests == 0) { continue; }
+
+                    auto* ours = getSlot(theirs.start);
+                    if (ours == nullptr) { continue; }
+
+                    ours->totals.add(theirs.totals);
+                    for (const auto& key : theirs.keys) { ours->keys[m_keys.intern(other.m_keys.get(key.first))].add(key.second); }
+                }
+
+                m_newestEpoch = std::max(m_newestEpoch, other.m_newestEpoch);
+                m_endEpoch = std::max(m_endEpoch, other.m_endEpoch);
+            }
+
+            /**
+             * @brief Gets the counters of all keys within the last seconds.
+             */
+            WindowCounters getTotals(int64_t seconds) const {
+                WindowCounters totals;
+                forEachSlot(seconds, [&](const Slot& slot) { totals.add(slot.totals); });
+
+                return totals;
+            }
+
+            /**
+             * @brief Gets the counters of a single key within the last seconds.
+             *
+             * @return false If the key had no requests within that time.
+             */
+            bool getCounters(string_view key, int64_t seconds, WindowCounters& counters) const {
+                counters = WindowCounters{};
+
+                uint32_t id = 0;
+                if (!m_keys.tryGetId(key, id)) { return false; }
+
+                forEachSlot(seconds, [&](const Slot& slot) {
+                    if (const auto it = slot.keys.find(id); it != slot.keys.end()) { counters.add(it->second); }
+                });
+
+                return counters.requests > 0;
+            }
+
+            /**
+             * @brief Gets the keys with the most requests within the last seconds, most requests first.
+             *
+             * @remarks The views are valid for as long as this instance is.
+             */
+            vector<pair<string_view, WindowCounters>> getTop(size_t count, int64_t seconds) const {
+                unordered_map<uint32_t, WindowCounters> merged;
+                forEachSlot(seconds, [&](const Slot& slot) {
+                    for (const auto& key : slot.keys) { merged[key.first].add(key.second); }
+                });
+
+                struct ByRequests { bool operator()(const pair<uint32_t, WindowCounters>& a, const pair<uint32_t, WindowCounters>& b) const { return a.second.requests < b.second.requests; } };
+                // count comes from queries; there are never more results than keys
+                TopN<pair<uint32_t, WindowCounters>, ByRequests> top(std::min(count, merged.size()));
+                for (const auto& key : merged) { top.offer(key); }
+
+                vector<pair<string_view, WindowCounters>> result;
+                for (const auto& key : top.sorted()) { result.emplace_back(m_keys.get(key.first), key.second); }
+
+                return result;
+            }
+
+            /**
+             * @brief Calls visitor(slotStart, key, counters) for every key of every sub-bucket held, e.g. to save the window.
+             */
+            template<typename Visitor>
+            void forEachEntry(Visitor&& visitor) const {
+                for (const auto& slot : m_slots) {
+                    if (slot.totals.requests == 0) { continue; }
+                    for (const auto& key : slot.keys) { visitor(slot.start, m_keys.get(key.first), key.second); }
+                }
+            }
+
+            /**
+             * @brief Merges a key's counters in to the sub-bucket beginning at slotStart, e.g. when restoring a saved window.
+             */
+            void mergeEntry(int64_t slotStart, string_view key, const WindowCounters& counters) {
+                auto* slot = getSlot(slotStart);
+                if (slot == nullptr) { return; }
+
+                slot->totals.add(counters);
+                slot->keys[m_keys.intern(key)].add(counters);
+            }
+
+            void advanceTo(int64_t epoch) { m_endEpoch = std::max(m_endEpoch, epoch); } //!< Moves the end of all windows forward (never backwards)
+
+            /**
+             * @brief Sets the epoch of the newest request counted, e.g. when restoring a saved window; windows end there or later.
+             */
+            void restoreNewestEpoch(int64_t epoch) {
+                m_newestEpoch = std::max(m_newestEpoch, epoch);
+                advanceTo(epoch);
+            }
+
+            int64_t getNewestEpoch() const { return m_newestEpoch; } //!< Gets the epoch of the newest request counted
+            int64_t getEndEpoch() const { return m_endEpoch; } //!< Gets the end of all windows; the newest request or later
+
+        private: // +++ Private Business +++
+            struct Slot {
+                int64_t                                     start{std::numeric_limits<int64_t>::min()}; //!< The first second of the period held
+                WindowCounters                              totals{};
+                unordered_map<uint32_t, WindowCounters>     keys{}; //!< Counters per interned key
+            };
+
+            static int64_t floorDiv(int64_t value, int64_t divisor) { return value / divisor - ((value % divisor) < 0 ? 1 : 0); }
+
+            static size_t getSlotIndex(int64_t start) {
+                const auto slotCount = static_cast<int64_t>(SLOT_COUNT);
+                return static_cast<size_t>(((floorDiv(start, SLOT_SECONDS) % slotCount) + slotCount) % slotCount);
+            }
+
+            /**
+             * @brief Gets the slot for a point in time, recycling the slot if it still holds an older period.
+             *
+             * @return nullptr If the point in time is too far behind the end of the windows.
+             */
+            Slot* getSlot(int64_t epoch) {
+                const auto start = floorDiv(epoch, SLOT_SECONDS) * SLOT_SECONDS;
+                if (m_endEpoch != std::numeric_limits<int64_t>::min() && start <= m_endEpoch - MAX_WINDOW_SECONDS) { return nullptr; }
+
+                auto& slot = m_slots[getSlotIndex(start)];
+                if (slot.start != start) {
+                    if (slot.start > start) { return nullptr; }
+
+                    slot.start = start;
+                    slot.totals = WindowCounters{};
+                    slot.keys.clear();
+                }
+
+                return &slot;
+            }
+
+            template<typename Visitor>
+            void forEachSlot(int64_t seconds, Visitor&& visitor) const {
+                if (m_endEpoch == std::numeric_limits<int64_t>::min()) { return; }
+
+                const auto newestStart = floorDiv(m_endEpoch, SLOT_SECONDS) * SLOT_SECONDS;
+                const auto slots = std::clamp<int64_t>((seconds + SLOT_SECONDS - 1) / SLOT_SECONDS, 1, static_cast<int64_t>(SLOT_COUNT));
+                const auto oldestStart = newestStart - (slots - 1) * SLOT_SECONDS;
+
+                for (int64_t start = oldestStart; start <= newestStart; start += SLOT_SECONDS) {
+                    const auto& slot = m_slots[getSlotIndex(start)];
+                    if (slot.start == start) { visitor(slot); }
+                }
+            }
+
+        private:
+            StringInterner  m_keys{}; //!< Keys are interned once; slots only hold their IDs
+            vector<Slot>    m_slots{};
+            int64_t         m_newestEpoch{std::numeric_limits<int64_t>::min()}; //!< The newest request counted
+            int64_t         m_endEpoch{std::numeric_limits<int64_t>::min()}; //!< Where all windows end; the newest request or later
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_SLIDINGWINDOW_HPP
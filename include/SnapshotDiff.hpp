@@ -0,0 +1,229 @@
+/**
+ * @file SnapshotDiff.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the comparison of two aggregate snapshots ("what changed since yesterday").
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_SNAPSHOTDIFF_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_SNAPSHOTDIFF_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AggregateSnapshot.hpp"
+#include "ReportOutput.hpp"
+#include "TopN.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using std::string;
+    using std::vector;
+
+    /**
+     * @brief Header-only implementation of the snapshot comparison.
+     *
+     * Both snapshots are walked section by section as a sorted merge-join, so memory use is bounded
+     * by the number of rows shown rather than the size of the snapshots.
+     */
+    class SnapshotDiff final {
+        public: // +++ Static +++
+            static constexpr uint64_t MIN_COUNT_FOR_RELATIVE = 10; //!< Keys with fewer old requests are left out of the relative ranking
+
+        public: // +++ Constructor / Destructor +++
+            SnapshotDiff(ReportOutput& output, size_t topCount): m_output(output), m_topCount(topCount) {}
+            SnapshotDiff(const SnapshotDiff&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Compares two snapshots and renders the differences.
+             *
+             * @return true If both snapshots were read completely. Otherwise getLastError() contains the reason.
+             */
+            bool compare(const fs::path& oldPath, const fs::path& newPath) {
+                SnapshotReader oldSnapshot;
+                SnapshotReader newSnapshot;
+                if (!oldSnapshot.open(oldPath)) { return fail("not a valid snapshot: " + oldPath.string()); }
+                if (!newSnapshot.open(newPath)) { return fail("not a valid snapshot: " + newPath.string()); }
+
+                m_output.print("# HTTPD Report Diff\n\nOld: {0:s}  \nNew: {1:s}\n\n", oldPath.string(), newPath.string());
+
+                if (!oldSnapshot.beginSection(SnapshotSection::CLIENTS) || !newSnapshot.beginSection(SnapshotSection::CLIENTS)) { return fail("missing client table"); }
+                if (!compareSection<SnapshotClient>("Clients", oldSnapshot, newSnapshot,
+                    [](const SnapshotClient& entry) -> const string& { return entry.source; },
+                    [](const SnapshotClient& entry) { return entry.stats.requests; })) {
+                    return fail("failed to read client table");
+                }
+
+                if (!oldSnapshot.beginSection(SnapshotSection::URIS) || !newSnapshot.beginSection(SnapshotSection::URIS)) { return fail("missing URI table"); }
+                if (!compareSection<SnapshotUri>("URIs", oldSnapshot, newSnapshot,
+                    [](const SnapshotUri& entry) -> const string& { return entry.uri; },
+                    [](const SnapshotUri& entry) { return entry.stats.requests; })) {
+                    return fail("failed to read URI table");
+                }
+
+                if (!oldSnapshot.beginSection(SnapshotSection::STATUSES) || !newSnapshot.beginSection(SnapshotSection::STATUSES)) { return fail("missing status table"); }
+                return compareStatuses(oldSnapshot, newSnapshot) || fail("failed to read status table");
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            struct KeyDelta {
+                string      key{};
+                uint64_t    oldCount{0};
+                uint64_t    newCount{0};
+
+                int64_t getDelta() const { return static_cast<int64_t>(newCount) - static_cast<int64_t>(oldCount); }
+                double getRelative() const { return oldCount == 0 ? 0.0 : static_cast<double>(getDelta()) / static_cast<double>(oldCount); }
+            };
+
+            struct ByIncrease { bool operator()(const KeyDelta& a, const KeyDelta& b) const { return a.getDelta() < b.getDelta(); } };
+            struct ByDecrease { bool operator()(const KeyDelta& a, const KeyDelta& b) const { return a.getDelta() > b.getDelta(); } };
+            struct ByRelative { bool operator()(const KeyDelta& a, const KeyDelta& b) const { return std::fabs(a.getRelative()) < std::fabs(b.getRelative()); } };
+            struct ByNewCount { bool operator()(const KeyDelta& a, const KeyDelta& b) const { return a.newCount < b.newCount; } };
+            struct ByOldCount { bool operator()(const KeyDelta& a, const KeyDelta& b) const { return a.oldCount < b.oldCount; } };
+
+            bool fail(const string& reason) {
+                m_lastError = reason;
+                return false;
+            }
+
+            /**
+             * @brief Walks one key-ordered section of both snapshots and renders its largest changes.
+             */
+            template<typename Entry, typename GetKey, typename GetCount>
+            bool compareSection(const char* title, SnapshotReader& oldSnapshot, SnapshotReader& newSnapshot, GetKey&& getKey, GetCount&& getCount) {
+                TopN<KeyDelta, ByIncrease> increases(m_topCount);
+                TopN<KeyDelta, ByDecrease> decreases(m_topCount);
+                TopN<KeyDelta, ByRelative> relative(m_topCount);
+                TopN<KeyDelta, ByNewCount> appeared(m_topCount);
+                TopN<KeyDelta, ByOldCount> vanished(m_topCount);
+                uint64_t oldTotal = 0, newTotal = 0, appearedKeys = 0, vanishedKeys = 0;
+
+                const auto offer = [&](auto& top, KeyDelta& delta, const string& key) {
+                    if (top.wouldKeep(delta)) {
+                        delta.key = key;
+                        top.offer(delta);
+                    }
+                };
+
+                Entry oldEntry, newEntry;
+                bool hasOld = oldSnapshot.next(oldEntry);
+                bool hasNew = newSnapshot.next(newEntry);
+                while (hasOld || hasNew) {
+                    KeyDelta delta;
+                    if (hasOld && (!hasNew || getKey(oldEntry) < getKey(newEntry))) {
+                        delta.oldCount = getCount(oldEntry);
+                        vanishedKeys++;
+                        offer(vanished, delta, getKey(oldEntry));
+                        offer(decreases, delta, getKey(oldEntry));
+                        hasOld = oldSnapshot.next(oldEntry);
+                    } else if (hasNew && (!hasOld || getKey(newEntry) < getKey(oldEntry))) {
+                        delta.newCount = getCount(newEntry);
+                        appearedKeys++;
+                        offer(appeared, delta, getKey(newEntry));
+                        offer(increases, delta, getKey(newEntry));
+                        hasNew = newSnapshot.next(newEntry);
+                    } else {
+                        delta.oldCount = getCount(oldEntry);
+                        delta.newCount = getCount(newEntry);
+                        if (delta.getDelta() > 0) { offer(increases, delta, getKey(newEntry)); }
+                        if (delta.getDelta() < 0) { offer(decreases, delta, getKey(newEntry)); }
+                        if (delta.getDelta() != 0 && delta.oldCount >= MIN_COUNT_FOR_RELATIVE) { offer(relative, delta, getKey(newEntry)); }
+                        hasOld = oldSnapshot.next(oldEntry);
+                        hasNew = newSnapshot.next(newEntry);
+                    }
+
+                    oldTotal += delta.oldCount;
+                    newTotal += delta.newCount;
+                }
+
+                m_output.print("## {0:s}\n\nRequests: {1:d} → {2:d} ({3:+d})  \nNew keys: {4:d}  \nVanished keys: {5:d}\n\n", title, oldTotal, newTotal,
+                    static_cast<int64_t>(newTotal) - static_cast<int64_t>(oldTotal), appearedKeys, vanishedKeys);
+                renderDeltas("Largest increases", increases.sorted());
+                renderDeltas("Largest decreases", decreases.sorted());
+                renderDeltas("Largest relative changes", relative.sorted());
+                renderDeltas("New", appeared.sorted());
+                renderDeltas("Vanished", vanished.sorted());
+
+                return oldSnapshot.good() && newSnapshot.good();
+            }
+
+            /**
+             * @brief Renders the complete status code table; there are only ever a few dozen codes.
+             */
+            bool compareStatuses(SnapshotReader& oldSnapshot, SnapshotReader& newSnapshot) {
+                m_output.write("## Status Codes\n\n| Status | Old | New | Δ | Δ % |\n|--------|-----|-----|---|-----|\n");
+
+                SnapshotStatus oldEntry, newEntry;
+                bool hasOld = oldSnapshot.next(oldEntry);
+                bool hasNew = newSnapshot.next(newEntry);
+                while (hasOld || hasNew) {
+                    KeyDelta delta;
+                    uint16_t statusCode = 0;
+                    if (hasOld && (!hasNew || oldEntry.statusCode < newEntry.statusCode)) {
+                        statusCode = oldEntry.statusCode;
+                        delta.oldCount = oldEntry.requests;
+                        hasOld = oldSnapshot.next(oldEntry);
+                    } else if (hasNew && (!hasOld || newEntry.statusCode < oldEntry.statusCode)) {
+                        statusCode = newEntry.statusCode;
+                        delta.newCount = newEntry.requests;
+                        hasNew = newSnapshot.next(newEntry);
+                    } else {
+                        statusCode = newEntry.statusCode;
+                        delta.oldCount = oldEntry.requests;
+                        delta.newCount = newEntry.requests;
+                        hasOld = oldSnapshot.next(oldEntry);
+                        hasNew = newSnapshot.next(newEntry);
+                    }
+
+                    delta.key = std::to_string(statusCode);
+                    renderDeltaRow(delta);
+                }
+
+                m_output.write("\n");
+                return oldSnapshot.good() && newSnapshot.good();
+            }
+
+            void renderDeltas(const char* title, const vector<KeyDelta>& deltas) {
+                if (deltas.empty()) { return; }
+
+                m_output.print("### {0:s}\n\n| Key | Old | New | Δ | Δ % |\n|-----|-----|-----|---|-----|\n", title);
+                for (const auto& delta : deltas) { renderDeltaRow(delta); }
+                m_output.write("\n");
+            }
+
+            void renderDeltaRow(const KeyDelta& delta) {
+                if (delta.oldCount == 0) {
+                    m_output.print("| {0:s} | {1:d} | {2:d} | {3:+d} | new |\n", delta.key, delta.oldCount, delta.newCount, delta.getDelta());
+                } else {
+                    m_output.print("| {0:s} | {1:d} | {2:d} | {3:+d} | {4:+.1f}% |\n", delta.key, delta.oldCount, delta.newCount, delta.getDelta(), delta.getRelative() * 100.0);
+                }
+            }
+
+        private:
+            ReportOutput&   m_output;
+            size_t          m_topCount{20};
+
+            string          m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_SNAPSHOTDIFF_HPP
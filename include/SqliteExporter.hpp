@@ -0,0 +1,310 @@
+/**
+ * @file SqliteExporter.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the writer for the SQLite report database.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_SQLITEEXPORTER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_SQLITEEXPORTER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// sqlite
+#include <sqlite3.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AccessLogParser.hpp"
+#include "AllocationCounter.hpp"
+#include "RequestAggregator.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using std::string;
+    using std::string_view;
+
+    /**
+     * @brief Header-only implementation of a bulk writer for the SQLite report database.
+     *
+     * All inserts go through prepared statements inside large transactions, with journalling and
+     * syncing disabled for the duration of the load. Indexes are only created once all rows are in.
+     */
+    class SqliteExporter final {
+        public: // +++ Static +++
+            static constexpr size_t ROWS_PER_TRANSACTION = 250000; //!< The number of raw rows inserted per transaction
+
+        public: // +++ Constructor / Destructor +++
+            SqliteExporter() = default;
+            SqliteExporter(const SqliteExporter&) = delete;
+            ~SqliteExporter() { close(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Creates (or replaces) the database and prepares it for a bulk load.
+             *
+             * @param path The database file.
+             * @param withRequests Whether or not raw requests will be written, too.
+             *
+             * @return true If the database is ready. Otherwise getLastError() contains the reason.
+             */
+            bool open(const fs::path& path, bool withRequests) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::EXPORT);
+                std::error_code ec;
+                fs::remove(path, ec); // always start with a fresh report
+
+                if (sqlite3_open_v2(path.c_str(), &m_database, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+                    return fail();
+                }
+
+                if (!execute(R"(
+                        PRAGMA journal_mode = OFF;
+                        PRAGMA synchronous = OFF;
+                        PRAGMA locking_mode = EXCLUSIVE;
+                        PRAGMA temp_store = MEMORY;
+                        PRAGMA cache_size = -65536;
+
+                        CREATE TABLE clients (
+                            id INTEGER PRIMARY KEY, source TEXT NOT NULL, address BLOB,
+                            requests INTEGER NOT NULL, bytes INTEGER NOT NULL, first_seen INTEGER, last_seen INTEGER
+                        );
+                        CREATE TABLE client_status (client_id INTEGER NOT NULL, status INTEGER NOT NULL, requests INTEGER NOT NULL);
+                        CREATE TABLE uris (
+                            id INTEGER PRIMARY KEY, uri TEXT NOT NULL, requests INTEGER NOT NULL, bytes INTEGER NOT NULL,
+                            status_other INTEGER, status_1xx INTEGER, status_2xx INTEGER, status_3xx INTEGER, status_4xx INTEGER, status_5xx INTEGER
+                        );
+                        CREATE TABLE time_series (
+                            minute INTEGER PRIMARY KEY, requests INTEGER NOT NULL, bytes INTEGER NOT NULL,
+                            status_other INTEGER, status_1xx INTEGER, status_2xx INTEGER, status_3xx INTEGER, status_4xx INTEGER, status_5xx INTEGER
+                        );
+                    )")) {
+                    return false;
+                }
+
+                if (withRequests) {
+                    if (!execute(R"(
+                            CREATE TABLE requests (
+                                vhost TEXT, client TEXT NOT NULL, address BLOB, timestamp INTEGER NOT NULL, method TEXT, uri TEXT,
+                                http_version TEXT, status INTEGER NOT NULL, response_size INTEGER NOT NULL, referer TEXT, user_agent TEXT
+                            );
+                        )") ||
+                        !prepare("INSERT INTO requests VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", m_insertRequest)) {
+                        return false;
+                    }
+                }
+
+                return execute("BEGIN;");
+            }
+
+            /**
+             * @brief Inserts a single raw request.
+             *
+             * @return true If the row was inserted.
+             */
+            bool insertRequest(const RequestRecord& record) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::EXPORT);
+                if (m_insertRequest == nullptr) { return false; }
+
+                bindText(m_insertRequest, 1, record.virtualHost);
+                bindText(m_insertRequest, 2, record.clientSource);
+                sqlite3_bind_blob(m_insertRequest, 3, record.clientAddress.data(), static_cast<int>(record.clientAddress.size()), SQLITE_STATIC);
+                sqlite3_bind_int64(m_insertRequest, 4, record.epoch);
+                bindText(m_insertRequest, 5, record.httpRequestMethod);
+                bindText(m_insertRequest, 6, record.requestUri);
+                bindText(m_insertRequest, 7, record.httpVersion);
+                sqlite3_bind_int(m_insertRequest, 8, record.statusCode);
+                sqlite3_bind_int64(m_insertRequest, 9, record.responseSize);
+                bindText(m_insertRequest, 10, record.referer);
+                bindText(m_insertRequest, 11, record.userAgent);
+
+                if (!step(m_insertRequest)) { return false; }
+
+                if (++m_pendingRows >= ROWS_PER_TRANSACTION) {
+                    m_pendingRows = 0;
+                    return execute("COMMIT; BEGIN;");
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Writes all aggregate tables.
+             *
+             * @return true If all rows were inserted.
+             */
+            bool writeAggregates(const RequestAggregator& aggregator) {
+                const AllocationCounter::Scope allocationScope(AllocationTag::EXPORT);
+                sqlite3_stmt* insertClient = nullptr;
+                sqlite3_stmt* insertClientStatus = nullptr;
+                sqlite3_stmt* insertUri = nullptr;
+                sqlite3_stmt* insertMinute = nullptr;
+
+                bool success =
+                    prepare("INSERT INTO clients VALUES (?, ?, ?, ?, ?, ?, ?);", insertClient) &&
+                    prepare("INSERT INTO client_status VALUES (?, ?, ?);", insertClientStatus) &&
+                    prepare("INSERT INTO uris VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", insertUri) &&
+                    prepare("INSERT INTO time_series VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);", insertMinute);
+
+                for (uint32_t id = 0; success && id < aggregator.getClientCount(); id++) {
+                    const auto& client = aggregator.getClient(id);
+                    sqlite3_bind_int64(insertClient, 1, id);
+                    bindText(insertClient, 2, aggregator.getClientName(id));
+                    sqlite3_bind_blob(insertClient, 3, client.address.data(), static_cast<int>(client.address.size()), SQLITE_STATIC);
+                    sqlite3_bind_int64(insertClient, 4, static_cast<int64_t>(client.requests));
+                    sqlite3_bind_int64(insertClient, 5, static_cast<int64_t>(client.bytes));
+                    sqlite3_bind_int64(insertClient, 6, client.firstSeen);
+                    sqlite3_bind_int64(insertClient, 7, client.lastSeen);
+                    success = step(insertClient);
+
+                    for (const auto& status : client.statusCounts) {
+                        if (!success) { break; }
+                        sqlite3_bind_int64(insertClientStatus, 1, id);
+                        sqlite3_bind_int(insertClientStatus, 2, status.first);
+                        sqlite3_bind_int64(insertClientStatus, 3, static_cast<int64_t>(status.second));
+                        success = step(insertClientStatus);
+                    }
+                }
+
+                for (uint32_t id = 0; success && id < aggregator.getUriCount(); id++) {
+                    const auto& uri = aggregator.getUriStats(id);
+                    sqlite3_bind_int64(insertUri, 1, id);
+                    bindText(insertUri, 2, aggregator.getUri(id));
+                    bindCounters(insertUri, 3, uri);
+                    success = step(insertUri);
+                }
+
+                for (const auto& bucket : aggregator.getTimeSeries()) {
+                    if (!success) { break; }
+                    sqlite3_bind_int64(insertMinute, 1, bucket.first);
+                    bindCounters(insertMinute, 2, bucket.second);
+                    success = step(insertMinute);
+                }
+
+                sqlite3_finalize(insertClient);
+                sqlite3_finalize(insertClientStatus);
+                sqlite3_finalize(insertUri);
+                sqlite3_finalize(insertMinute);
+
+                return success;
+            }
+
+            /**
+             * @brief Commits the load, creates all indexes and restores durable settings.
+             *
+             * @return true If the database was finalised successfully.
+             */
+            bool finish() {
+                const AllocationCounter::Scope allocationScope(AllocationTag::EXPORT);
+                if (m_database == nullptr) { return false; }
+
+                sqlite3_finalize(m_insertRequest);
+                m_insertRequest = nullptr;
+
+                // indexes are far cheaper to build once than to maintain during the load
+                bool success = execute(R"(
+                    COMMIT;
+                    CREATE INDEX client_status_by_client ON client_status (client_id, status);
+                    CREATE INDEX client_status_by_status ON client_status (status);
+                    CREATE INDEX uris_by_uri ON uris (uri);
+                    CREATE INDEX clients_by_source ON clients (source);
+                )");
+
+                if (success && hasTable("requests")) {
+                    success = execute(R"(
+                        CREATE INDEX requests_by_client ON requests (client);
+                        CREATE INDEX requests_by_timestamp ON requests (timestamp);
+                        CREATE INDEX requests_by_status ON requests (status);
+                    )");
+                }
+
+                success = success && execute("PRAGMA journal_mode = DELETE; PRAGMA synchronous = FULL; PRAGMA locking_mode = NORMAL;");
+
+                close();
+                return success;
+            }
+
+            void close() {
+                if (m_insertRequest != nullptr) { sqlite3_finalize(m_insertRequest); m_insertRequest = nullptr; }
+                if (m_database != nullptr) { sqlite3_close(m_database); m_database = nullptr; }
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the last error reported by SQLite
+
+        private: // +++ Private Business +++
+            static void bindText(sqlite3_stmt* statement, int index, string_view text) {
+                // an empty view may have no data (e.g. an interned empty URI), which SQLite would bind as NULL
+                sqlite3_bind_text(statement, index, text.data() != nullptr ? text.data() : "", static_cast<int>(text.size()), SQLITE_STATIC);
+            }
+
+            template<typename Counters>
+            static void bindCounters(sqlite3_stmt* statement, int firstIndex, const Counters& counters) {
+                sqlite3_bind_int64(statement, firstIndex, static_cast<int64_t>(counters.requests));
+                sqlite3_bind_int64(statement, firstIndex + 1, static_cast<int64_t>(counters.bytes));
+                for (size_t i = 0; i < counters.statusClasses.size(); i++) {
+                    sqlite3_bind_int64(statement, firstIndex + 2 + static_cast<int>(i), static_cast<int64_t>(counters.statusClasses[i]));
+                }
+            }
+
+            bool fail() {
+                m_lastError = m_database != nullptr ? sqlite3_errmsg(m_database) : "out of memory";
+                return false;
+            }
+
+            bool execute(const char* sql) {
+                char* error = nullptr;
+                if (sqlite3_exec(m_database, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+                    m_lastError = error != nullptr ? error : "unknown error";
+                    sqlite3_free(error);
+                    return false;
+                }
+
+                return true;
+            }
+
+            bool prepare(const char* sql, sqlite3_stmt*& statement) {
+                return sqlite3_prepare_v3(m_database, sql, -1, SQLITE_PREPARE_PERSISTENT, &statement, nullptr) == SQLITE_OK || fail();
+            }
+
+            bool step(sqlite3_stmt* statement) {
+                const auto result = sqlite3_step(statement);
+                sqlite3_reset(statement);
+
+                return result == SQLITE_DONE || fail();
+            }
+
+            bool hasTable(const char* name) {
+                sqlite3_stmt* statement = nullptr;
+                if (!prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;", statement)) { return false; }
+
+                sqlite3_bind_text(statement, 1, name, -1, SQLITE_STATIC);
+                const auto found = sqlite3_step(statement) == SQLITE_ROW;
+                sqlite3_finalize(statement);
+
+                return found;
+            }
+
+        private:
+            size_t          m_pendingRows{0};
+
+            sqlite3*        m_database{nullptr};
+            sqlite3_stmt*   m_insertRequest{nullptr};
+
+            string          m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_SQLITEEXPORTER_HPP
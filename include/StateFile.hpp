@@ -0,0 +1,500 @@
+/**
+ * @file StateFile.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the crash-safe, memory-mapped state file the daemon checkpoints its tables and log positions to.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_STATEFILE_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_STATEFILE_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// libc
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// zlib
+#include <zlib.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "LiveAggregates.hpp"
+#include "LogFollower.hpp"
+
+namespace httpdreport {
+
+    namespace fs = std::filesystem;
+
+    using std::string;
+    using std::string_view;
+    using std::vector;
+
+    /**
+     * @brief A record of the commit log; names the image holding a complete checkpoint.
+     */
+    struct StateCommit final {
+        uint64_t    sequence{0}; //!< Increases with every commit; 0 if the slot was never written
+        uint64_t    imageOffset{0}; //!< Relative to the start of the file; a multiple of StateFile::HEADER_SIZE
+        uint64_t    imageSize{0};
+        int64_t     committedAt{0}; //!< UNIX time
+        uint32_t    imageChecksum{0}; //!< CRC-32 of the image
+        uint32_t    checksum{0}; //!< CRC-32 of the fields above; detects torn writes of the record itself
+    };
+
+    /**
+     * @brief The first page of a state file.
+     */
+    struct StateHeader final {
+        static constexpr char MAGIC[8] = { 'H', 'T', 'R', 'S', 'T', 'A', 'T', '1' }; //!< Identifies state files (and their layout version)
+
+        char        magic[8]{};
+        uint64_t    headerSize{0}; //!< sizeof(StateHeader); guards against layout changes
+        StateCommit commits[2]{}; //!< Written alternately, so the previous checkpoint survives a crash while the next one is written
+    };
+
+    /**
+     * @brief A string in an image's string section.
+     */
+    struct StateString final {
+        uint64_t    offset{0}; //!< Relative to the start of the string section
+        uint64_t    length{0};
+    };
+
+    /**
+     * @brief Where a table is stored in an image.
+     */
+    struct StateSection final {
+        uint64_t    offset{0}; //!< Relative to the start of the image
+        uint64_t    count{0}; //!< The number of entries (bytes for the string section)
+    };
+
+    /**
+     * @brief The beginning of every image. All sections are flat arrays addressed relative to the image, so an image can
+     * be mapped anywhere.
+     */
+    struct StateImageHeader final {
+        uint64_t        totalRequests{0};
+        int64_t         newestEpoch{0}; //!< The newest request in the window
+        StateSection    files{}; //!< StoredFile
+        StateSection    clients{}; //!< StoredClient
+        StateSection    clientStatuses{}; //!< StoredStatus, referenced by clients
+        StateSection    uris{}; //!< StoredUri
+        StateSection    timeSeries{}; //!< StoredMinute
+        StateSection    windowEntries{}; //!< StoredWindowEntry
+        StateSection    strings{};
+    };
+
+    struct StoredFile final {
+        StateString     path{};
+        uint64_t        device{0};
+        uint64_t        inode{0};
+        uint64_t        offset{0};
+    };
+
+    struct StoredClient final {
+        StateString     source{};
+        ClientAddress   address{};
+        uint64_t        requests{0};
+        uint64_t        bytes{0};
+        int64_t         firstSeen{0};
+        int64_t         lastSeen{0};
+        uint64_t        firstStatus{0}; //!< Index in to the client status section
+        uint64_t        statusCount{0};
+    };
+
+    struct StoredStatus final {
+        uint64_t        statusCode{0};
+        uint64_t        requests{0};
+    };
+
+    struct StoredUri final {
+        StateString     uri{};
+        UriStats        stats{};
+    };
+
+    struct StoredMinute final {
+        int64_t         minute{0};
+        TimeBucket      stats{};
+    };
+
+    struct StoredWindowEntry final {
+        int64_t         slotStart{0};
+        StateString     key{};
+        WindowCounters  counters{};
+    };
+
+    /**
+     * @brief Header-only implementation of the daemon's state file.
+     *
+     * Each checkpoint writes a complete image of the live tables and the followed files' positions through a shared
+     * mapping, placed so it never overlaps the image of the previous checkpoint. Only once the image is on disk, a
+     * commit record naming it (with its CRC-32) is written to the slot not holding the previous commit and synced.
+     * A crash at any point therefore leaves at least one intact checkpoint, and loading picks the newest one which
+     * passes its checks. Restoring is a single pass over the mapped image; no log needs to be parsed again.
+     *
+     * The layout is native (endianness, alignment); state files are not meant to be moved between machines.
+     */
+    class StateFile final {
+        public: // +++ Static +++
+            static constexpr uint64_t HEADER_SIZE = 4096; //!< The header's share of the file; images start at multiples of it
+
+        public: // +++ Constructor / Destructor +++
+            StateFile() = default;
+            StateFile(const StateFile&) = delete;
+            ~StateFile() { close(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Opens a state file, creating it if it doesn't exist.
+             *
+             * @return true If the file is a state file (or was created). Otherwise getLastError() contains the reason.
+             */
+            bool open(const fs::path& path) {
+                if ((m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600)) < 0) { return fail(strerror(errno)); }
+
+                struct stat info{};
+                if (fstat(m_fd, &info) != 0) { return fail(strerror(errno)); }
+
+                if (info.st_size == 0) {
+                    std::memcpy(m_header.magic, StateHeader::MAGIC, sizeof(m_header.magic));
+                    m_header.headerSize = sizeof(StateHeader);
+                    if (ftruncate(m_fd, HEADER_SIZE) != 0 || !writeHeader()) { return fail(strerror(errno)); }
+
+                    return true;
+                }
+
+                if (
+                    pread(m_fd, &m_header, sizeof(m_header), 0) != static_cast<ssize_t>(sizeof(m_header)) ||
+                    std::memcmp(m_header.magic, StateHeader::MAGIC, sizeof(m_header.magic)) != 0 || m_header.headerSize != sizeof(StateHeader)
+                ) { return fail("not a state file of this version"); }
+
+                return true;
+            }
+
+            void close() { //!< Closes the file
+                if (m_fd >= 0) { ::close(m_fd); }
+                m_fd = -1;
+            }
+
+            bool isOpen() const { return m_fd >= 0; } //!< Gets a value indicating whether or not a state file is open
+
+            bool hasCheckpoint() const { return getNewestCommit() != nullptr; } //!< Gets a value indicating whether or not anything was ever committed
+
+            /**
+             * @brief Loads the newest intact checkpoint in to (empty) tables.
+             *
+             * @param positions Receives the positions of the files which had been read.
+             *
+             * @return true If a checkpoint was loaded. Otherwise getLastError() contains the reason.
+             */
+            bool load(LiveTables& tables, vector<LogFollower::FilePosition>& positions) {
+                vector<const StateCommit*> commits;
+                for (const auto& commit : m_header.commits) {
+                    if (isValid(commit)) { commits.push_back(&commit); }
+                }
+                std::sort(commits.begin(), commits.end(), [](const StateCommit* a, const StateCommit* b) { return a->sequence > b->sequence; });
+                if (commits.empty()) { return fail("no checkpoint"); }
+
+                for (const auto* commit : commits) {
+                    ImageMapping mapping;
+                    if (!mapping.map(m_fd, commit->imageOffset, commit->imageSize, PROT_READ)) { return fail(strerror(errno)); }
+                    madvise(mapping.base, mapping.length, MADV_SEQUENTIAL);
+
+                    // an image which fails its checksum was torn by a crash; the older checkpoint is still intact
+                    const auto intact = getChecksum(mapping.image, commit->imageSize) == commit->imageChecksum;
+                    if (intact && restore(mapping.image, commit->imageSize, tables, positions)) { return true; }
+                    if (intact) { return fail("inconsistent checkpoint"); }
+                }
+
+                return fail("all checkpoints are damaged");
+            }
+
+            /**
+             * @brief Writes a checkpoint of the tables and the positions of the files they were read from.
+             *
+             * @return true If the checkpoint is on disk. Otherwise getLastError() contains the reason; the previous checkpoint remains valid.
+             */
+            bool commit(const LiveTables& tables, const vector<LogFollower::FilePosition>& positions) {
+                const auto& totals = tables.getTotals();
+                const auto& window = tables.getClientWindow();
+
+                // sizes first, so the image can be written in place
+                StateImageHeader layout;
+                layout.totalRequests = totals.getTotalRequests();
+                layout.newestEpoch = window.getNewestEpoch();
+                layout.files.count = positions.size();
+                layout.clients.count = totals.getClientCount();
+                layout.uris.count = totals.getUriCount();
+                layout.timeSeries.count = totals.getTimeSeries().size();
+
+                uint64_t stringBytes = 0;
+                for (const auto& position : positions) { stringBytes += position.path.size(); }
+                for (uint32_t id = 0; id < totals.getClientCount(); id++) {
+                    stringBytes += totals.getClientName(id).size();
+                    layout.clientStatuses.count += totals.getClient(id).statusCounts.size();
+                }
+                for (uint32_t id = 0; id < totals.getUriCount(); id++) { stringBytes += totals.getUri(id).size(); }
+                window.forEachEntry([&](int64_t, string_view key, const WindowCounters&) {
+                    layout.windowEntries.count++;
+                    stringBytes += key.size();
+                });
+                layout.strings.count = stringBytes;
+
+                uint64_t imageSize = sizeof(StateImageHeader);
+                placeSection<StoredFile>(layout.files, imageSize);
+                placeSection<StoredClient>(layout.clients, imageSize);
+                placeSection<StoredStatus>(layout.clientStatuses, imageSize);
+                placeSection<StoredUri>(layout.uris, imageSize);
+                placeSection<StoredMinute>(layout.timeSeries, imageSize);
+                placeSection<StoredWindowEntry>(layout.windowEntries, imageSize);
+                placeSection<char>(layout.strings, imageSize);
+
+                // never overwrite the newest checkpoint
+                const auto* newest = getNewestCommit();
+                auto imageOffset = HEADER_SIZE;
+                if (newest != nullptr && imageOffset < newest->imageOffset + newest->imageSize && newest->imageOffset < imageOffset + imageSize) {
+                    imageOffset = alignUp(newest->imageOffset + newest->imageSize, HEADER_SIZE);
+                }
+
+                // reserve the blocks up front, so a full disk fails here instead of with SIGBUS while writing the mapping
+                if (const auto error = posix_fallocate(m_fd, static_cast<off_t>(imageOffset), static_cast<off_t>(imageSize)); error != 0) { return fail(strerror(error)); }
+
+                uint32_t imageChecksum = 0;
+                {
+                    ImageMapping mapping;
+                    if (!mapping.map(m_fd, imageOffset, imageSize, PROT_READ | PROT_WRITE)) { return fail(strerror(errno)); }
+
+                    writeImage(mapping.image, layout, tables, positions);
+                    if (msync(mapping.base, mapping.length, MS_SYNC) != 0) { return fail(strerror(errno)); }
+                    imageChecksum = getChecksum(mapping.image, imageSize);
+                }
+
+                auto& slot = m_header.commits[newest == &m_header.commits[0] ? 1 : 0];
+                slot.sequence = newest == nullptr ? 1 : newest->sequence + 1;
+                slot.imageOffset = imageOffset;
+                slot.imageSize = imageSize;
+                slot.committedAt = static_cast<int64_t>(std::time(nullptr));
+                slot.imageChecksum = imageChecksum;
+                slot.checksum = getRecordChecksum(slot);
+                if (!writeHeader()) { return fail(strerror(errno)); }
+
+                // the previous image isn't needed any more; drop it if it lies behind the new one
+                struct stat info{};
+                if (fstat(m_fd, &info) == 0 && static_cast<uint64_t>(info.st_size) > imageOffset + imageSize) {
+                    (void)!ftruncate(m_fd, static_cast<off_t>(imageOffset + imageSize));
+                }
+
+                return true;
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            /**
+             * @brief A shared mapping of an image; mappings have to begin on a page boundary, images don't need to.
+             */
+            struct ImageMapping {
+                void*       base{MAP_FAILED};
+                size_t      length{0};
+                char*       image{nullptr};
+
+                bool map(int fd, uint64_t offset, uint64_t size, int protection) {
+                    const auto pageOffset = offset % static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+                    length = static_cast<size_t>(size + pageOffset);
+                    base = mmap(nullptr, length, protection, MAP_SHARED, fd, static_cast<off_t>(offset - pageOffset));
+                    image = base == MAP_FAILED ? nullptr : static_cast<char*>(base) + pageOffset;
+
+                    return base != MAP_FAILED;
+                }
+
+                ~ImageMapping() { if (base != MAP_FAILED) { munmap(base, length); } }
+            };
+
+            static_assert(std::is_trivially_copyable_v<StoredClient> && std::is_trivially_copyable_v<StoredUri> && std::is_trivially_copyable_v<StoredWindowEntry>);
+
+            static uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+            static uint32_t getChecksum(const void* data, uint64_t size) {
+                auto checksum = crc32(0L, Z_NULL, 0);
+                const auto* bytes = static_cast<const Bytef*>(data);
+                // crc32() takes 32 bit lengths
+                for (uint64_t done = 0; done < size; done += 1u << 30) {
+                    checksum = crc32(checksum, bytes + done, static_cast<uInt>(std::min<uint64_t>(size - done, 1u << 30)));
+                }
+
+                return static_cast<uint32_t>(checksum);
+            }
+
+            static uint32_t getRecordChecksum(const StateCommit& commit) { return getChecksum(&commit, offsetof(StateCommit, checksum)); }
+
+            template<typename T>
+            static void placeSection(StateSection& section, uint64_t& imageSize) {
+                section.offset = alignUp(imageSize, alignof(uint64_t));
+                imageSize = section.offset + section.count * sizeof(T);
+            }
+
+            bool fail(const string& reason) {
+                m_lastError = reason;
+                return false;
+            }
+
+            bool writeHeader() { return pwrite(m_fd, &m_header, sizeof(m_header), 0) == static_cast<ssize_t>(sizeof(m_header)) && fdatasync(m_fd) == 0; }
+
+            bool isValid(const StateCommit& commit) const {
+                struct stat info{};
+                return commit.sequence != 0 && commit.checksum == getRecordChecksum(commit) && commit.imageOffset % HEADER_SIZE == 0 &&
+                       commit.imageSize >= sizeof(StateImageHeader) && fstat(m_fd, &info) == 0 &&
+                       commit.imageOffset + commit.imageSize <= static_cast<uint64_t>(info.st_size);
+            }
+
+            const StateCommit* getNewestCommit() const {
+                const StateCommit* newest = nullptr;
+                for (const auto& commit : m_header.commits) {
+                    if (isValid(commit) && (newest == nullptr || commit.sequence > newest->sequence)) { newest = &commit; }
+                }
+
+                return newest;
+            }
+
+            static void writeImage(char* image, const StateImageHeader& layout, const LiveTables& tables, const vector<LogFollower::FilePosition>& positions) {
+                const auto& totals = tables.getTotals();
+                std::memcpy(image, &layout, sizeof(layout));
+
+                auto* strings = image + layout.strings.offset;
+                uint64_t stringOffset = 0;
+                const auto addString = [&](string_view str) {
+                    std::memcpy(strings + stringOffset, str.data(), str.size());
+                    stringOffset += str.size();
+                    return StateString{ stringOffset - str.size(), str.size() };
+                };
+
+                auto* files = reinterpret_cast<StoredFile*>(image + layout.files.offset);
+                for (const auto& position : positions) { *files++ = { addString(position.path), position.device, position.inode, position.offset }; }
+
+                auto* clients = reinterpret_cast<StoredClient*>(image + layout.clients.offset);
+                auto* statuses = reinterpret_cast<StoredStatus*>(image + layout.clientStatuses.offset);
+                uint64_t statusIndex = 0;
+                for (uint32_t id = 0; id < totals.getClientCount(); id++) {
+                    const auto& client = totals.getClient(id);
+                    *clients++ = {
+                        addString(totals.getClientName(id)), client.address, client.requests, client.bytes, client.firstSeen, client.lastSeen,
+                        statusIndex, client.statusCounts.size()
+                    };
+                    for (const auto& status : client.statusCounts) { statuses[statusIndex++] = { status.first, status.second }; }
+                }
+
+                auto* uris = reinterpret_cast<StoredUri*>(image + layout.uris.offset);
+                for (uint32_t id = 0; id < totals.getUriCount(); id++) { *uris++ = { addString(totals.getUri(id)), totals.getUriStats(id) }; }
+
+                auto* minutes = reinterpret_cast<StoredMinute*>(image + layout.timeSeries.offset);
+                for (const auto& minute : totals.getTimeSeries()) { *minutes++ = { minute.first, minute.second }; }
+
+                auto* entries = reinterpret_cast<StoredWindowEntry*>(image + layout.windowEntries.offset);
+                tables.getClientWindow().forEachEntry([&](int64_t slotStart, string_view key, const WindowCounters& counters) {
+                    *entries++ = { slotStart, addString(key), counters };
+                });
+            }
+
+            static bool restore(const char* image, uint64_t imageSize, LiveTables& tables, vector<LogFollower::FilePosition>& positions) {
+                StateImageHeader layout;
+                std::memcpy(&layout, image, sizeof(layout));
+
+                const auto fits = [&](const StateSection& section, size_t entrySize) {
+                    return section.offset <= imageSize && section.count <= (imageSize - section.offset) / entrySize;
+                };
+                if (
+                    !fits(layout.files, sizeof(StoredFile)) || !fits(layout.clients, sizeof(StoredClient)) || !fits(layout.clientStatuses, sizeof(StoredStatus)) ||
+                    !fits(layout.uris, sizeof(StoredUri)) || !fits(layout.timeSeries, sizeof(StoredMinute)) ||
+                    !fits(layout.windowEntries, sizeof(StoredWindowEntry)) || !fits(layout.strings, 1)
+                ) { return false; }
+
+                const auto* strings = image + layout.strings.offset;
+                bool consistent = true;
+                const auto getString = [&](const StateString& str) {
+                    if (str.offset > layout.strings.count || str.length > layout.strings.count - str.offset) {
+                        consistent = false;
+                        return string_view();
+                    }
+
+                    return string_view(strings + str.offset, str.length);
+                };
+
+                const auto* files = reinterpret_cast<const StoredFile*>(image + layout.files.offset);
+                for (uint64_t i = 0; i < layout.files.count; i++) {
+                    positions.push_back({ string(getString(files[i].path)), files[i].device, files[i].inode, files[i].offset });
+                }
+
+                auto& totals = tables.getTotals();
+                const auto* statuses = reinterpret_cast<const StoredStatus*>(image + layout.clientStatuses.offset);
+                const auto* clients = reinterpret_cast<const StoredClient*>(image + layout.clients.offset);
+                ClientStats client;
+                for (uint64_t i = 0; i < layout.clients.count && consistent; i++) {
+                    const auto& stored = clients[i];
+                    if (stored.firstStatus > layout.clientStatuses.count || stored.statusCount > layout.clientStatuses.count - stored.firstStatus) { return false; }
+
+                    client.address = stored.address;
+                    client.requests = stored.requests;
+                    client.bytes = stored.bytes;
+                    client.firstSeen = stored.firstSeen;
+                    client.lastSeen = stored.lastSeen;
+                    client.statusCounts.clear();
+                    for (uint64_t j = 0; j < stored.statusCount; j++) {
+                        const auto& status = statuses[stored.firstStatus + j];
+                        client.statusCounts.emplace_back(static_cast<uint16_t>(status.statusCode), status.requests);
+                    }
+
+                    totals.mergeClient(getString(stored.source), client);
+                }
+
+                const auto* uris = reinterpret_cast<const StoredUri*>(image + layout.uris.offset);
+                for (uint64_t i = 0; i < layout.uris.count && consistent; i++) { totals.mergeUri(getString(uris[i].uri), uris[i].stats); }
+
+                const auto* minutes = reinterpret_cast<const StoredMinute*>(image + layout.timeSeries.offset);
+                for (uint64_t i = 0; i < layout.timeSeries.count; i++) { totals.mergeTimeBucket(minutes[i].minute, minutes[i].stats); }
+
+                totals.mergeRequestCount(layout.totalRequests);
+
+                // the window's end comes first, so entries which are too old by now are dropped
+                auto& window = tables.getClientWindow();
+                window.restoreNewestEpoch(layout.newestEpoch);
+                const auto* entries = reinterpret_cast<const StoredWindowEntry*>(image + layout.windowEntries.offset);
+                for (uint64_t i = 0; i < layout.windowEntries.count && consistent; i++) {
+                    window.mergeEntry(entries[i].slotStart, getString(entries[i].key), entries[i].counters);
+                }
+
+                return consistent;
+            }
+
+        private:
+            int             m_fd{-1};
+            StateHeader     m_header{};
+
+            string          m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_STATEFILE_HPP
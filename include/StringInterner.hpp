@@ -0,0 +1,130 @@
+/**
+ * @file StringInterner.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains a simple arena-backed string interner, assigning dense IDs to unique strings.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_STRINGINTERNER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_STRINGINTERNER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// libc
+#include <stdint.h>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AllocationCounter.hpp"
+#include "Probes.hpp"
+
+namespace httpdreport {
+
+    using std::string_view;
+    using std::unique_ptr;
+    using std::unordered_map;
+    using std::vector;
+
+    /**
+     * @brief Header-only implementation of a string interner.
+     *
+     * Unique strings are copied once in to large, never-moving arena blocks; lookups
+     * are done on string_views so interning an already-known string doesn't allocate.
+     * IDs are assigned densely in order of first appearance.
+     */
+    class StringInterner final {
+        public: // +++ Static +++
+            static constexpr size_t ARENA_BLOCK_SIZE = 1 << 20; //!< The size of each arena block
+
+        public: // +++ Constructor / Destructor +++
+            StringInterner() = default;
+            StringInterner(const StringInterner&) = delete;
+            StringInterner(StringInterner&&) = default;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Gets the ID of a string, adding it to the interner if it is unknown.
+             */
+            uint32_t intern(string_view str) {
+                const auto found = m_ids.find(str);
+                if (found != m_ids.end()) { return found->second; }
+
+                const AllocationCounter::Scope allocationScope(AllocationTag::INTERNER);
+                const auto stored = store(str);
+                const auto id = static_cast<uint32_t>(m_strings.size());
+                const auto buckets = m_ids.bucket_count();
+                m_strings.push_back(stored);
+                m_ids.emplace(stored, id);
+                if (m_ids.bucket_count() != buckets) { HTTPDREPORT_PROBE4(table_resize, this, buckets, m_ids.bucket_count(), m_ids.size()); }
+
+                return id;
+            }
+
+            /**
+             * @brief Gets the ID of a string without adding it.
+             *
+             * @return true If the string is known.
+             */
+            bool tryGetId(string_view str, uint32_t& id) const {
+                const auto found = m_ids.find(str);
+                if (found == m_ids.end()) { return false; }
+
+                id = found->second;
+                return true;
+            }
+
+            string_view get(uint32_t id) const { return m_strings[id]; } //!< Gets the string for a given ID
+
+            size_t size() const { return m_strings.size(); } //!< Gets the number of unique strings
+
+            const vector<string_view>& strings() const { return m_strings; } //!< Gets all strings in ID order
+
+        private: // +++ Private Business +++
+            string_view store(string_view str) {
+                if (str.empty()) { return string_view(); }
+
+                if (str.size() > ARENA_BLOCK_SIZE / 4) {
+                    // don't waste the remainder of the current block on huge strings
+                    m_largeStrings.emplace_back(new char[str.size()]);
+                    std::memcpy(m_largeStrings.back().get(), str.data(), str.size());
+                    return string_view(m_largeStrings.back().get(), str.size());
+                }
+
+                if (m_blocks.empty() || m_blockUsed + str.size() > ARENA_BLOCK_SIZE) {
+                    m_blocks.emplace_back(new char[ARENA_BLOCK_SIZE]);
+                    m_blockUsed = 0;
+                }
+
+                char* dest = m_blocks.back().get() + m_blockUsed;
+                std::memcpy(dest, str.data(), str.size());
+                m_blockUsed += str.size();
+
+                return string_view(dest, str.size());
+            }
+
+        private:
+            size_t                                  m_blockUsed{0};
+
+            unordered_map<string_view, uint32_t>    m_ids{};
+
+            vector<string_view>                     m_strings{};
+            vector<unique_ptr<char[]>>              m_blocks{};
+            vector<unique_ptr<char[]>>              m_largeStrings{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_STRINGINTERNER_HPP
@@ -0,0 +1,529 @@
+/**
+ * @file SyntheticLog.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the deterministic generator of synthetic access logs used by the benchmarks and the generator tool.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_SYNTHETICLOG_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_SYNTHETICLOG_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <ctime>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <stdint.h>
+
+namespace httpdreport {
+
+    using fmt::format_to;
+
+    using std::pair;
+    using std::string;
+    using std::string_view;
+    using std::vector;
+
+    /**
+     * @brief xoshiro256** seeded through splitmix64. Unlike the standard distributions, its output is the same on every platform,
+     * which is what makes a seed reproduce a corpus anywhere.
+     */
+    class SyntheticRandom final {
+        public: // +++ Constructor / Destructor +++
+            explicit SyntheticRandom(uint64_t seed = 1) { reseed(seed); }
+
+        public: // +++ Business Logic +++
+            void reseed(uint64_t seed) {
+                for (auto& word : m_state) {
+                    seed += 0x9e3779b97f4a7c15ull;
+                    auto z = seed;
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                    word = z ^ (z >> 31);
+                }
+            }
+
+            uint64_t operator()() {
+                const auto result = rotateLeft(m_state[1] * 5, 7) * 9;
+                const auto t = m_state[1] << 17;
+
+                m_state[2] ^= m_state[0];
+                m_state[3] ^= m_state[1];
+                m_state[1] ^= m_state[2];
+                m_state[0] ^= m_state[3];
+                m_state[2] ^= t;
+                m_state[3] = rotateLeft(m_state[3], 45);
+
+                return result;
+            }
+
+            double nextDouble() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; } //!< Gets a number in [0, 1)
+
+            uint64_t nextBelow(uint64_t bound) { return bound == 0 ? 0 : (*this)() % bound; } //!< Gets a number in [0, bound)
+
+        private: // +++ Private Business +++
+            static uint64_t rotateLeft(uint64_t x, int32_t bits) { return (x << bits) | (x >> (64 - bits)); }
+
+        private:
+            uint64_t    m_state[4]{};
+    };
+
+    /**
+     * @brief Draws ranks 1..n with probability proportional to 1 / rank^exponent in constant time and memory.
+     *
+     * Uses rejection-inversion (W. Hörmann, G. Derflinger: "Rejection-inversion to generate variates from monotone discrete
+     * distributions"), so even 1e8 distinct clients need no table.
+     */
+    class ZipfDistribution final {
+        public: // +++ Constructor / Destructor +++
+            ZipfDistribution(uint64_t n, double exponent): m_n(std::max<uint64_t>(1, n)), m_exponent(exponent) {
+                m_hIntegralX1 = hIntegral(1.5) - 1.0;
+                m_hIntegralN = hIntegral(static_cast<double>(m_n) + 0.5);
+                m_s = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+            }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Draws a rank; 1 is the most frequent.
+             */
+            uint64_t operator()(SyntheticRandom& random) const {
+                while (true) {
+                    const auto u = m_hIntegralN + random.nextDouble() * (m_hIntegralX1 - m_hIntegralN);
+                    const auto x = hIntegralInverse(u);
+                    const auto k = std::clamp<double>(std::floor(x + 0.5), 1.0, static_cast<double>(m_n));
+
+                    if (k - x <= m_s || u >= hIntegral(k + 0.5) - h(k)) { return static_cast<uint64_t>(k); }
+                }
+            }
+
+        private: // +++ Private Business +++
+            double h(double x) const { return std::exp(-m_exponent * std::log(x)); }
+
+            double hIntegral(double x) const {
+                const auto logX = std::log(x);
+                return helper2((1.0 - m_exponent) * logX) * logX;
+            }
+
+            double hIntegralInverse(double x) const {
+                auto t = x * (1.0 - m_exponent);
+                if (t < -1.0) { t = -1.0; }
+
+                return std::exp(helper1(t) * x);
+            }
+
+            static double helper1(double x) { return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x)); }
+            static double helper2(double x) { return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x)); }
+
+        private:
+            uint64_t    m_n{1};
+            double      m_exponent{1.0};
+            double      m_hIntegralX1{0};
+            double      m_hIntegralN{0};
+            double      m_s{0};
+    };
+
+    /**
+     * @brief The LogFormat strings of httpd's predefined formats, which parseRequestRecord() accepts.
+     */
+    namespace syntheticformats {
+        constexpr string_view COMMON = R"(%h %l %u %t "%r" %>s %b)";
+        constexpr string_view COMBINED = R"(%h %l %u %t "%r" %>s %b "%{Referer}i" "%{User-Agent}i")";
+        constexpr string_view VHOST_COMBINED = R"(%v:%p %h %l %u %t "%r" %>s %O "%{Referer}i" "%{User-Agent}i")";
+    }
+
+    /**
+     * @brief The shape of a synthetic log. Equal options (seed included) always produce the same lines.
+     */
+    struct SyntheticLogOptions final {
+        uint64_t                        seed{1};
+        uint64_t                        lineCount{1000000}; //!< The number of lines the time span is spread over
+        uint64_t                        clientCount{10000}; //!< Distinct client addresses
+        uint64_t                        uriCount{1000}; //!< Distinct request URIs
+        uint64_t                        userAgentCount{200}; //!< Distinct user agents
+        double                          zipfExponent{1.1}; //!< The skew of clients, URIs and user agents
+        size_t                          uriPadding{24}; //!< URIs get 0 to 2x this many extra characters, which controls the line length
+        double                          ipv6Share{0}; //!< The share of clients with an IPv6 address, in [0, 1]
+        double                          malformedRate{0}; //!< The share of lines which are cut off, in [0, 1]
+
+        string                          logFormat{syntheticformats::COMBINED}; //!< An httpd LogFormat string
+        int64_t                         startEpoch{1767225600}; //!< The time of the first line; 2026-01-01 00:00:00 UTC
+        int64_t                         spanSeconds{86400}; //!< The time between the first and the last line
+
+        vector<pair<uint16_t, double>>  statusWeights{ {200, 82}, {304, 6}, {301, 2}, {404, 7}, {403, 1}, {500, 1}, {503, 1} };
+    };
+
+    /**
+     * @brief Header-only implementation of the synthetic access log generator.
+     *
+     * Clients, URIs and user agents are drawn from Zipf distributions and each rank is mapped to its string by a bijection, so
+     * no per-entity state is kept no matter the cardinality. The LogFormat is compiled once; lines are appended to a
+     * caller-provided string to avoid allocations.
+     *
+     * A corpus can be generated in independent blocks (see startBlock()), e.g. by several threads: a block's lines only depend on
+     * the options and the block's number, never on which thread generates it or when.
+     */
+    class SyntheticLogGenerator final {
+        public: // +++ Static +++
+            static constexpr size_t MAX_CACHED_USER_AGENTS = 4096; //!< The most frequent user agents are formatted up front
+
+            static constexpr const char* METHODS[] = { "GET", "GET", "GET", "GET", "GET", "GET", "POST", "HEAD" };
+            static constexpr const char* VIRTUAL_HOSTS[] = { "www.example.com", "example.com", "api.example.com", "static.example.com" };
+            static constexpr const char* REFERERS[] = { "-", "-", "-", "-", "-", "-", "https://www.google.com/", "https://www.example.com/" };
+            static constexpr const char* USER_AGENT_FAMILIES[] = {
+                "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/{0:d}.0.0.0 Safari/537.36",
+                "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/605.1.15 (KHTML, like Gecko) Version/{0:d}.1 Safari/605.1.15",
+                "Mozilla/5.0 (X11; Linux x86_64; rv:{0:d}.0) Gecko/20100101 Firefox/{0:d}.0",
+                "Mozilla/5.0 (iPhone; CPU iPhone OS 17_{0:d} like Mac OS X) AppleWebKit/605.1.15 (KHTML, like Gecko) Mobile/15E148",
+                "curl/8.{0:d}.0",
+                "Mozilla/5.0 (compatible; Googlebot/2.{0:d}; +http://www.google.com/bot.html)",
+            };
+
+        public: // +++ Constructor / Destructor +++
+            /**
+             * @brief Compiles the options' LogFormat; if it contains an unsupported directive, getLastError() says which.
+             */
+            explicit SyntheticLogGenerator(SyntheticLogOptions options):
+                m_options(std::move(options)), m_random(m_options.seed),
+                m_clients(m_options.clientCount, m_options.zipfExponent), m_uris(m_options.uriCount, m_options.zipfExponent),
+                m_userAgents(m_options.userAgentCount, m_options.zipfExponent) {
+                compileFormat(m_options.logFormat);
+
+                double totalWeight = 0;
+                for (const auto& entry : m_options.statusWeights) { totalWeight += std::max(0.0, entry.second); }
+                double cumulative = 0;
+                for (const auto& entry : m_options.statusWeights) {
+                    cumulative += std::max(0.0, entry.second) / (totalWeight > 0 ? totalWeight : 1.0);
+                    m_statusThresholds.emplace_back(cumulative, entry.first);
+                }
+                if (m_statusThresholds.empty()) { m_statusThresholds.emplace_back(1.0, uint16_t{200}); }
+                m_statusThresholds.back().first = 1.0;
+
+                for (uint64_t rank = 1; rank <= std::min<uint64_t>(m_options.userAgentCount, MAX_CACHED_USER_AGENTS); rank++) {
+                    m_cachedUserAgents.emplace_back();
+                    formatUserAgent(m_cachedUserAgents.back(), rank);
+                }
+            }
+
+        public: // +++ Business Logic +++
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason the LogFormat was rejected; empty if it wasn't
+
+            /**
+             * @brief Continues with the given block of lines; its lines only depend on the options and blockNumber.
+             *
+             * @param firstLine The index of the block's first line, which places it in the time span.
+             */
+            void startBlock(uint64_t blockNumber, uint64_t firstLine) {
+                m_random.reseed(m_options.seed ^ (blockNumber * 0xd6e8feb86659fd93ull));
+                m_lineIndex = firstLine;
+            }
+
+            /**
+             * @brief Appends the next line, including its line break.
+             */
+            void appendLine(string& out) {
+                const auto lineStart = out.size();
+                m_line.epoch = m_options.startEpoch + static_cast<int64_t>(
+                    m_options.lineCount > 1 ? static_cast<double>(m_options.spanSeconds) * static_cast<double>(m_lineIndex) / static_cast<double>(m_options.lineCount - 1) : 0.0
+                );
+                m_lineIndex++;
+
+                m_line.client = m_clients(m_random);
+                m_line.uri = m_uris(m_random);
+                m_line.userAgent = m_userAgents(m_random);
+                m_line.status = drawStatus();
+                m_line.size = m_line.status == 304 || m_line.status == 408 ? 0 : 200 + m_random.nextBelow(50000);
+                m_line.method = METHODS[m_random() % std::size(METHODS)];
+                m_line.duration = 50 + m_random.nextBelow(500000);
+                m_line.extra = m_random();
+
+                size_t timestampOffset = string::npos;
+                for (const auto& token : m_tokens) {
+                    if (token.directive == Directive::TIMESTAMP) { timestampOffset = out.size(); }
+                    appendToken(out, token);
+                }
+
+                // a malformed line is cut off within its timestamp, like a line torn by a crash or a full disk
+                if (m_options.malformedRate > 0 && m_random.nextDouble() < m_options.malformedRate) {
+                    const auto cutFrom = timestampOffset != string::npos ? timestampOffset + 1 : lineStart + (out.size() - lineStart) / 2;
+                    out.resize(std::min(out.size(), cutFrom + m_random.nextBelow(20)));
+                }
+
+                out += '\n';
+            }
+
+            /**
+             * @brief Appends the next count lines.
+             */
+            void appendLines(string& out, uint64_t count) {
+                for (uint64_t i = 0; i < count; i++) { appendLine(out); }
+            }
+
+        private: // +++ Private Business +++
+            enum class Directive {
+                LITERAL, CLIENT, DASH, TIMESTAMP, REQUEST_LINE, METHOD, URI, QUERY, PROTOCOL, STATUS, SIZE_CLF, SIZE,
+                BYTES_RECEIVED, DURATION_MICROSECONDS, DURATION_SECONDS, VIRTUAL_HOST, PORT, REFERER, USER_AGENT
+            };
+
+            struct Token {
+                Directive   directive{Directive::LITERAL};
+                string      text{}; //!< LITERAL only
+            };
+
+            /**
+             * @brief The values shared by all tokens of the current line.
+             */
+            struct LineValues {
+                int64_t     epoch{0};
+                uint64_t    client{1};
+                uint64_t    uri{1};
+                uint64_t    userAgent{1};
+                uint16_t    status{200};
+                uint64_t    size{0};
+                const char* method{"GET"};
+                uint64_t    duration{0}; //!< In microseconds
+                uint64_t    extra{0}; //!< Random bits for the less important fields
+            };
+
+            void compileFormat(string_view logFormat) {
+                const auto addLiteral = [&](char c) {
+                    if (m_tokens.empty() || m_tokens.back().directive != Directive::LITERAL) { m_tokens.push_back({ Directive::LITERAL, {} }); }
+                    m_tokens.back().text += c;
+                };
+
+                for (size_t i = 0; i < logFormat.size(); i++) {
+                    const auto c = logFormat[i];
+                    if (c == '\\' && i + 1 < logFormat.size()) {
+                        // the escapes of httpd's configuration syntax, so LogFormat lines can be pasted as they are
+                        const auto escaped = logFormat[++i];
+                        addLiteral(escaped == 't' ? '\t' : escaped);
+                        continue;
+                    }
+                    if (c != '%') {
+                        addLiteral(c);
+                        continue;
+                    }
+
+                    // %[!codes][<>]{argument}X
+                    string argument;
+                    i++;
+                    while (i < logFormat.size() && (logFormat[i] == '<' || logFormat[i] == '>' || logFormat[i] == '!' || logFormat[i] == ',' || std::isdigit(static_cast<unsigned char>(logFormat[i])))) { i++; }
+                    if (i < logFormat.size() && logFormat[i] == '{') {
+                        const auto end = logFormat.find('}', i);
+                        if (end == string_view::npos) { m_lastError = "unterminated %{...} in the log format"; return; }
+                        argument = string(logFormat.substr(i + 1, end - i - 1));
+                        std::transform(argument.begin(), argument.end(), argument.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+                        i = end + 1;
+                    }
+                    if (i >= logFormat.size()) { m_lastError = "the log format ends within a directive"; return; }
+
+                    const auto directive = logFormat[i];
+                    switch (directive) {
+                        case '%': addLiteral('%'); continue;
+                        case 'h': case 'a': m_tokens.push_back({ Directive::CLIENT, {} }); break;
+                        case 'l': case 'u': m_tokens.push_back({ Directive::DASH, {} }); break;
+                        case 't':
+                            if (!argument.empty()) { m_lastError = "%{format}t isn't supported; use %t"; return; }
+                            m_tokens.push_back({ Directive::TIMESTAMP, {} });
+                            break;
+                        case 'r': m_tokens.push_back({ Directive::REQUEST_LINE, {} }); break;
+                        case 'm': m_tokens.push_back({ Directive::METHOD, {} }); break;
+                        case 'U': m_tokens.push_back({ Directive::URI, {} }); break;
+                        case 'q': m_tokens.push_back({ Directive::QUERY, {} }); break;
+                        case 'H': m_tokens.push_back({ Directive::PROTOCOL, {} }); break;
+                        case 's': m_tokens.push_back({ Directive::STATUS, {} }); break;
+                        case 'b': m_tokens.push_back({ Directive::SIZE_CLF, {} }); break;
+                        case 'B': case 'O': m_tokens.push_back({ Directive::SIZE, {} }); break;
+                        case 'I': m_tokens.push_back({ Directive::BYTES_RECEIVED, {} }); break;
+                        case 'D': m_tokens.push_back({ Directive::DURATION_MICROSECONDS, {} }); break;
+                        case 'T': m_tokens.push_back({ Directive::DURATION_SECONDS, {} }); break;
+                        case 'v': case 'V': m_tokens.push_back({ Directive::VIRTUAL_HOST, {} }); break;
+                        case 'p': m_tokens.push_back({ Directive::PORT, {} }); break;
+                        case 'i':
+                            if (argument == "referer") {
+                                m_tokens.push_back({ Directive::REFERER, {} });
+                            } else if (argument == "user-agent") {
+                                m_tokens.push_back({ Directive::USER_AGENT, {} });
+                            } else {
+                                m_tokens.push_back({ Directive::DASH, {} });
+                            }
+                            break;
+                        default:
+                            m_lastError = fmt::format("unsupported log format directive %{0:c}", directive);
+                            return;
+                    }
+                }
+            }
+
+            void appendToken(string& out, const Token& token) {
+                switch (token.directive) {
+                    case Directive::LITERAL: out += token.text; break;
+                    case Directive::CLIENT: appendClient(out, m_line.client); break;
+                    case Directive::DASH: out += '-'; break;
+                    case Directive::TIMESTAMP:
+                        out += '[';
+                        appendTimestamp(out, m_line.epoch);
+                        out += ']';
+                        break;
+                    case Directive::REQUEST_LINE:
+                        // httpd logs a connection which timed out before sending a request as "-" 408
+                        if (m_line.status == 408) {
+                            out += '-';
+                            break;
+                        }
+                        out += m_line.method;
+                        out += ' ';
+                        appendUri(out, m_line.uri);
+                        out += " HTTP/1.1";
+                        break;
+                    case Directive::METHOD: out += m_line.method; break;
+                    case Directive::URI: appendUri(out, m_line.uri); break;
+                    case Directive::QUERY: break;
+                    case Directive::PROTOCOL: out += "HTTP/1.1"; break;
+                    case Directive::STATUS: appendNumber(out, m_line.status); break;
+                    case Directive::SIZE_CLF:
+                        if (m_line.size == 0) {
+                            out += '-';
+                        } else {
+                            appendNumber(out, m_line.size);
+                        }
+                        break;
+                    case Directive::SIZE: appendNumber(out, m_line.size); break;
+                    case Directive::BYTES_RECEIVED: appendNumber(out, 300 + (m_line.extra & 0x3ff)); break;
+                    case Directive::DURATION_MICROSECONDS: appendNumber(out, m_line.duration); break;
+                    case Directive::DURATION_SECONDS: appendNumber(out, m_line.duration / 1000000); break;
+                    case Directive::VIRTUAL_HOST: out += VIRTUAL_HOSTS[m_line.uri % std::size(VIRTUAL_HOSTS)]; break;
+                    case Directive::PORT: out += "443"; break;
+                    case Directive::REFERER: out += REFERERS[(m_line.extra >> 10) % std::size(REFERERS)]; break;
+                    case Directive::USER_AGENT:
+                        if (m_line.userAgent <= m_cachedUserAgents.size()) {
+                            out += m_cachedUserAgents[m_line.userAgent - 1];
+                        } else {
+                            formatUserAgent(out, m_line.userAgent);
+                        }
+                        break;
+                }
+            }
+
+            uint16_t drawStatus() {
+                const auto u = m_random.nextDouble();
+                for (const auto& threshold : m_statusThresholds) {
+                    if (u < threshold.first) { return threshold.second; }
+                }
+
+                return m_statusThresholds.back().second;
+            }
+
+            static void appendNumber(string& out, uint64_t value) {
+                const fmt::format_int text(value);
+                out.append(text.data(), text.size());
+            }
+
+            /**
+             * @brief Maps a rank to an address. Multiplying by an odd constant is a bijection on 32 bits, so ranks never collide;
+             * whether a client uses IPv6 is a function of its rank, too, so it always does.
+             */
+            void appendClient(string& out, uint64_t rank) const {
+                const auto mixed = rank * 0x9e3779b97f4a7c15ull;
+                if (m_options.ipv6Share > 0 && static_cast<double>(mixed >> 11) * 0x1.0p-53 < m_options.ipv6Share) {
+                    format_to(std::back_inserter(out), "2001:db8:{0:x}:{1:x}::{2:x}", (rank >> 32) & 0xffff, (rank >> 16) & 0xffff, rank & 0xffff);
+                    return;
+                }
+
+                const auto address = static_cast<uint32_t>(rank * 2654435761u);
+                appendNumber(out, address >> 24);
+                out += '.';
+                appendNumber(out, (address >> 16) & 0xff);
+                out += '.';
+                appendNumber(out, (address >> 8) & 0xff);
+                out += '.';
+                appendNumber(out, address & 0xff);
+            }
+
+            void appendUri(string& out, uint64_t rank) const {
+                static constexpr string_view FILLER = "abcdefghijklmnopqrstuvwxyz0123456789-_abcdefghijklmnopqrstuvwxyz0123456789-_";
+                static constexpr char HEX[] = "0123456789abcdef";
+
+                // the padding is a function of the rank, so a URI always has the same length
+                const auto hash = rank * 0x9e3779b97f4a7c15ull;
+                const auto padding = m_options.uriPadding == 0 ? 0 : static_cast<size_t>((hash >> 33) % (2 * m_options.uriPadding + 1));
+
+                out += "/s";
+                appendNumber(out, rank % 16);
+                out += "/page-";
+                char digits[16];
+                size_t digitCount = 0;
+                for (auto value = rank; value != 0 || digitCount == 0; value >>= 4) { digits[digitCount++] = HEX[value & 0xf]; }
+                while (digitCount > 0) { out += digits[--digitCount]; }
+
+                for (size_t written = 0; written < padding; written += FILLER.size() / 2) {
+                    out += '/';
+                    out.append(FILLER.substr((hash >> 7) % (FILLER.size() / 2), std::min(padding - written, FILLER.size() / 2)));
+                }
+            }
+
+            static void formatUserAgent(string& out, uint64_t rank) {
+                const auto* family = USER_AGENT_FAMILIES[rank % std::size(USER_AGENT_FAMILIES)];
+                format_to(std::back_inserter(out), fmt::runtime(family), 20 + rank / std::size(USER_AGENT_FAMILIES));
+            }
+
+            /**
+             * @brief Appends dd/Mon/yyyy:HH:MM:SS +0000; consecutive lines mostly share their second, so the text is cached.
+             */
+            void appendTimestamp(string& out, int64_t epoch) {
+                if (epoch != m_cachedEpoch) {
+                    static constexpr const char* MONTHS[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+                    const auto time = static_cast<time_t>(epoch);
+                    tm utc{};
+                    gmtime_r(&time, &utc);
+
+                    m_cachedTimestamp.clear();
+                    format_to(
+                        std::back_inserter(m_cachedTimestamp), "{0:02d}/{1:s}/{2:04d}:{3:02d}:{4:02d}:{5:02d} +0000",
+                        utc.tm_mday, MONTHS[utc.tm_mon], utc.tm_year + 1900, utc.tm_hour, utc.tm_min, utc.tm_sec
+                    );
+                    m_cachedEpoch = epoch;
+                }
+
+                out += m_cachedTimestamp;
+            }
+
+        private:
+            SyntheticLogOptions                 m_options{};
+            SyntheticRandom                     m_random{};
+
+            ZipfDistribution                    m_clients;
+            ZipfDistribution                    m_uris;
+            ZipfDistribution                    m_userAgents;
+            vector<pair<double, uint16_t>>      m_statusThresholds{}; //!< Cumulative probabilities of the status codes
+            vector<string>                      m_cachedUserAgents{}; //!< The user agents of ranks 1..MAX_CACHED_USER_AGENTS
+
+            vector<Token>                       m_tokens{};
+            LineValues                          m_line{};
+            uint64_t                            m_lineIndex{0};
+            int64_t                             m_cachedEpoch{INT64_MIN};
+            string                              m_cachedTimestamp{};
+
+            string                              m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_SYNTHETICLOG_HPP
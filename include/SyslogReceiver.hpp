@@ -0,0 +1,277 @@
+/**
+ * @file SyslogReceiver.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the UDP syslog receiver, which reads datagrams in batches on several sockets sharing one port.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_SYSLOGRECEIVER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_SYSLOGRECEIVER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// libc
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace httpdreport {
+
+    using std::atomic;
+    using std::string;
+    using std::string_view;
+    using std::thread;
+    using std::unique_ptr;
+    using std::vector;
+
+    /**
+     * @brief Header-only implementation of the syslog (UDP) receiver.
+     *
+     * Every receiving thread owns a socket bound to the same address with SO_REUSEPORT; the kernel spreads senders over the
+     * sockets (by address and port, so a single sender always lands on the same thread). Datagrams are read up to
+     * BATCH_SIZE at a time with recvmmsg, stripped of their syslog header (RFC 3164 or RFC 5424) and handed to the batch
+     * handler on the receiving thread. Datagrams the kernel dropped because a socket's buffer was full are counted via SO_RXQ_OVFL.
+     */
+    class SyslogReceiver final {
+        public: // +++ Static +++
+            static constexpr size_t BATCH_SIZE = 64; //!< The maximum number of datagrams read per system call
+            static constexpr size_t MAX_DATAGRAM_SIZE = 8192; //!< Longer datagrams are truncated by the kernel, counted and skipped
+            static constexpr int32_t RECEIVE_BUFFER_SIZE = 8 << 20; //!< The requested socket buffer; the kernel caps it at net.core.rmem_max
+            static constexpr int32_t POLL_INTERVAL_MS = 100; //!< How long a thread waits for datagrams before re-checking for stop()
+
+            /**
+             * @brief Called on a receiving thread with the messages of one batch; the views are only valid during the call.
+             */
+            using BatchHandler = std::function<void(size_t threadIndex, const vector<string_view>& messages)>;
+
+            /**
+             * @brief Removes the syslog header from a message, if it has one, as well as trailing line breaks.
+             */
+            static string_view stripEnvelope(string_view message) {
+                while (!message.empty() && (message.back() == '\n' || message.back() == '\r' || message.back() == '\0')) { message.remove_suffix(1); }
+
+                const auto priorityEnd = message.find('>');
+                if (message.empty() || message[0] != '<' || priorityEnd == string_view::npos || priorityEnd > 4) { return message; }
+                message.remove_prefix(priorityEnd + 1);
+
+                if (message.size() >= 2 && std::isdigit(static_cast<unsigned char>(message[0])) && message[1] == ' ') {
+                    // RFC 5424: VERSION TIMESTAMP HOSTNAME APP-NAME PROCID MSGID STRUCTURED-DATA MSG
+                    for (auto i = 0; i < 6; i++) { message = skipToken(message); }
+                    if (message.empty() || message[0] != '[') { return skipBom(skipToken(message)); }
+
+                    // structured data elements may contain escaped brackets and spaces
+                    while (!message.empty() && message[0] == '[') {
+                        size_t end = 1;
+                        while (end < message.size() && message[end] != ']') { end += message[end] == '\\' ? 2 : 1; }
+                        message.remove_prefix(std::min(end + 1, message.size()));
+                    }
+                    if (!message.empty() && message[0] == ' ') { message.remove_prefix(1); }
+
+                    return skipBom(message);
+                }
+
+                // RFC 3164: "Mmm dd hh:mm:ss" [HOSTNAME] [TAG: ]MSG
+                if (message.size() > 16 && message[3] == ' ' && message[6] == ' ' && message[9] == ':' && message[12] == ':' && message[15] == ' ') {
+                    message.remove_prefix(16);
+                    if (isTag(message)) { return skipToken(message); }
+                    message = skipToken(message);
+                }
+
+                return isTag(message) ? skipToken(message) : message;
+            }
+
+        public: // +++ Constructor / Destructor +++
+            SyslogReceiver() = default;
+            SyslogReceiver(const SyslogReceiver&) = delete;
+            ~SyslogReceiver() { stop(); }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Binds threadCount sockets to address:port and starts receiving.
+             *
+             * @param address An IPv4 address, e.g. 127.0.0.1 or 0.0.0.0 for all interfaces.
+             *
+             * @return true If all threads are receiving. Otherwise getLastError() contains the reason.
+             */
+            bool start(const string& address, uint16_t port, size_t threadCount, BatchHandler handler) {
+                sockaddr_in bindAddress{};
+                bindAddress.sin_family = AF_INET;
+                bindAddress.sin_port = htons(port);
+                if (inet_pton(AF_INET, address.c_str(), &bindAddress.sin_addr) != 1) {
+                    m_lastError = "invalid IPv4 address " + address;
+                    return false;
+                }
+
+                m_handler = std::move(handler);
+                m_stopRequested = false;
+
+                for (size_t i = 0; i < std::max<size_t>(1, threadCount); i++) {
+                    auto socketState = std::make_unique<SocketState>();
+
+                    const int enable = 1;
+                    if (
+                        (socketState->fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0 ||
+                        setsockopt(socketState->fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0 ||
+                        setsockopt(socketState->fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) != 0 ||
+                        bind(socketState->fd, reinterpret_cast<sockaddr*>(&bindAddress), sizeof(bindAddress)) != 0
+                    ) {
+                        m_lastError = strerror(errno);
+                        if (socketState->fd >= 0) { close(socketState->fd); }
+                        stop();
+                        return false;
+                    }
+
+                    // a larger buffer absorbs bursts; the kernel silently caps it, which is harmless
+                    setsockopt(socketState->fd, SOL_SOCKET, SO_RCVBUF, &RECEIVE_BUFFER_SIZE, sizeof(RECEIVE_BUFFER_SIZE));
+
+                    m_sockets.emplace_back(std::move(socketState));
+                }
+
+                for (size_t i = 0; i < m_sockets.size(); i++) {
+                    m_sockets[i]->worker = thread([this, i]() { receiveLoop(i); });
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Stops all receiving threads and closes the sockets.
+             */
+            void stop() {
+                m_stopRequested = true;
+                for (auto& socketState : m_sockets) {
+                    if (socketState->worker.joinable()) { socketState->worker.join(); }
+                    close(socketState->fd);
+                }
+
+                m_sockets.clear();
+            }
+
+            uint64_t getReceivedDatagrams() const { return m_receivedDatagrams; } //!< Gets the number of datagrams received
+            uint64_t getTruncatedDatagrams() const { return m_truncatedDatagrams; } //!< Gets the number of datagrams skipped because they were too long
+
+            /**
+             * @brief Gets the number of datagrams the kernel dropped because a socket's buffer was full.
+             *
+             * @remarks The kernel reports drops with the next datagram a socket receives; drops after the last datagram aren't seen.
+             */
+            uint64_t getDroppedDatagrams() const { return m_droppedDatagrams; }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason of the last failure
+
+        private: // +++ Private Business +++
+            struct SocketState {
+                int                 fd{-1};
+                thread              worker{};
+                uint32_t            dropped{0}; //!< The socket's drop counter, as last reported by SO_RXQ_OVFL; only its worker uses it
+            };
+
+            static string_view skipToken(string_view text) {
+                const auto space = text.find(' ');
+                return space == string_view::npos ? string_view() : text.substr(space + 1);
+            }
+
+            static string_view skipBom(string_view text) { return text.rfind("\xEF\xBB\xBF", 0) == 0 ? text.substr(3) : text; }
+
+            static bool isTag(string_view text) {
+                const auto space = text.find(' ');
+                return space != string_view::npos && space > 0 && text[space - 1] == ':';
+            }
+
+            void receiveLoop(size_t threadIndex) {
+                auto& socketState = *m_sockets[threadIndex];
+
+                // one buffer, I/O vector and control buffer per datagram of the batch
+                vector<char> buffers(BATCH_SIZE * MAX_DATAGRAM_SIZE);
+                vector<char> controlBuffers(BATCH_SIZE * CMSG_SPACE(sizeof(uint32_t)));
+                vector<iovec> ioVectors(BATCH_SIZE);
+                vector<mmsghdr> headers(BATCH_SIZE);
+                vector<string_view> messages;
+                messages.reserve(BATCH_SIZE);
+
+                for (size_t i = 0; i < BATCH_SIZE; i++) {
+                    ioVectors[i] = { buffers.data() + i * MAX_DATAGRAM_SIZE, MAX_DATAGRAM_SIZE };
+                    headers[i].msg_hdr.msg_iov = &ioVectors[i];
+                    headers[i].msg_hdr.msg_iovlen = 1;
+                }
+
+                while (!m_stopRequested) {
+                    for (size_t i = 0; i < BATCH_SIZE; i++) {
+                        headers[i].msg_hdr.msg_control = controlBuffers.data() + i * CMSG_SPACE(sizeof(uint32_t));
+                        headers[i].msg_hdr.msg_controllen = CMSG_SPACE(sizeof(uint32_t));
+                        headers[i].msg_hdr.msg_flags = 0;
+                    }
+
+                    const auto received = recvmmsg(socketState.fd, headers.data(), BATCH_SIZE, MSG_DONTWAIT, nullptr);
+                    if (received <= 0) {
+                        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) { break; }
+
+                        pollfd fd{ socketState.fd, POLLIN, 0 };
+                        ::poll(&fd, 1, POLL_INTERVAL_MS);
+                        continue;
+                    }
+
+                    messages.clear();
+                    for (auto i = 0; i < received; i++) {
+                        const auto& header = headers[i].msg_hdr;
+                        for (auto* control = CMSG_FIRSTHDR(&header); control != nullptr; control = CMSG_NXTHDR(const_cast<msghdr*>(&header), control)) {
+                            if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SO_RXQ_OVFL) {
+                                uint32_t dropped = 0;
+                                std::memcpy(&dropped, CMSG_DATA(control), sizeof(dropped));
+                                // the counter wraps around; the difference doesn't
+                                m_droppedDatagrams += dropped - socketState.dropped;
+                                socketState.dropped = dropped;
+                            }
+                        }
+
+                        if (header.msg_flags & MSG_TRUNC) {
+                            m_truncatedDatagrams++;
+                            continue;
+                        }
+
+                        const auto message = stripEnvelope(string_view(static_cast<const char*>(ioVectors[i].iov_base), headers[i].msg_len));
+                        if (!message.empty()) { messages.emplace_back(message); }
+                    }
+
+                    m_receivedDatagrams += static_cast<uint64_t>(received);
+                    if (!messages.empty()) { m_handler(threadIndex, messages); }
+                }
+            }
+
+        private:
+            BatchHandler                        m_handler{};
+            vector<unique_ptr<SocketState>>     m_sockets{};
+            atomic<bool>                        m_stopRequested{false};
+
+            atomic<uint64_t>                    m_receivedDatagrams{0};
+            atomic<uint64_t>                    m_truncatedDatagrams{0};
+            atomic<uint64_t>                    m_droppedDatagrams{0}; //!< The sum of all sockets' drops, so it can be read while stop() runs
+
+            string                              m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_SYSLOGRECEIVER_HPP
@@ -0,0 +1,97 @@
+/**
+ * @file TopN.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains a bounded top-N collector.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_TOPN_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_TOPN_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace httpdreport {
+
+    using std::vector;
+
+    /**
+     * @brief Keeps the N largest elements offered to it, using O(N) memory.
+     *
+     * @tparam T The element type.
+     * @tparam Less A strict weak ordering; the "largest" elements according to it are kept.
+     */
+    template<typename T, typename Less = std::less<T>>
+    class TopN final {
+        public: // +++ Static +++
+            static constexpr size_t MAX_INITIAL_CAPACITY = 256; //!< The most elements reserved up front
+
+        public: // +++ Constructor / Destructor +++
+            explicit TopN(size_t capacity, Less less = Less()): m_capacity(capacity), m_greater(GreaterThan{ less }) {
+                // the capacity is user input (--top, queries); the heap only grows with the elements actually offered
+                m_heap.reserve(std::min(capacity, MAX_INITIAL_CAPACITY));
+            }
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Offers an element; it is kept if it is amongst the N largest seen so far.
+             */
+            void offer(T value) {
+                if (m_capacity == 0) { return; }
+
+                if (m_heap.size() < m_capacity) {
+                    m_heap.push_back(std::move(value));
+                    std::push_heap(m_heap.begin(), m_heap.end(), m_greater);
+                } else if (m_greater(value, m_heap.front())) {
+                    // the heap's front is the smallest element kept
+                    std::pop_heap(m_heap.begin(), m_heap.end(), m_greater);
+                    m_heap.back() = std::move(value);
+                    std::push_heap(m_heap.begin(), m_heap.end(), m_greater);
+                }
+            }
+
+            /**
+             * @brief Gets a value indicating whether or not an element would currently be kept if offered.
+             *
+             * Allows callers to skip building expensive elements which would be discarded anyway.
+             */
+            bool wouldKeep(const T& value) const { return m_capacity > 0 && (m_heap.size() < m_capacity || m_greater(value, m_heap.front())); }
+
+            /**
+             * @brief Gets the kept elements, largest first.
+             */
+            vector<T> sorted() const {
+                auto result = m_heap;
+                std::sort(result.begin(), result.end(), m_greater);
+
+                return result;
+            }
+
+            size_t size() const { return m_heap.size(); } //!< Gets the number of elements kept
+
+        private:
+            struct GreaterThan {
+                Less less;
+                bool operator()(const T& a, const T& b) const { return less(b, a); }
+            };
+
+            size_t      m_capacity{0};
+
+            GreaterThan m_greater;
+
+            vector<T>   m_heap{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_TOPN_HPP
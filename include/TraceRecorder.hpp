@@ -0,0 +1,276 @@
+/**
+ * @file TraceRecorder.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the --trace recorder, which writes the pipeline's timeline in the Chrome trace event format.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_TRACERECORDER_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_TRACERECORDER_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// fmt
+#include <fmt/format.h>
+
+// libc
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace httpdreport {
+
+    using fmt::format;
+
+    using std::atomic;
+    using std::string;
+    using std::string_view;
+    using std::unique_ptr;
+    using std::vector;
+
+    /**
+     * @brief A finished span of work; names are string literals, so recording one copies no string.
+     */
+    struct TraceEvent final {
+        const char* name{nullptr};
+        uint64_t    startNanos{0};
+        uint64_t    durationNanos{0};
+        uint64_t    bytes{0};
+        uint64_t    items{0};
+        uint32_t    fileId{0};
+    };
+
+    /**
+     * @brief Header-only implementation of the --trace timeline.
+     *
+     * Every thread records in to a ring of its own, which only it writes, so recording takes no lock and touches no shared
+     * cache line. A ring keeps the most recent events; older ones are overwritten and counted as dropped. The rings are written
+     * as complete ("X") events once the traced threads are done, one track per thread, and open in chrome://tracing and Perfetto.
+     */
+    class TraceRecorder final {
+        public: // +++ Static +++
+            static constexpr size_t DEFAULT_RING_CAPACITY = 1 << 16; //!< Events kept per thread; a power of two
+            static constexpr uint32_t NO_FILE = UINT32_MAX; //!< The file of events recorded outside of any file
+
+            /**
+             * @brief Gets the monotonic clock in nanoseconds; PipelineStats uses the same clock, so its timings can be recorded as is.
+             */
+            static uint64_t getNanos() {
+                timespec time{};
+                clock_gettime(CLOCK_MONOTONIC, &time);
+
+                return static_cast<uint64_t>(time.tv_sec) * 1000000000ull + static_cast<uint64_t>(time.tv_nsec);
+            }
+
+        public: // +++ Constructor / Destructor +++
+            explicit TraceRecorder(size_t ringCapacity = DEFAULT_RING_CAPACITY):
+                m_id(s_nextId.fetch_add(1) + 1), m_ringCapacity(roundUpToPowerOfTwo(ringCapacity)), m_originNanos(getNanos()) {}
+            TraceRecorder(const TraceRecorder&) = delete;
+
+        public: // +++ Business Logic +++
+            /**
+             * @brief Records a span from its construction until end() or its destruction, whichever comes first.
+             */
+            class Span final {
+                public:
+                    Span(TraceRecorder* trace, const char* name): m_trace(trace), m_name(name), m_startNanos(trace != nullptr ? getNanos() : 0) {}
+                    Span(const Span&) = delete;
+                    ~Span() { end(); }
+
+                    void end(uint64_t bytes = 0, uint64_t items = 0) {
+                        if (m_trace == nullptr) { return; }
+
+                        m_trace->record(m_name, m_startNanos, getNanos(), bytes, items);
+                        m_trace = nullptr;
+                    }
+
+                private:
+                    TraceRecorder*  m_trace{nullptr}; //!< nullptr if tracing is disabled or the span has ended
+                    const char*     m_name{nullptr};
+                    uint64_t        m_startNanos{0};
+            };
+
+            /**
+             * @brief Records a span of the calling thread.
+             *
+             * @param name A string literal (or any string outliving the recorder).
+             * @param startNanos The start, from getNanos().
+             * @param endNanos The end, from getNanos().
+             */
+            void record(const char* name, uint64_t startNanos, uint64_t endNanos, uint64_t bytes = 0, uint64_t items = 0) {
+                auto& ring = getRing();
+                const auto head = ring.head.load(std::memory_order_relaxed);
+
+                auto& event = ring.events[head & (m_ringCapacity - 1)];
+                event.name = name;
+                event.startNanos = startNanos;
+                event.durationNanos = endNanos > startNanos ? endNanos - startNanos : 0;
+                event.bytes = bytes;
+                event.items = items;
+                event.fileId = ring.fileId;
+
+                ring.head.store(head + 1, std::memory_order_release);
+            }
+
+            /**
+             * @brief Registers a file, so events can be tagged with it.
+             *
+             * @return uint32_t The file's id for setFile().
+             */
+            uint32_t addFile(const string& path) {
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_files.push_back(path);
+
+                return static_cast<uint32_t>(m_files.size() - 1);
+            }
+
+            void setFile(uint32_t fileId) { getRing().fileId = fileId; } //!< Tags the calling thread's following events with a file (or NO_FILE)
+            void setThreadName(const string& name) { getRing().threadName = name; } //!< Names the calling thread's track
+
+            /**
+             * @brief Writes all recorded events. The threads which recorded them must be done recording.
+             *
+             * @return true If the file was written. Otherwise getLastError() contains the reason.
+             */
+            bool write(const string& path) {
+                auto* file = fopen(path.c_str(), "we");
+                if (file == nullptr) {
+                    m_lastError = format("failed to create {0:s}: {1:s}", path, strerror(errno));
+                    return false;
+                }
+
+                std::lock_guard<std::mutex> guard(m_lock);
+                const auto processId = getpid();
+                uint64_t droppedEvents = 0;
+                bool first = true;
+                auto out = fmt::memory_buffer();
+                fmt::format_to(std::back_inserter(out), "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+                for (const auto& ring : m_rings) {
+                    fmt::format_to(
+                        std::back_inserter(out), "{0:s}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{1:d},\"tid\":{2:d},\"args\":{{\"name\":\"{3:s}\"}}}}",
+                        first ? "" : ",\n", processId, ring->threadId, escape(ring->threadName)
+                    );
+                    first = false;
+
+                    const auto head = ring->head.load(std::memory_order_acquire);
+                    const auto oldest = head > m_ringCapacity ? head - m_ringCapacity : 0;
+                    droppedEvents += oldest;
+
+                    for (auto index = oldest; index < head; index++) {
+                        const auto& event = ring->events[index & (m_ringCapacity - 1)];
+                        fmt::format_to(
+                            std::back_inserter(out), ",\n{{\"name\":\"{0:s}\",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":{1:d},\"tid\":{2:d},\"ts\":{3:.3f},\"dur\":{4:.3f},\"args\":{{",
+                            event.name, processId, ring->threadId, static_cast<double>(event.startNanos > m_originNanos ? event.startNanos - m_originNanos : 0) / 1000.0,
+                            static_cast<double>(event.durationNanos) / 1000.0
+                        );
+                        fmt::format_to(std::back_inserter(out), "\"bytes\":{0:d},\"items\":{1:d}", event.bytes, event.items);
+                        if (event.fileId < m_files.size()) { fmt::format_to(std::back_inserter(out), ",\"file\":\"{0:s}\"", escape(m_files[event.fileId])); }
+                        fmt::format_to(std::back_inserter(out), "}}}}");
+
+                        if (out.size() >= (1 << 20)) {
+                            fwrite(out.data(), 1, out.size(), file);
+                            out.clear();
+                        }
+                    }
+                }
+
+                fmt::format_to(std::back_inserter(out), "\n],\"otherData\":{{\"dropped_events\":{0:d}}}}}\n", droppedEvents);
+                fwrite(out.data(), 1, out.size(), file);
+
+                if (ferror(file) != 0 || fclose(file) != 0) {
+                    m_lastError = format("failed to write {0:s}: {1:s}", path, strerror(errno));
+                    return false;
+                }
+
+                return true;
+            }
+
+            const string& getLastError() const { return m_lastError; } //!< Gets the reason write() failed
+
+        private: // +++ Private Business +++
+            struct ThreadRing {
+                uint32_t            threadId{0};
+                string              threadName{};
+                uint32_t            fileId{NO_FILE}; //!< Only accessed by the ring's thread
+                vector<TraceEvent>  events{};
+                atomic<uint64_t>    head{0}; //!< The number of events ever recorded
+            };
+
+            /**
+             * @brief Gets the calling thread's ring, creating it on the thread's first event; only that takes the lock.
+             */
+            ThreadRing& getRing() {
+                thread_local uint64_t t_recorderId = 0;
+                thread_local ThreadRing* t_ring = nullptr;
+                if (t_recorderId == m_id) { return *t_ring; }
+
+                auto ring = std::make_unique<ThreadRing>();
+                ring->threadId = static_cast<uint32_t>(syscall(SYS_gettid));
+                ring->threadName = ring->threadId == static_cast<uint32_t>(getpid()) ? "main" : format("thread {0:d}", ring->threadId);
+                ring->events.resize(m_ringCapacity);
+
+                std::lock_guard<std::mutex> guard(m_lock);
+                m_rings.push_back(std::move(ring));
+                t_recorderId = m_id;
+                t_ring = m_rings.back().get();
+
+                return *t_ring;
+            }
+
+            static size_t roundUpToPowerOfTwo(size_t value) {
+                size_t power = 1;
+                while (power < value) { power <<= 1; }
+
+                return power;
+            }
+
+            static string escape(string_view value) {
+                string escaped;
+                escaped.reserve(value.size());
+                for (const auto c : value) {
+                    if (c == '\\' || c == '"') {
+                        escaped += '\\';
+                    } else if (static_cast<unsigned char>(c) < 0x20) {
+                        escaped += format("\\u{0:04x}", static_cast<unsigned>(c));
+                        continue;
+                    }
+                    escaped += c;
+                }
+
+                return escaped;
+            }
+
+        private:
+            static inline atomic<uint64_t>  s_nextId{0}; //!< Tells the rings of a recorder apart from those of its predecessors
+
+            const uint64_t                  m_id{0};
+            const size_t                    m_ringCapacity{DEFAULT_RING_CAPACITY};
+            const uint64_t                  m_originNanos{0}; //!< Timestamps are relative to the recorder's creation
+
+            std::mutex                      m_lock{};
+            vector<unique_ptr<ThreadRing>>  m_rings{};
+            vector<string>                  m_files{};
+
+            string                          m_lastError{};
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_TRACERECORDER_HPP
@@ -0,0 +1,164 @@
+/**
+ * @file WorkProtocol.hpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Contains the line-based TCP protocol spoken between the coordinator and its workers.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+#ifndef HTTPD_REPORT_GENERATOR_INCLUDE_WORKPROTOCOL_HPP
+#define HTTPD_REPORT_GENERATOR_INCLUDE_WORKPROTOCOL_HPP
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+// libc
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace httpdreport {
+
+    using std::string;
+    using std::string_view;
+
+    /**
+     * @brief Header-only implementation of one end of a coordinator/worker connection.
+     *
+     * Messages are single lines of space-separated words; only a snapshot is followed by raw bytes.
+     *
+     *     worker -> coordinator                    coordinator -> worker
+     *     HELLO <name>                             WORK <id> <start> <end> <path>      read the lines starting in [start, end)
+     *     DONE <id>                                SPLIT <id>                          give up the second half of range <id>
+     *     FAILED <id> <reason>                     FINISH                              send the snapshot and disconnect
+     *     SPLIT <id> <end>  (range now ends there)
+     *     KEEP <id>         (range can't be split)
+     *     SNAPSHOT <bytes> <rejected lines>, followed by the snapshot
+     *
+     * A range's end is WHOLE_FILE if the coordinator doesn't know (or can't split) the file.
+     */
+    class WorkConnection final {
+        public: // +++ Static +++
+            static constexpr uint64_t WHOLE_FILE = UINT64_MAX; //!< The end of a range which covers the rest of its file
+            static constexpr size_t MAX_LINE_LENGTH = 64 << 10; //!< Longer messages are treated as a protocol error
+
+        public: // +++ Constructor / Destructor +++
+            explicit WorkConnection(int fd): m_fd(fd) {
+                // messages are tiny and answered immediately, so don't let Nagle hold them back
+                const int enable = 1;
+                setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            }
+            WorkConnection(const WorkConnection&) = delete;
+            ~WorkConnection() { if (m_fd >= 0) { close(m_fd); } }
+
+        public: // +++ Business Logic +++
+            int getFd() const { return m_fd; } //!< Gets the socket, e.g. to poll it
+
+            /**
+             * @brief Sends a single message; the line break is appended.
+             *
+             * @return false If the connection is broken.
+             */
+            bool sendLine(string_view line) {
+                string message(line);
+                message += '\n';
+
+                return sendAll(message.data(), message.size());
+            }
+
+            /**
+             * @brief Sends size bytes of a file, starting at its beginning.
+             */
+            bool sendFile(int fd, uint64_t size) {
+                off_t offset = 0;
+                while (static_cast<uint64_t>(offset) < size) {
+                    const auto sent = sendfile(m_fd, fd, &offset, static_cast<size_t>(size - static_cast<uint64_t>(offset)));
+                    if (sent < 0 && errno == EINTR) { continue; }
+                    if (sent <= 0) { return false; }
+                }
+
+                return true;
+            }
+
+            /**
+             * @brief Receives whatever the peer sent; blocks if nothing is pending.
+             *
+             * @return false If the peer closed the connection or it broke.
+             */
+            bool receive() {
+                char buffer[64 << 10];
+                ssize_t bytesRead = 0;
+                do {
+                    bytesRead = recv(m_fd, buffer, sizeof(buffer), 0);
+                } while (bytesRead < 0 && errno == EINTR);
+
+                if (bytesRead <= 0) { return false; }
+
+                m_pending.append(buffer, static_cast<size_t>(bytesRead));
+                return true;
+            }
+
+            /**
+             * @brief Takes the next complete message received.
+             *
+             * @return false If no complete message is pending.
+             */
+            bool nextLine(string& line) {
+                const auto newLine = m_pending.find('\n');
+                if (newLine == string::npos) { return false; }
+
+                line.assign(m_pending, 0, newLine);
+                m_pending.erase(0, newLine + 1);
+                return true;
+            }
+
+            /**
+             * @brief Takes up to maxBytes of the raw bytes received after the last message, e.g. the beginning of a snapshot.
+             */
+            string takeBytes(size_t maxBytes) {
+                const auto count = std::min(maxBytes, m_pending.size());
+                string bytes = m_pending.substr(0, count);
+                m_pending.erase(0, count);
+
+                return bytes;
+            }
+
+            /**
+             * @brief Gets a value indicating whether or not the peer sent an overlong message.
+             */
+            bool isOverlong() const { return m_pending.size() > MAX_LINE_LENGTH && m_pending.find('\n') == string::npos; }
+
+        private: // +++ Private Business +++
+            bool sendAll(const char* data, size_t size) {
+                while (size > 0) {
+                    const auto sent = send(m_fd, data, size, MSG_NOSIGNAL);
+                    if (sent < 0 && errno == EINTR) { continue; }
+                    if (sent <= 0) { return false; }
+
+                    data += sent;
+                    size -= static_cast<size_t>(sent);
+                }
+
+                return true;
+            }
+
+        private:
+            int     m_fd{-1};
+            string  m_pending{}; //!< Received bytes which weren't taken yet
+    };
+
+}
+
+#endif // HTTPD_REPORT_GENERATOR_INCLUDE_WORKPROTOCOL_HPP
@@ -0,0 +1,91 @@
+/**
+ * @file AllocationHooks.cpp
+ * @author Simon Cahill (contact@simonc.eu)
+ * @brief Replaces the global operator new and delete, so allocations can be counted (see AllocationCounter).
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026 Simon Cahill
+ */
+
+/////////////////////
+// SYSTEM INCLUDES //
+/////////////////////
+
+// stl
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+/////////////////////
+// LOCAL  INCLUDES //
+/////////////////////
+#include "AllocationCounter.hpp"
+
+using httpdreport::AllocationCounter;
+
+namespace {
+
+    void* allocate(size_t size) {
+        AllocationCounter::recordAllocation(size);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void* allocateAligned(size_t size, std::align_val_t alignment) {
+        AllocationCounter::recordAllocation(size);
+
+        void* memory = nullptr;
+        const auto minAlignment = std::max(static_cast<size_t>(alignment), sizeof(void*));
+        return posix_memalign(&memory, minAlignment, size == 0 ? 1 : size) == 0 ? memory : nullptr;
+    }
+
+    void deallocate(void* memory) {
+        if (memory == nullptr) { return; }
+
+        AllocationCounter::recordDeallocation();
+        std::free(memory);
+    }
+
+    void* allocateOrThrow(size_t size) {
+        while (true) {
+            if (auto* memory = allocate(size); memory != nullptr) { return memory; }
+
+            auto handler = std::get_new_handler();
+            if (handler == nullptr) { throw std::bad_alloc(); }
+            handler();
+        }
+    }
+
+    void* allocateAlignedOrThrow(size_t size, std::align_val_t alignment) {
+        while (true) {
+            if (auto* memory = allocateAligned(size, alignment); memory != nullptr) { return memory; }
+
+            auto handler = std::get_new_handler();
+            if (handler == nullptr) { throw std::bad_alloc(); }
+            handler();
+        }
+    }
+
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete(void* memory) noexcept { deallocate(memory); }
+void operator delete[](void* memory) noexcept { deallocate(memory); }
+void operator delete(void* memory, size_t) noexcept { deallocate(memory); }
+void operator delete[](void* memory, size_t) noexcept { deallocate(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { deallocate(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { deallocate(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { deallocate(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { deallocate(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { deallocate(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { deallocate(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(memory); }
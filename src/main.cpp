@@ -13,20 +13,62 @@
 /////////////////////
 
 // stl
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 // fmt
 #include <fmt/format.h>
 
 // libc
+#include <errno.h>
 #include <getopt.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /////////////////////
 // LOCAL  INCLUDES //
 /////////////////////
+#include "AccessLogParser.hpp"
+#include "AggregateSnapshot.hpp"
 #include "AppOptions.hpp"
+#include "ArrowExporter.hpp"
+#include "LiveAggregates.hpp"
+#include "LogFollower.hpp"
+#include "LogReader.hpp"
 #include "LogSearcher.hpp"
+#include "MetricsRegistry.hpp"
+#include "MetricsServer.hpp"
+#include "PipeReceiver.hpp"
+#include "PipelineStats.hpp"
+#include "Probes.hpp"
+#include "ProgressReporter.hpp"
+#include "QueryServer.hpp"
+#include "ReportDefinition.hpp"
+#include "ReportOutput.hpp"
+#include "ReportRenderer.hpp"
+#include "ReportCoordinator.hpp"
+#include "ReportWorker.hpp"
+#include "RequestAggregator.hpp"
+#include "SharedSnapshot.hpp"
+#include "SnapshotDiff.hpp"
+#include "SqliteExporter.hpp"
+#include "StateFile.hpp"
+#include "SyslogReceiver.hpp"
+#include "TraceRecorder.hpp"
 #include "resources/Resources.hpp"
 
 using fmt::format;
@@ -35,22 +77,1112 @@ using std::cerr;
 using std::cout;
 using std::endl;
 using std::string;
+using std::pair;
+using std::shared_ptr;
+using std::string_view;
+using std::unique_ptr;
+using std::vector;
+
+namespace fs = std::filesystem;
 
 //=======================================
 // Prototypes
 //=======================================
 int parseArgs(const int32_t argc, char* const* argv); //!< Parses incoming command-line arguments
+int run(); //!< Runs the mode selected by the command-line arguments
+int diffSnapshots(); //!< Compares two aggregate snapshots
+int generateReport(); //!< Parses all inputs and writes the report and all configured exports
+int runDaemon(); //!< Follows the logs and answers queries until stopped
+int runPipe(); //!< Aggregates the lines piped in by httpd until the pipe is closed
+int runSyslog(); //!< Aggregates the lines received via syslog until stopped
+int runCoordinator(); //!< Distributes the files to workers and writes the report of their merged snapshots
+int runWorker(); //!< Reads the file ranges a coordinator assigns and returns a snapshot
+bool parseEndpoint(const string& value, const string& defaultHost, string& host, uint16_t& port); //!< Splits [host:]port
+int dumpSharedSnapshot(); //!< Prints the figures a running daemon publishes in shared memory
+bool writeAggregateFiles(const httpdreport::RequestAggregator& aggregator); //!< Atomically replaces the snapshot and report files with the current state
+bool startMetrics(httpdreport::MetricsServer& server); //!< Starts the /metrics listener, if configured
+void writeMetricsFile(const httpdreport::MetricsRegistry& registry); //!< Replaces the node_exporter text file, if configured
+bool startSharedSnapshot(httpdreport::SharedSnapshotWriter& writer); //!< Starts publishing to shared memory, if configured
+
+void installStopHandlers(); //!< Makes SIGINT and SIGTERM request a clean shutdown
+void installReloadHandler(); //!< Makes SIGHUP request a reload of the report definitions
+void installDumpHandler(); //!< Makes SIGUSR1 request a partial report
+
+template<typename LineHandler>
+bool forEachLogLine(LineHandler&& handler, httpdreport::PipelineProgress& progress, httpdreport::PipelineStats* stats); //!< Reads all configured inputs and passes each line to the handler
+unique_ptr<httpdreport::PipelineStats> createStats(); //!< Creates the statistics if --stats or --trace was given
+void printStats(const httpdreport::PipelineStats* stats); //!< Prints the --stats report, if requested
+
+template<typename Receiver, typename CounterFormatter>
+int runLiveInput(const string& option, Receiver&& receive, CounterFormatter&& describeCounters); //!< Serves and dumps the tables fed by a live input
+
+vector<fs::path> getInputFiles(); //!< Gets the list of access logs to read
 
 void printHelp(); //!< Prints the help text to the terminal
 void printVersion(); //!< Prints the version info to the terminal
 
 static httpdreport::AppOptions g_appOptions{};
+static std::atomic<bool> g_stopRequested{false};
+static std::atomic<bool> g_reloadRequested{false};
+static std::atomic<bool> g_dumpRequested{false};
+static unique_ptr<httpdreport::TraceRecorder> g_trace{};
 
 int main(const int32_t argc, char* const* argv) {
     if (auto retCode = parseArgs(argc, argv); retCode > 0) {
         return retCode - 1;
     }
 
+    // the timeline is written once the run is over, whatever its outcome; a failed run is often the interesting one
+    if (!g_appOptions.TraceFile.empty()) { g_trace = std::make_unique<httpdreport::TraceRecorder>(); }
+
+    const auto exitCode = run();
+    if (g_trace && !g_trace->write(g_appOptions.TraceFile)) {
+        cerr << format("Failed to write the trace: {0:s}", g_trace->getLastError()) << endl;
+        return exitCode == 0 ? 1 : exitCode;
+    }
+
+    return exitCode;
+}
+
+int run() {
+    if (!g_appOptions.DiffSnapshotFiles.empty()) {
+        return diffSnapshots();
+    }
+
+    if (!g_appOptions.SharedSnapshotDumpName.empty()) {
+        return dumpSharedSnapshot();
+    }
+
+    if (g_appOptions.ReadFromPipe) {
+        return runPipe();
+    }
+
+    if (!g_appOptions.SyslogListenAddress.empty()) {
+        return runSyslog();
+    }
+
+    if (!g_appOptions.WorkerCoordinatorAddress.empty()) {
+        return runWorker();
+    }
+
+    if (!g_appOptions.CoordinatorListenAddress.empty()) {
+        return runCoordinator();
+    }
+
+    if (!g_appOptions.DaemonSocketFile.empty()) {
+        return runDaemon();
+    }
+
+    return generateReport();
+}
+
+/**
+ * @brief Compares the two snapshots passed via --diff and writes the differences to the report output.
+ * 
+ * @return int The application's exit code.
+ */
+int diffSnapshots() {
+    if (g_appOptions.DiffSnapshotFiles.size() != 2) {
+        cerr << "--diff requires two snapshot files: --diff old.snap new.snap" << endl;
+        return 1;
+    }
+
+    httpdreport::ReportOutput output;
+    if (!output.open(g_appOptions.OutputFile, httpdreport::ReportOutput::getCompressionForPath(g_appOptions.OutputFile))) {
+        cerr << format("Failed to open report output: {0:s}", output.getLastError()) << endl;
+        return 1;
+    }
+
+    httpdreport::SnapshotDiff diff(output, g_appOptions.TopCount);
+    if (!diff.compare(g_appOptions.DiffSnapshotFiles[0], g_appOptions.DiffSnapshotFiles[1])) {
+        cerr << format("Failed to compare snapshots: {0:s}", diff.getLastError()) << endl;
+        return 1;
+    }
+
+    if (!output.close()) {
+        cerr << format("Failed to write report: {0:s}", output.getLastError()) << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Gets the access logs to process; either those passed on the command-line or those found under the log directory.
+ * 
+ * @return vector<fs::path> The files to read.
+ */
+vector<fs::path> getInputFiles() {
+    if (!g_appOptions.InputFiles.empty()) {
+        return vector<fs::path>(g_appOptions.InputFiles.begin(), g_appOptions.InputFiles.end());
+    }
+
+    httpdreport::LogSearcher searcher(g_appOptions);
+    searcher.searchLogFiles();
+
+    return searcher.getAccessLogs();
+}
+
+/**
+ * @brief Reads every configured input (stdin or files) and passes each line to a handler.
+ * 
+ * @param handler A callable accepting a string_view per line.
+ * @param progress Receives the number of files and bytes to read and those read so far.
+ * @param stats Receives the time spent finding and reading the inputs; may be nullptr.
+ * 
+ * @return true If all inputs were read successfully.
+ * @return false If at least one input couldn't be read.
+ */
+template<typename LineHandler>
+bool forEachLogLine(LineHandler&& handler, httpdreport::PipelineProgress& progress, httpdreport::PipelineStats* stats) {
+    httpdreport::LogReader reader;
+    reader.setByteCounters(&progress.inputBytes, &progress.decodedBytes);
+    reader.setStats(stats);
+
+    if (g_appOptions.ReadFromStdin) {
+        progress.totalFiles = 1;
+        const auto success = reader.readDescriptor(STDIN_FILENO, handler);
+        progress.filesDone.add(1);
+
+        return success;
+    }
+
+    // the sizes on disk are known up front, so the progress can be given as a share of the total
+    vector<pair<fs::path, uint64_t>> files;
+    httpdreport::PipelineStats::Timer discoveryTimer(stats, httpdreport::PipelineStage::DISCOVERY);
+    for (const auto& path : getInputFiles()) {
+        if (!g_appOptions.ReadGzippedFiles && httpdreport::LogReader::isGzipFile(path)) {
+            cerr << format("Gzipped file {0:s} detected! Will ignore. Use --gzip to read it.", path.string()) << endl;
+            continue;
+        }
+
+        std::error_code error;
+        const auto size = fs::file_size(path, error);
+        files.emplace_back(path, error ? 0 : size);
+        progress.totalInputBytes += files.back().second;
+    }
+    progress.totalFiles = files.size();
+    discoveryTimer.stop(0, files.size());
+
+    bool success = true;
+    for (const auto& file : files) {
+        const auto inputBytesBefore = progress.inputBytes.get();
+        if (!reader.readFile(file.first, handler)) {
+            cerr << format("Failed to read {0:s}: {1:s}", file.first.string(), strerror(errno)) << endl;
+            success = false;
+        }
+
+        // zlib doesn't report the compressed bytes it consumed exactly; a finished file counts in full
+        const auto inputBytesRead = progress.inputBytes.get() - inputBytesBefore;
+        if (inputBytesRead < file.second) { progress.inputBytes.add(file.second - inputBytesRead); }
+        progress.filesDone.add(1);
+    }
+
+    return success;
+}
+
+/**
+ * @brief Parses all configured inputs in a single pass, feeding the aggregate tables and any configured exports.
+ * 
+ * @return int The application's exit code.
+ */
+int generateReport() {
+    using httpdreport::PipelineStage;
+    using httpdreport::PipelineStats;
+    using httpdreport::RequestAggregator;
+
+    auto stats = createStats();
+
+    vector<httpdreport::ReportDefinition> reports;
+    if (!g_appOptions.ReportConfigFile.empty()) {
+        string error;
+        if (!httpdreport::loadReportDefinitions(g_appOptions.ReportConfigFile, reports, error)) {
+            cerr << format("Failed to load reports: {0:s}", error) << endl;
+            return 1;
+        }
+    } else if (!g_appOptions.OutputFile.empty() || (g_appOptions.ArrowOutputFile.empty() && g_appOptions.SqliteOutputFile.empty() && g_appOptions.SnapshotFile.empty())) {
+        // the default report is only skipped if the user asked for exports only
+        reports.emplace_back();
+        reports.back().outputFile = g_appOptions.OutputFile;
+    }
+
+    // exports need every field and table; otherwise only decode and aggregate what the reports use. The timestamp is always
+    // decoded: it's what rejects a garbled line, so which lines are counted mustn't depend on the sections rendered
+    const bool needsAllFields = !g_appOptions.ArrowOutputFile.empty() || !g_appOptions.SqliteOutputFile.empty() || !g_appOptions.SnapshotFile.empty();
+    uint32_t recordFields = needsAllFields ? static_cast<uint32_t>(httpdreport::FIELD_ALL) : static_cast<uint32_t>(httpdreport::FIELD_TIMESTAMP);
+    uint32_t unfilteredTables = needsAllFields ? static_cast<uint32_t>(httpdreport::TABLE_ALL) : 0;
+    for (const auto& report : reports) {
+        recordFields |= report.getRequiredFields();
+        if (report.filter.isEmpty()) { unfilteredTables |= httpdreport::getRequiredTables(report.sections); }
+    }
+
+    // all unfiltered reports and exports share one set of tables; filtered reports get their own
+    unique_ptr<RequestAggregator> unfilteredAggregator;
+    if (unfilteredTables != 0) { unfilteredAggregator = std::make_unique<RequestAggregator>(unfilteredTables); }
+
+    vector<unique_ptr<RequestAggregator>> filteredAggregators;
+    vector<RequestAggregator*> reportAggregators;
+    vector<pair<const httpdreport::RequestFilter*, RequestAggregator*>> filteredSinks;
+    for (const auto& report : reports) {
+        if (report.filter.isEmpty()) {
+            reportAggregators.push_back(unfilteredAggregator.get());
+            continue;
+        }
+
+        filteredAggregators.emplace_back(std::make_unique<RequestAggregator>(httpdreport::getRequiredTables(report.sections)));
+        reportAggregators.push_back(filteredAggregators.back().get());
+        filteredSinks.emplace_back(&report.filter, filteredAggregators.back().get());
+    }
+
+    unique_ptr<httpdreport::ArrowExporter> arrowExporter;
+    if (!g_appOptions.ArrowOutputFile.empty()) {
+        arrowExporter = std::make_unique<httpdreport::ArrowExporter>();
+        if (!arrowExporter->open(g_appOptions.ArrowOutputFile)) {
+            cerr << format("Failed to open {0:s}: {1:s}", g_appOptions.ArrowOutputFile, strerror(errno)) << endl;
+            return 1;
+        }
+    }
+
+    unique_ptr<httpdreport::SqliteExporter> sqliteExporter;
+    if (!g_appOptions.SqliteOutputFile.empty()) {
+        sqliteExporter = std::make_unique<httpdreport::SqliteExporter>();
+        if (!sqliteExporter->open(g_appOptions.SqliteOutputFile, g_appOptions.SqliteIncludeRequests)) {
+            cerr << format("Failed to create {0:s}: {1:s}", g_appOptions.SqliteOutputFile, sqliteExporter->getLastError()) << endl;
+            return 1;
+        }
+    }
+
+    // the outputs are opened up front, so a bad path fails the run before the logs are read rather than after
+    const auto describeReport = [](const httpdreport::ReportDefinition& report) {
+        const auto path = report.outputFile.empty() ? string("stdout") : report.outputFile;
+        return report.name.empty() ? path : format("{0:s} (report {1:s})", path, report.name);
+    };
+
+    vector<unique_ptr<httpdreport::ReportOutput>> reportOutputs;
+    for (const auto& report : reports) {
+        reportOutputs.emplace_back(std::make_unique<httpdreport::ReportOutput>());
+        if (!reportOutputs.back()->open(report.outputFile, httpdreport::ReportOutput::getCompressionForPath(report.outputFile))) {
+            cerr << format("Failed to open {0:s}: {1:s}", describeReport(report), reportOutputs.back()->getLastError()) << endl;
+            return 1;
+        }
+    }
+
+    httpdreport::PipelineProgress progress;
+    httpdreport::ProgressReporter progressReporter(progress);
+
+    // SIGUSR1 writes the reports as they stand so far, without interrupting the run
+    const auto partialReportFile = (g_appOptions.OutputFile.empty() ? string(httpdreport::resources::APP_NAME) : g_appOptions.OutputFile) + ".partial";
+    const auto writePartialReport = [&]() {
+        const auto tempFile = partialReportFile + ".tmp";
+        httpdreport::ReportOutput output;
+        if (!output.open(tempFile, httpdreport::ReportOutput::Compression::NONE)) {
+            progressReporter.printMessage(format("Failed to write the partial report {0:s}: {1:s}", partialReportFile, output.getLastError()));
+            return;
+        }
+
+        PipelineStats::Timer renderTimer(stats.get(), PipelineStage::RENDER);
+        for (size_t i = 0; i < reports.size(); i++) { httpdreport::ReportRenderer(*reportAggregators[i], output).render(reports[i].sections); }
+        if (reports.empty()) { httpdreport::ReportRenderer(*unfilteredAggregator, output).render(); }
+        renderTimer.stop(0, std::max<size_t>(1, reports.size()));
+
+        if (!output.close() || rename(tempFile.c_str(), partialReportFile.c_str()) != 0) {
+            progressReporter.printMessage(format("Failed to write the partial report {0:s}: {1:s}", partialReportFile, output.getLastError()));
+            return;
+        }
+
+        progressReporter.printMessage(format("Wrote the partial report to {0:s}: {1:s}", partialReportFile, progressReporter.describe()));
+    };
+
+    installDumpHandler();
+    progressReporter.start();
+
+    httpdreport::RequestRecord record;
+    uint64_t rejectedLines = 0;
+    bool sqliteFailed = false;
+    const auto readSuccessfully = forEachLogLine([&](string_view line) {
+        if (g_dumpRequested.load(std::memory_order_relaxed) && g_dumpRequested.exchange(false)) { writePartialReport(); }
+
+        // timing every line would cost more than parsing it, so only a sample is timed
+        PipelineStats::Sampler sampler(stats.get());
+
+        progress.lines.add(1);
+        const auto parsed = httpdreport::parseRequestRecord(line, record, recordFields);
+        sampler.lap(PipelineStage::PARSE, line.size(), 1);
+
+        if (!parsed) {
+            HTTPDREPORT_PROBE2(reject, line.data(), line.size());
+            rejectedLines++;
+            progress.rejectedLines.add(1);
+            return;
+        }
+
+        if (unfilteredAggregator) { unfilteredAggregator->add(record); }
+        for (const auto& sink : filteredSinks) {
+            if (sink.first->matches(record)) { sink.second->add(record); }
+        }
+
+        sampler.lap(PipelineStage::AGGREGATE, 0, 1);
+        if (!arrowExporter && !sqliteExporter) { return; }
+
+        if (arrowExporter) { arrowExporter->append(record); }
+        if (sqliteExporter && g_appOptions.SqliteIncludeRequests && !sqliteFailed) {
+            sqliteFailed = !sqliteExporter->insertRequest(record);
+        }
+        sampler.lap(PipelineStage::EXPORT, 0, 1);
+    }, progress, stats.get());
+
+    progressReporter.stop();
+    if (rejectedLines > 0) {
+        cerr << format("Skipped {0:d} malformed lines.", rejectedLines) << endl;
+    }
+
+    PipelineStats::Timer exportTimer(stats.get(), PipelineStage::EXPORT);
+    if (arrowExporter && !arrowExporter->close()) {
+        cerr << format("Failed to write {0:s}", g_appOptions.ArrowOutputFile) << endl;
+        return 1;
+    }
+
+    if (sqliteExporter && (sqliteFailed || !sqliteExporter->writeAggregates(*unfilteredAggregator) || !sqliteExporter->finish())) {
+        cerr << format("Failed to write {0:s}: {1:s}", g_appOptions.SqliteOutputFile, sqliteExporter->getLastError()) << endl;
+        return 1;
+    }
+
+    if (!g_appOptions.SnapshotFile.empty() && !httpdreport::SnapshotWriter::write(*unfilteredAggregator, g_appOptions.SnapshotFile)) {
+        cerr << format("Failed to write snapshot {0:s}: {1:s}", g_appOptions.SnapshotFile, strerror(errno)) << endl;
+        return 1;
+    }
+    exportTimer.stop();
+
+    for (size_t i = 0; i < reports.size(); i++) {
+        const auto& report = reports[i];
+        PipelineStats::Timer renderTimer(stats.get(), PipelineStage::RENDER);
+        auto& output = *reportOutputs[i];
+        httpdreport::ReportRenderer(*reportAggregators[i], output).render(report.sections);
+
+        if (!output.close()) {
+            cerr << format("Failed to write {0:s}: {1:s}", describeReport(report), output.getLastError()) << endl;
+            return 1;
+        }
+        renderTimer.stop(0, 1);
+    }
+
+    printStats(stats.get());
+    return readSuccessfully ? 0 : 1;
+}
+
+/**
+ * @brief Creates the per-stage statistics of a run, reading hardware counters if --counters was given. --trace needs them,
+ * too: every timed call becomes an event of the timeline.
+ * 
+ * @return unique_ptr<httpdreport::PipelineStats> The statistics; nullptr if neither --stats nor --trace was given.
+ */
+unique_ptr<httpdreport::PipelineStats> createStats() {
+    if (g_appOptions.StatsFormat.empty() && !g_trace) { return nullptr; }
+
+    auto stats = std::make_unique<httpdreport::PipelineStats>();
+    stats->setTrace(g_trace.get());
+    if (g_appOptions.HardwareCounters) { stats->enableCounters(); } // if they're unavailable, the statistics say why
+
+
+    return stats;
+}
+
+/**
+ * @brief Prints the per-stage statistics of the run to stderr, in the format chosen with --stats.
+ * 
+ * @param stats The statistics; nothing is printed if they weren't requested.
+ */
+void printStats(const httpdreport::PipelineStats* stats) {
+    if (stats == nullptr || g_appOptions.StatsFormat.empty()) { return; }
+
+    cerr << (g_appOptions.StatsFormat == "json" ? stats->toJson() : stats->toText()) << std::flush;
+}
+
+void installStopHandlers() {
+    struct sigaction action{};
+    action.sa_handler = [](int) { g_stopRequested = true; };
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    // query clients may hang up in the middle of an answer
+    signal(SIGPIPE, SIG_IGN);
+}
+
+void installDumpHandler() {
+    struct sigaction action{};
+    action.sa_handler = [](int) { g_dumpRequested = true; };
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+}
+
+void installReloadHandler() {
+    struct sigaction action{};
+    action.sa_handler = [](int) { g_reloadRequested = true; };
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGHUP, &action, nullptr);
+}
+
+/**
+ * @brief Follows all access logs, keeps the aggregate tables in memory and answers queries on a Unix domain socket.
+ * 
+ * @return int The application's exit code.
+ */
+int runDaemon() {
+    using namespace std::chrono_literals;
+    static constexpr auto PUBLISH_INTERVAL = 250ms; //!< How often new requests are made visible to queries
+    static constexpr auto IDLE_INTERVAL = 200ms; //!< How long to wait for new log lines once all files have been read
+
+    if (g_appOptions.ReadFromStdin) {
+        cerr << "--daemon follows log files and can't read from stdin" << endl;
+        return 1;
+    }
+
+    httpdreport::LiveAggregates aggregates;
+    uint32_t recordFields = httpdreport::FIELD_TIMESTAMP | httpdreport::FIELD_CLIENT_ADDRESS;
+    if (!g_appOptions.ReportConfigFile.empty()) {
+        string error;
+        auto reportSet = httpdreport::loadReportSet(g_appOptions.ReportConfigFile, error);
+        if (!reportSet) {
+            cerr << format("Failed to load reports: {0:s}", error) << endl;
+            return 1;
+        }
+
+        recordFields |= reportSet->requiredFields;
+        aggregates.setReportSet(std::move(reportSet));
+    }
+
+    httpdreport::MetricsRegistry metrics;
+    auto& metricsShard = metrics.createShard();
+    httpdreport::RequestRecord record;
+    uint64_t rejectedLines = 0;
+    const auto handleLine = [&](string_view line) {
+        if (!httpdreport::parseRequestRecord(line, record, recordFields)) {
+            HTTPDREPORT_PROBE2(reject, line.data(), line.size());
+            rejectedLines++;
+            metricsShard.reject();
+            return;
+        }
+
+        aggregates.add(record);
+        metricsShard.record(record);
+    };
+
+    // a checkpoint replaces re-reading everything up to the positions it recorded
+    httpdreport::StateFile stateFile;
+    vector<httpdreport::LogFollower::FilePosition> savedPositions;
+    if (!g_appOptions.StateFile.empty()) {
+        if (!stateFile.open(g_appOptions.StateFile)) {
+            cerr << format("Failed to open state file {0:s}: {1:s}", g_appOptions.StateFile, stateFile.getLastError()) << endl;
+            return 1;
+        }
+
+        const auto loadStart = std::chrono::steady_clock::now();
+        if (aggregates.load([&](httpdreport::LiveTables& tables) { return stateFile.load(tables, savedPositions); })) {
+            cerr << format(
+                "Restored the state of {0:d} files from {1:s} in {2:d} ms", savedPositions.size(), g_appOptions.StateFile,
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - loadStart).count()
+            ) << endl;
+        } else if (stateFile.hasCheckpoint()) {
+            cerr << format("Ignoring state file {0:s}: {1:s}", g_appOptions.StateFile, stateFile.getLastError()) << endl;
+            savedPositions.clear();
+        }
+    }
+
+    // positions are matched by inode, not path: once logrotate renamed a checkpointed file, it's found under its new name
+    const auto findSavedPosition = [&](const fs::path& path) -> const httpdreport::LogFollower::FilePosition* {
+        struct stat info{};
+        if (stat(path.c_str(), &info) != 0) { return nullptr; }
+
+        const auto found = std::find_if(savedPositions.begin(), savedPositions.end(), [&](const auto& position) {
+            return position.inode != 0 && position.device == static_cast<uint64_t>(info.st_dev) && position.inode == static_cast<uint64_t>(info.st_ino);
+        });
+        return found == savedPositions.end() ? nullptr : &*found;
+    };
+
+    // rotated (compressed) logs don't change any more; they're read once, everything else is followed
+    httpdreport::LogFollower follower;
+    httpdreport::LogReader reader;
+    vector<httpdreport::LogFollower::FilePosition> completedFiles;
+    for (const auto& path : getInputFiles()) {
+        if (!httpdreport::LogReader::isGzipFile(path)) {
+            const auto* saved = findSavedPosition(path);
+            if (saved == nullptr) {
+                follower.addFile(path);
+            } else if (!follower.resumeFile(path, *saved)) {
+                cerr << format("{0:s} changed since the checkpoint; reading it from the start", path.string()) << endl;
+            }
+            continue;
+        }
+
+        struct stat info{};
+        if (!g_appOptions.ReadGzippedFiles) {
+            cerr << format("Gzipped file {0:s} detected! Will ignore. Use --gzip to read it.", path.string()) << endl;
+        } else if (stat(path.c_str(), &info) != 0) {
+            cerr << format("Failed to read {0:s}: {1:s}", path.string(), strerror(errno)) << endl;
+        } else {
+            const httpdreport::LogFollower::FilePosition position{ path.string(), info.st_dev, info.st_ino, static_cast<uint64_t>(info.st_size) };
+            const auto* saved = findSavedPosition(path);
+            if (saved != nullptr) {
+                completedFiles.push_back(position);
+            } else if (!reader.readFile(path, handleLine)) {
+                cerr << format("Failed to read {0:s}: {1:s}", path.string(), strerror(errno)) << endl;
+            } else {
+                completedFiles.push_back(position);
+            }
+        }
+    }
+
+    if (follower.getFileCount() == 0) {
+        cerr << "No access logs to follow." << endl;
+        return 1;
+    }
+
+    // only called right after a successful publish, so the published tables hold exactly what was read up to the positions
+    const auto commitState = [&]() {
+        if (!stateFile.isOpen()) { return; }
+
+        auto positions = follower.getPositions();
+        positions.insert(positions.end(), completedFiles.begin(), completedFiles.end());
+        if (!aggregates.read([&](const httpdreport::LiveTables& tables) { return stateFile.commit(tables, positions); })) {
+            cerr << format("Failed to write state file {0:s}: {1:s}", g_appOptions.StateFile, stateFile.getLastError()) << endl;
+        }
+    };
+
+    httpdreport::QueryServer server(aggregates, g_appOptions.TopCount);
+    if (!server.start(g_appOptions.DaemonSocketFile)) {
+        cerr << format("Failed to listen on {0:s}: {1:s}", g_appOptions.DaemonSocketFile, server.getLastError()) << endl;
+        return 1;
+    }
+
+    httpdreport::MetricsServer metricsServer(metrics);
+    if (!startMetrics(metricsServer)) { return 1; }
+
+    httpdreport::SharedSnapshotWriter sharedSnapshot(aggregates, metrics);
+    if (!startSharedSnapshot(sharedSnapshot)) { return 1; }
+
+    installStopHandlers();
+    installReloadHandler();
+
+    // reports are parsed off the ingesting thread; the new set only takes effect once it's complete
+    std::future<pair<shared_ptr<const httpdreport::ReportSet>, string>> pendingReload;
+
+    auto lastPublish = std::chrono::steady_clock::now();
+    auto lastMetricsFile = lastPublish;
+    auto lastCommit = lastPublish;
+    while (!g_stopRequested) {
+        if (g_reloadRequested.exchange(false)) {
+            if (g_appOptions.ReportConfigFile.empty()) {
+                cerr << "Nothing to reload: no --reports given." << endl;
+            } else if (!pendingReload.valid()) {
+                pendingReload = std::async(std::launch::async, [path = g_appOptions.ReportConfigFile]() {
+                    string error;
+                    auto reportSet = httpdreport::loadReportSet(path, error);
+                    return std::make_pair(std::move(reportSet), std::move(error));
+                });
+            }
+        }
+
+        if (pendingReload.valid() && pendingReload.wait_for(0ms) == std::future_status::ready) {
+            auto reloaded = pendingReload.get();
+            if (reloaded.first) {
+                cerr << format("Reloaded {0:d} reports from {1:s}", reloaded.first->reports.size(), g_appOptions.ReportConfigFile) << endl;
+                recordFields = httpdreport::FIELD_TIMESTAMP | httpdreport::FIELD_CLIENT_ADDRESS | reloaded.first->requiredFields;
+                aggregates.setReportSet(std::move(reloaded.first));
+            } else {
+                cerr << format("Failed to reload reports: {0:s}; keeping the previous reports", reloaded.second) << endl;
+            }
+        }
+
+        const auto bytesRead = follower.poll(handleLine);
+
+        // if a query still reads the standby tables, the requests are simply published with the next attempt
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastPublish >= PUBLISH_INTERVAL && aggregates.publish()) {
+            lastPublish = now;
+
+            if (now - lastCommit >= std::chrono::seconds(g_appOptions.DumpIntervalSeconds)) {
+                commitState();
+                lastCommit = now;
+            }
+        }
+
+        if (now - lastMetricsFile >= std::chrono::seconds(g_appOptions.DumpIntervalSeconds)) {
+            writeMetricsFile(metrics);
+            lastMetricsFile = now;
+        }
+
+        if (bytesRead == 0) { std::this_thread::sleep_for(IDLE_INTERVAL); }
+    }
+
+    // a final checkpoint lets the next start continue without reading anything twice
+    if (stateFile.isOpen()) {
+        while (!aggregates.publish()) { std::this_thread::sleep_for(1ms); }
+        commitState();
+    }
+
+    sharedSnapshot.stop();
+    metricsServer.stop();
+    server.stop();
+    writeMetricsFile(metrics);
+
+    if (rejectedLines > 0) {
+        cerr << format("Skipped {0:d} malformed lines.", rejectedLines) << endl;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Writes the snapshot (--snapshot) and report (--output) of the given tables, replacing the previous files atomically.
+ * 
+ * @return true If all files were written.
+ */
+bool writeAggregateFiles(const httpdreport::RequestAggregator& aggregator) {
+    bool success = true;
+
+    if (!g_appOptions.SnapshotFile.empty()) {
+        const auto tempFile = g_appOptions.SnapshotFile + ".tmp";
+        if (!httpdreport::SnapshotWriter::write(aggregator, tempFile) || rename(tempFile.c_str(), g_appOptions.SnapshotFile.c_str()) != 0) {
+            cerr << format("Failed to write snapshot {0:s}: {1:s}", g_appOptions.SnapshotFile, strerror(errno)) << endl;
+            success = false;
+        }
+    }
+
+    if (!g_appOptions.OutputFile.empty()) {
+        const auto tempFile = g_appOptions.OutputFile + ".tmp";
+        httpdreport::ReportOutput output;
+        if (!output.open(tempFile, httpdreport::ReportOutput::getCompressionForPath(g_appOptions.OutputFile))) {
+            cerr << format("Failed to open report output: {0:s}", output.getLastError()) << endl;
+            return false;
+        }
+
+        httpdreport::ReportRenderer(aggregator, output).render();
+        if (!output.close() || rename(tempFile.c_str(), g_appOptions.OutputFile.c_str()) != 0) {
+            cerr << format("Failed to write report {0:s}: {1:s}", g_appOptions.OutputFile, output.getLastError()) << endl;
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+/**
+ * @brief Starts serving /metrics on the loopback interface if --metrics was given.
+ * 
+ * @return false If the listener couldn't be started.
+ */
+bool startMetrics(httpdreport::MetricsServer& server) {
+    if (g_appOptions.MetricsPort == 0) { return true; }
+
+    if (!server.start(g_appOptions.MetricsPort)) {
+        cerr << format("Failed to listen on 127.0.0.1:{0:d}: {1:s}", g_appOptions.MetricsPort, server.getLastError()) << endl;
+        return false;
+    }
+
+    return true;
+}
+
+void writeMetricsFile(const httpdreport::MetricsRegistry& registry) {
+    if (!g_appOptions.MetricsFile.empty() && !registry.writeTextFile(g_appOptions.MetricsFile)) {
+        cerr << format("Failed to write {0:s}: {1:s}", g_appOptions.MetricsFile, strerror(errno)) << endl;
+    }
+}
+
+bool startSharedSnapshot(httpdreport::SharedSnapshotWriter& writer) {
+    if (g_appOptions.SharedSnapshotName.empty()) { return true; }
+
+    if (!writer.start(g_appOptions.SharedSnapshotName)) {
+        cerr << format("Failed to create shared memory {0:s}: {1:s}", g_appOptions.SharedSnapshotName, writer.getLastError()) << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Prints the figures a daemon (or piped logger) publishes via --shm.
+ * 
+ * @return int The application's exit code.
+ */
+int dumpSharedSnapshot() {
+    httpdreport::SharedSnapshotReader reader;
+    if (!reader.open(g_appOptions.SharedSnapshotDumpName)) {
+        cerr << format("Failed to open shared memory {0:s}: {1:s}", g_appOptions.SharedSnapshotDumpName, strerror(errno)) << endl;
+        return 1;
+    }
+
+    auto data = std::make_unique<httpdreport::SharedSnapshotData>();
+    if (!reader.read(*data)) {
+        cerr << format("Shared memory {0:s} holds no consistent snapshot", g_appOptions.SharedSnapshotDumpName) << endl;
+        return 1;
+    }
+
+    cout << format(
+        "updated {0:d}\nnewest {1:d}\nrequests {2:d}\nbytes {3:d}\nrejected {4:d}\nstatus 1xx={5:d} 2xx={6:d} 3xx={7:d} 4xx={8:d} 5xx={9:d} other={10:d}\n",
+        data->updatedAt, data->newestRequest, data->totalRequests, data->totalBytes, data->rejectedLines, data->statusClasses[1],
+        data->statusClasses[2], data->statusClasses[3], data->statusClasses[4], data->statusClasses[5], data->statusClasses[0]
+    );
+
+    cout << format("\nvhosts ({0:d})\n", data->vhostCount);
+    for (uint32_t i = 0; i < data->vhostCount; i++) {
+        const auto& vhost = data->vhosts[i];
+        cout << format(
+            "{0:s} {1:d} {2:d} 2xx={3:d} 3xx={4:d} 4xx={5:d} 5xx={6:d}\n", vhost.name[0] == '\0' ? "-" : vhost.name, vhost.requests, vhost.bytes,
+            vhost.statusClasses[2], vhost.statusClasses[3], vhost.statusClasses[4], vhost.statusClasses[5]
+        );
+    }
+
+    cout << format("\ntop clients, last {0:d} minutes\n", data->topWindowMinutes);
+    for (uint32_t i = 0; i < data->topClientCount; i++) {
+        cout << format("{0:s} {1:d} {2:d}\n", data->topClients[i].source, data->topClients[i].requests, data->topClients[i].bytes);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Runs a live input (--pipe, --syslog) until it ends or a stop is requested: answers queries, serves metrics and
+ * periodically writes the snapshot and report.
+ * 
+ * @param option The option which selected the input, for error messages.
+ * @param receive Called with the live aggregates and the metrics registry; feeds both until the input ends or a stop is requested.
+ * Returns false if the input couldn't be opened, in which case nothing is written.
+ * @param describeCounters Returns the input's counters (a string) for the periodic status line.
+ * 
+ * @return int The application's exit code.
+ */
+template<typename Receiver, typename CounterFormatter>
+int runLiveInput(const string& option, Receiver&& receive, CounterFormatter&& describeCounters) {
+    using namespace std::chrono_literals;
+
+    if (
+        g_appOptions.OutputFile.empty() && g_appOptions.SnapshotFile.empty() && g_appOptions.DaemonSocketFile.empty() &&
+        g_appOptions.MetricsPort == 0 && g_appOptions.MetricsFile.empty() && g_appOptions.SharedSnapshotName.empty()
+    ) {
+        cerr << format("{0:s} requires at least one of --output, --snapshot, --daemon, --metrics, --metrics-file or --shm", option) << endl;
+        return 1;
+    }
+
+    httpdreport::LiveAggregates aggregates;
+    httpdreport::MetricsRegistry metrics;
+
+    httpdreport::QueryServer server(aggregates, g_appOptions.TopCount);
+    if (!g_appOptions.DaemonSocketFile.empty() && !server.start(g_appOptions.DaemonSocketFile)) {
+        cerr << format("Failed to listen on {0:s}: {1:s}", g_appOptions.DaemonSocketFile, server.getLastError()) << endl;
+        return 1;
+    }
+
+    httpdreport::MetricsServer metricsServer(metrics);
+    if (!startMetrics(metricsServer)) { return 1; }
+
+    httpdreport::SharedSnapshotWriter sharedSnapshot(aggregates, metrics);
+    if (!startSharedSnapshot(sharedSnapshot)) { return 1; }
+
+    // stderr ends up in httpd's error log
+    const auto printCounters = [&]() { cerr << format("{0:s}: {1:s}", httpdreport::resources::APP_NAME, describeCounters()) << endl; };
+
+    // files are written on their own thread, from a consistent copy of the tables, so receiving never stalls
+    std::mutex dumpLock;
+    std::condition_variable dumpWakeUp;
+    bool dumpStopRequested = false;
+    std::thread dumpThread([&]() {
+        std::unique_lock<std::mutex> lock(dumpLock);
+        while (!dumpWakeUp.wait_for(lock, std::chrono::seconds(g_appOptions.DumpIntervalSeconds), [&]() { return dumpStopRequested; })) {
+            aggregates.read([](const httpdreport::LiveTables& tables) { return writeAggregateFiles(tables.getTotals()); });
+            writeMetricsFile(metrics);
+            printCounters();
+        }
+    });
+
+    installStopHandlers();
+    const auto received = receive(aggregates, metrics);
+
+    {
+        std::unique_lock<std::mutex> lock(dumpLock);
+        dumpStopRequested = true;
+    }
+    dumpWakeUp.notify_all();
+    dumpThread.join();
+
+    // an input which never started mustn't replace the previous report and snapshot with empty ones
+    if (!received) {
+        sharedSnapshot.stop();
+        metricsServer.stop();
+        server.stop();
+        return 1;
+    }
+
+    // only queries might still read the tables now; wait for them to publish everything before the final dump
+    while (!aggregates.publish()) { std::this_thread::sleep_for(1ms); }
+    const auto success = aggregates.read([](const httpdreport::LiveTables& tables) { return writeAggregateFiles(tables.getTotals()); });
+    writeMetricsFile(metrics);
+    printCounters();
+
+    sharedSnapshot.stop();
+    metricsServer.stop();
+    server.stop();
+
+    uint64_t rejectedLines = 0;
+    metrics.getVhostTotals(rejectedLines);
+    if (rejectedLines > 0) {
+        cerr << format("Skipped {0:d} malformed lines.", rejectedLines) << endl;
+    }
+
+    return success ? 0 : 1;
+}
+
+/**
+ * @brief Runs as httpd's piped logger (CustomLog "|httpd-hit-report --pipe ..."): aggregates stdin in real time and
+ * periodically writes the snapshot and report, until httpd closes the pipe.
+ * 
+ * @return int The application's exit code.
+ */
+int runPipe() {
+    using namespace std::chrono_literals;
+    static constexpr auto PUBLISH_INTERVAL = 250ms; //!< How often new requests are made visible to queries and dumps
+
+    httpdreport::PipeReceiver receiver(STDIN_FILENO);
+
+    const auto receive = [&](httpdreport::LiveAggregates& aggregates, httpdreport::MetricsRegistry& metrics) {
+        if (!receiver.start()) {
+            cerr << format("Failed to read from stdin: {0:s}", strerror(errno)) << endl;
+            return false;
+        }
+
+        auto& metricsShard = metrics.createShard();
+        httpdreport::RequestRecord record;
+        // while sampling, a parsed line stands for the lines skipped, so the tables estimate the full traffic
+        const auto handleLine = [&](string_view line, uint32_t weight) {
+            if (!httpdreport::parseRequestRecord(line, record, httpdreport::FIELD_TIMESTAMP | httpdreport::FIELD_CLIENT_ADDRESS)) {
+                HTTPDREPORT_PROBE2(reject, line.data(), line.size());
+                metricsShard.reject();
+                return;
+            }
+
+            aggregates.add(record, weight);
+            metricsShard.record(record, weight);
+        };
+
+        auto lastPublish = std::chrono::steady_clock::now();
+        while (!g_stopRequested && receiver.poll(handleLine, 100ms)) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now - lastPublish >= PUBLISH_INTERVAL && aggregates.publish()) { lastPublish = now; }
+        }
+
+        // whatever was read from the pipe is still queued; it belongs in the final dump
+        receiver.stop();
+        while (receiver.poll(handleLine, 0ms)) {}
+
+        return true;
+    };
+
+    return runLiveInput("--pipe", receive, [&]() {
+        return format(
+            "received {0:d} B, dropped {1:d} B (~{2:d} lines), sampled out {3:d} lines (estimated from the lines parsed)",
+            receiver.getReceivedBytes(), receiver.getDroppedBytes(), receiver.getDroppedLines(), receiver.getSampledOutLines()
+        );
+    });
+}
+
+/**
+ * @brief Receives access log lines sent via syslog over UDP (--syslog [address:]port) on several threads, until stopped.
+ * 
+ * @return int The application's exit code.
+ */
+int runSyslog() {
+    using namespace std::chrono_literals;
+    static constexpr auto PUBLISH_INTERVAL = 250ms; //!< How often new requests are made visible to queries and dumps
+
+    // all interfaces if no address is given
+    string address;
+    uint16_t port = 0;
+    if (!parseEndpoint(g_appOptions.SyslogListenAddress, "0.0.0.0", address, port)) {
+        cerr << format("Invalid syslog port in {0:s}", g_appOptions.SyslogListenAddress) << endl;
+        return 1;
+    }
+
+    httpdreport::SyslogReceiver receiver;
+
+    const auto receive = [&](httpdreport::LiveAggregates& aggregates, httpdreport::MetricsRegistry& metrics) {
+        // every receiving thread parses its own batches; only adding the parsed requests is serialised
+        struct ReceiverState {
+            httpdreport::MetricsShard*              metricsShard{nullptr};
+            httpdreport::RequestRecord              record{};
+            vector<httpdreport::RequestRecord>      records{};
+        };
+
+        vector<ReceiverState> states(std::max<size_t>(1, g_appOptions.SyslogThreads));
+        for (auto& state : states) { state.metricsShard = &metrics.createShard(); }
+
+        std::mutex aggregatesLock;
+        const auto handleBatch = [&](size_t threadIndex, const vector<string_view>& messages) {
+            auto& state = states[threadIndex];
+            state.records.clear();
+            for (const auto& message : messages) {
+                if (!httpdreport::parseRequestRecord(message, state.record, httpdreport::FIELD_TIMESTAMP | httpdreport::FIELD_CLIENT_ADDRESS)) {
+                    HTTPDREPORT_PROBE2(reject, message.data(), message.size());
+                    state.metricsShard->reject();
+                    continue;
+                }
+
+                state.metricsShard->record(state.record);
+                state.records.emplace_back(state.record);
+            }
+
+            std::unique_lock<std::mutex> lock(aggregatesLock);
+            for (const auto& record : state.records) { aggregates.add(record); }
+        };
+
+        if (!receiver.start(address, static_cast<uint16_t>(port), states.size(), handleBatch)) {
+            cerr << format("Failed to listen on {0:s}:{1:d}/udp: {2:s}", address, port, receiver.getLastError()) << endl;
+            return false;
+        }
+
+        while (!g_stopRequested) {
+            std::this_thread::sleep_for(PUBLISH_INTERVAL);
+
+            std::unique_lock<std::mutex> lock(aggregatesLock);
+            aggregates.publish();
+        }
+
+        receiver.stop();
+        return true;
+    };
+
+    return runLiveInput("--syslog", receive, [&]() {
+        return format(
+            "received {0:d} datagrams, dropped {1:d} (socket buffers full), skipped {2:d} (too long)",
+            receiver.getReceivedDatagrams(), receiver.getDroppedDatagrams(), receiver.getTruncatedDatagrams()
+        );
+    });
+}
+
+/**
+ * @brief Splits "[host:]port" in to its parts.
+ * 
+ * @param defaultHost Used if the value is only a port.
+ * 
+ * @return false If the port is missing or invalid.
+ */
+bool parseEndpoint(const string& value, const string& defaultHost, string& host, uint16_t& port) {
+    const auto separator = value.rfind(':');
+    host = separator == string::npos ? defaultHost : value.substr(0, separator);
+
+    const auto number = std::strtoul(value.c_str() + (separator == string::npos ? 0 : separator + 1), nullptr, 10);
+    port = static_cast<uint16_t>(number);
+
+    return !host.empty() && number > 0 && number <= UINT16_MAX;
+}
+
+/**
+ * @brief Hands the access logs out to workers connecting over TCP, merges their snapshots and writes the report and snapshot.
+ * 
+ * @return int The application's exit code.
+ */
+int runCoordinator() {
+    string address;
+    uint16_t port = 0;
+    if (!parseEndpoint(g_appOptions.CoordinatorListenAddress, "0.0.0.0", address, port)) {
+        cerr << format("Invalid coordinator port in {0:s}", g_appOptions.CoordinatorListenAddress) << endl;
+        return 1;
+    }
+
+    auto stats = createStats();
+
+    httpdreport::RequestAggregator aggregator;
+    httpdreport::ReportCoordinator coordinator(aggregator, [](const string& message) { cerr << message << endl; });
+    coordinator.setStats(stats.get());
+
+    // the workers read the files from their own file systems; sizes only decide the order and where files can be split
+    size_t fileCount = 0;
+    httpdreport::PipelineStats::Timer discoveryTimer(stats.get(), httpdreport::PipelineStage::DISCOVERY);
+    for (const auto& path : getInputFiles()) {
+        struct stat info{};
+        const auto size = stat(path.c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+        const auto isGzip = httpdreport::LogReader::isGzipFile(path);
+        if (isGzip && !g_appOptions.ReadGzippedFiles) {
+            cerr << format("Gzipped file {0:s} detected! Will ignore. Use --gzip to read it.", path.string()) << endl;
+            continue;
+        }
+
+        coordinator.addFile(path, size, !isGzip);
+        fileCount++;
+    }
+    discoveryTimer.stop(0, fileCount);
+
+    if (fileCount == 0) {
+        cerr << "No access logs to distribute." << endl;
+        return 1;
+    }
+
+    installStopHandlers();
+    cerr << format("Waiting for workers on {0:s}:{1:d} to read {2:d} files", address, port, fileCount) << endl;
+
+    if (!coordinator.run(address, port, g_stopRequested)) {
+        cerr << format("Coordinator failed: {0:s}", coordinator.getLastError()) << endl;
+        return 1;
+    }
+
+    cerr << format("Merged the snapshots of {0:d} workers; {1:d} ranges were stolen by idle workers", coordinator.getWorkerCount(), coordinator.getStolenRanges()) << endl;
+    for (const auto& failure : coordinator.getFailedRanges()) {
+        cerr << format("Failed to read {0:s}", failure) << endl;
+    }
+
+    if (coordinator.getRejectedLines() > 0) {
+        cerr << format("Skipped {0:d} malformed lines.", coordinator.getRejectedLines()) << endl;
+    }
+
+    httpdreport::PipelineStats::Timer renderTimer(stats.get(), httpdreport::PipelineStage::RENDER);
+    if (!writeAggregateFiles(aggregator)) { return 1; }
+
+    // like a local run, the report goes to stdout unless only a snapshot was asked for
+    if (g_appOptions.OutputFile.empty() && g_appOptions.SnapshotFile.empty()) {
+        httpdreport::ReportOutput output;
+        if (!output.open(g_appOptions.OutputFile, httpdreport::ReportOutput::Compression::NONE)) {
+            cerr << format("Failed to open report output: {0:s}", output.getLastError()) << endl;
+            return 1;
+        }
+
+        httpdreport::ReportRenderer(aggregator, output).render();
+        if (!output.close()) {
+            cerr << format("Failed to write report: {0:s}", output.getLastError()) << endl;
+            return 1;
+        }
+    }
+    renderTimer.stop(0, 1);
+
+    printStats(stats.get());
+    return coordinator.getFailedRanges().empty() ? 0 : 1;
+}
+
+/**
+ * @brief Connects to a coordinator, reads the file ranges it assigns and sends back a snapshot of the tables.
+ * 
+ * @return int The application's exit code.
+ */
+int runWorker() {
+    string host;
+    uint16_t port = 0;
+    if (!parseEndpoint(g_appOptions.WorkerCoordinatorAddress, "", host, port)) {
+        cerr << format("Invalid coordinator address {0:s}; expected host:port", g_appOptions.WorkerCoordinatorAddress) << endl;
+        return 1;
+    }
+
+    // the coordinator's hang-up must not kill a worker that is still sending
+    signal(SIGPIPE, SIG_IGN);
+
+    auto stats = createStats();
+    httpdreport::ReportWorker worker;
+    worker.setStats(stats.get());
+    if (!worker.run(host, std::to_string(port))) {
+        cerr << format("Worker failed: {0:s}", worker.getLastError()) << endl;
+        return 1;
+    }
+
+    cerr << format("Read {0:d} ranges; skipped {1:d} malformed lines.", worker.getRangesRead(), worker.getRejectedLines()) << endl;
+    printStats(stats.get());
     return 0;
 }
 
@@ -63,7 +1195,7 @@ int main(const int32_t argc, char* const* argv) {
  * @return int 0 if regular execution shall continue, >0 if application should exit with (>0) - 1.
  */
 int parseArgs(const int32_t argc, char* const* argv) {
-    static const string SHORT_OPTS = "hvsgFRra:e:o:l:";
+    static const string SHORT_OPTS = "-hvsgFRra:e:o:l:A:S:";
     static const option OPTIONS[] = {
         { "help",       no_argument,        nullptr, 'h' },
         { "version",    no_argument,        nullptr, 'v' },
@@ -76,6 +1208,28 @@ int parseArgs(const int32_t argc, char* const* argv) {
         { "error",      required_argument,  nullptr, 'e' },
         { "output",     required_argument,  nullptr, 'o' },
         { "log-dir",    required_argument,  nullptr, 'l' },
+        { "arrow",      required_argument,  nullptr, 'A' },
+        { "sqlite",     required_argument,  nullptr, 'S' },
+        { "sqlite-raw", no_argument,        nullptr, 0x100 },
+        { "snapshot",   required_argument,  nullptr, 0x101 },
+        { "diff",       required_argument,  nullptr, 0x102 },
+        { "top",        required_argument,  nullptr, 0x103 },
+        { "reports",    required_argument,  nullptr, 0x104 },
+        { "daemon",     required_argument,  nullptr, 0x105 },
+        { "pipe",       no_argument,        nullptr, 0x106 },
+        { "interval",   required_argument,  nullptr, 0x107 },
+        { "metrics",    required_argument,  nullptr, 0x108 },
+        { "metrics-file", required_argument, nullptr, 0x109 },
+        { "shm",        required_argument,  nullptr, 0x10a },
+        { "shm-dump",   required_argument,  nullptr, 0x10b },
+        { "syslog",     required_argument,  nullptr, 0x10c },
+        { "syslog-threads", required_argument, nullptr, 0x10d },
+        { "state",      required_argument,  nullptr, 0x10e },
+        { "coordinator", required_argument, nullptr, 0x10f },
+        { "worker",     required_argument,  nullptr, 0x110 },
+        { "stats",      optional_argument,  nullptr, 0x111 },
+        { "trace",      required_argument,  nullptr, 0x112 },
+        { "counters",   no_argument,        nullptr, 0x113 },
         { nullptr,      no_argument,        nullptr,  0  }
     };
 
@@ -83,7 +1237,12 @@ int parseArgs(const int32_t argc, char* const* argv) {
     while ((optChar = getopt_long(argc, argv, SHORT_OPTS.c_str(), OPTIONS, nullptr)) != -1) {
         switch (optChar) {
             case 1:
-                g_appOptions.InputFiles.emplace_back(optarg);
+                // --diff takes two files; the second one arrives as a positional argument
+                if (g_appOptions.DiffSnapshotFiles.size() == 1) {
+                    g_appOptions.DiffSnapshotFiles.emplace_back(optarg);
+                } else {
+                    g_appOptions.InputFiles.emplace_back(optarg);
+                }
                 break;
             case 'h':
                 printHelp();
@@ -109,6 +1268,86 @@ int parseArgs(const int32_t argc, char* const* argv) {
             case 'l':
                 g_appOptions.LogDirectory = optarg;
                 break;
+            case 'A':
+                g_appOptions.ArrowOutputFile = optarg;
+                break;
+            case 'S':
+                g_appOptions.SqliteOutputFile = optarg;
+                break;
+            case 0x100:
+                g_appOptions.SqliteIncludeRequests = true;
+                break;
+            case 0x101:
+                g_appOptions.SnapshotFile = optarg;
+                break;
+            case 0x102:
+                g_appOptions.DiffSnapshotFiles = { optarg };
+                break;
+            case 0x103: {
+                char* end = nullptr;
+                errno = 0;
+                const auto count = std::strtoll(optarg, &end, 10);
+                if (end == optarg || *end != '\0' || errno == ERANGE || count <= 0) {
+                    cerr << format("Invalid --top {0:s}; expected a positive number of rows", optarg) << endl;
+                    return 2;
+                }
+
+                g_appOptions.TopCount = static_cast<size_t>(count);
+                break;
+            }
+            case 0x104:
+                g_appOptions.ReportConfigFile = optarg;
+                break;
+            case 0x105:
+                g_appOptions.DaemonSocketFile = optarg;
+                break;
+            case 0x106:
+                g_appOptions.ReadFromPipe = true;
+                break;
+            case 0x107:
+                g_appOptions.DumpIntervalSeconds = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 0x108:
+                g_appOptions.MetricsPort = static_cast<uint16_t>(std::strtoul(optarg, nullptr, 10));
+                break;
+            case 0x109:
+                g_appOptions.MetricsFile = optarg;
+                break;
+            case 0x10a:
+                g_appOptions.SharedSnapshotName = optarg;
+                break;
+            case 0x10b:
+                g_appOptions.SharedSnapshotDumpName = optarg;
+                break;
+            case 0x10c:
+                g_appOptions.SyslogListenAddress = optarg;
+                break;
+            case 0x10d:
+                g_appOptions.SyslogThreads = std::max(1ul, std::strtoul(optarg, nullptr, 10));
+                break;
+            case 0x10e:
+                g_appOptions.StateFile = optarg;
+                break;
+            case 0x10f:
+                g_appOptions.CoordinatorListenAddress = optarg;
+                break;
+            case 0x110:
+                g_appOptions.WorkerCoordinatorAddress = optarg;
+                break;
+            case 0x111:
+                g_appOptions.StatsFormat = optarg == nullptr ? "text" : optarg;
+                if (g_appOptions.StatsFormat != "text" && g_appOptions.StatsFormat != "json") {
+                    cerr << format("Unknown --stats format {0:s}; expected text or json", g_appOptions.StatsFormat) << endl;
+                    return 2;
+                }
+                break;
+            case 0x112:
+                g_appOptions.TraceFile = optarg;
+                break;
+            case 0x113:
+                g_appOptions.HardwareCounters = true;
+                if (g_appOptions.StatsFormat.empty()) { g_appOptions.StatsFormat = "text"; }
+                break;
             case 'F':
                 g_appOptions.FollowSymlinks = true;
                 break;
@@ -148,9 +1387,49 @@ Switches:
 Arguments:
     --access,   -a[glob]        Set the glob pattern for access log files. Default: {3:s}
     --error,    -e[glob]        Set the glob pattern for error log files. Default: {4:s}
-    --output,   -o[file]        Set the output file (otherwise stdout is used)
+    --output,   -o[file]        Set the output file (otherwise stdout is used). Files ending in .gz or .zst are compressed
+    --arrow,    -A[file]        Export all parsed requests to an Arrow IPC (Feather v2) file
+    --sqlite,   -S[file]        Write the aggregate tables to an SQLite database
+    --sqlite-raw                Also write every parsed request to the SQLite database
+    --snapshot  [file]          Write a binary snapshot of the aggregate tables
+    --diff      [old] [new]     Compare two snapshots instead of reading logs
+    --top       [count]         The number of rows per ranking. Default: {5:d}
+    --reports   [file]          Render all reports defined in a configuration file from a single pass over the logs.
+                                With --daemon, keep each report's tables live instead; SIGHUP reloads the file
+    --daemon    [socket]        Keep following the logs and answer queries on a Unix domain socket:
+                                  summary | windows | top [count] [minutes] | client <source> [minutes] | reports |
+                                  report [name] | snapshot <file>
+    --pipe                      Run as httpd's piped logger (CustomLog "|{1:s} --pipe -o report.md"): aggregate stdin as it
+                                arrives and rewrite --output/--snapshot periodically. Sheds load by sampling instead of blocking httpd
+    --syslog    [[addr:]port]   Receive access log lines sent via syslog over UDP (IPv4; all interfaces if no address is given)
+                                and rewrite --output/--snapshot periodically, like --pipe. Runs until stopped
+    --syslog-threads [count]    The number of sockets/threads receiving --syslog datagrams. Default: {7:d}
+    --coordinator [[addr:]port] Hand the access logs out to --worker instances connecting over TCP (trusted networks only),
+                                merge their snapshots and write the report and --snapshot. Workers open the same paths on their
+                                own machines; large files are split between workers, compressed files are read whole
+    --worker    [host:port]     Read the file ranges a --coordinator assigns and send it a snapshot of the tables
+    --stats[=text|json]         After reading logs (or coordinating or working), print the wall and CPU time, throughput and calls of
+                                each stage, peak RSS and allocations to stderr. Parsing and aggregation are timed on a sample of lines
+    --counters                  Add the hardware counters (cycles, instructions, IPC, LLC and branch misses) of each stage and
+                                thread to --stats (implies --stats=text). Needs kernel.perf_event_paranoid <= 2 or CAP_PERFMON
+    --trace     [file]          When reading logs, coordinating or working: write a timeline of every read, decompressed and merged
+                                chunk to [file] (Chrome trace events; open in https://ui.perfetto.dev). A chunk's lines are parsed and
+                                aggregated in turn, so they appear as one parse+aggregate event per chunk. Workers trace their own process
+    --state     [file]          With --daemon: checkpoint the tables and log positions to [file] every --interval and on exit,
+                                and continue from the last checkpoint on start instead of reading the logs again
+    --interval  [seconds]       How often --pipe and --syslog rewrite their files, --state is checkpointed and --metrics-file
+                                is rewritten. Default: {6:d}
+    --metrics   [port]          With --daemon, --pipe or --syslog: serve Prometheus metrics on http://127.0.0.1:[port]/metrics
+    --metrics-file [file]       With --daemon, --pipe or --syslog: periodically write the metrics for node_exporter's textfile collector
+    --shm       [name]          With --daemon, --pipe or --syslog: publish headline figures in the shared memory segment [name] every second
+    --shm-dump  [name]          Print the figures published in the shared memory segment [name] and exit
+
+Signals:
+    SIGUSR1                     While reading logs: write the reports as they stand to [--output].partial ({1:s}.partial
+                                if the report goes to stdout) and print the progress. On a terminal, progress is shown continuously
+    SIGHUP                      With --daemon: reload --reports
 
-)", APP_DESCRIPTION, APP_NAME, DEFAULT_LOG_PATH, DEFAULT_APPOPTS.AccessFileGlob, DEFAULT_APPOPTS.ErrorFileGlob) << endl;
+)", APP_DESCRIPTION, APP_NAME, DEFAULT_LOG_PATH, DEFAULT_APPOPTS.AccessFileGlob, DEFAULT_APPOPTS.ErrorFileGlob, DEFAULT_APPOPTS.TopCount, DEFAULT_APPOPTS.DumpIntervalSeconds, DEFAULT_APPOPTS.SyslogThreads) << endl;
 }
 
 void printVersion() {